@@ -36,6 +36,7 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "IMsvDllDecorator.h"
+#include "MsvDllLoadOptions.h"
 
 
 /**************************************************************************************************//**
@@ -55,12 +56,13 @@ public:
 	* @brief			Initialize DLL library.
 	* @details		Initializes dynamic/shared library. It also loads dynamic/shared library.
 	* @param[in]	dllPath								Path to DLL library.
+	* @param[in]	loadOptions							DLL load options (see @ref MsvDllLoadOption).
 	* @retval		MSV_ALREADY_INITIALIZED_INFO	When DLL has been already initialized (this is info, not error).
 	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
 	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
 	* @retval		MSV_SUCCESS							On success.
 	******************************************************************************************************/
-	virtual MsvErrorCode Initialize(const char* dllPath) = 0;
+	virtual MsvErrorCode Initialize(const char* dllPath, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT) = 0;
 
 	/**************************************************************************************************//**
 	* @brief			Uninitialize DLL library.
@@ -75,6 +77,16 @@ public:
 	******************************************************************************************************/
 	virtual MsvErrorCode Uninitialize() = 0;
 
+	/**************************************************************************************************//**
+	* @brief			Detach DLL library.
+	* @details		Uninitializes dynamic/shared library without unloading it (see
+	*					IMsvDllAdapter::DetachDllLibrary) - acquired DLL objects stay valid until process exits.
+	* @retval		MSV_NOT_INITIALIZED_INFO		When DLL library has not been initialized (this is info, not error).
+	* @retval		MSV_SUCCESS							On success.
+	* @note			It does not wait for anything and it does not log anything - it is used by fast shutdown.
+	******************************************************************************************************/
+	virtual MsvErrorCode Detach() = 0;
+
 	/**************************************************************************************************//**
 	* @brief			Initialize check.
 	* @details		Returns flag if DLL library is initialized and successfully loaded (true) or not (false).
@@ -90,15 +102,38 @@ public:
 	* @retval		MSV_NOT_INITIALIZED_ERROR		When DLL library has not been initialized.
 	* @retval		MSV_NOT_FOUND_ERROR				When DLL entry point or DLL object was not found.
 	* @retval		MSV_SUCCESS							On success.
+	* @note			Objects are created one by one - decorator and exported GetDllObject function are never
+	*					called concurrently for one DLL (they don't need to be thread safe).
 	******************************************************************************************************/
 	virtual MsvErrorCode GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject, std::shared_ptr<IMsvDllDecorator> spDecorator = nullptr) = 0;
 
 	/**************************************************************************************************//**
 	* @brief			Get reference count of DLL objects.
 	* @details		Returns number of references to DLL objects (objects acquired from a dynamic/shared library).
+	*					Each acquired DLL object is one reference until all its shared pointers are released.
 	* @returns		int64_t	Number of references to DLL objects.
 	******************************************************************************************************/
 	virtual std::int64_t GetDllReferenceCount() const = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Warm up DLL.
+	* @details		Warms up loaded dynamic/shared library (see IMsvDllAdapter::WarmupDllLibrary). DLL
+	*					lock is not held during warmup, so it does not block DLL objects acquisition.
+	* @param[in]	dllAddressNames					Hot address names (not found ones are logged only).
+	* @param[in]	cancelled							Cancel flag (it is checked between chunks).
+	* @retval		MSV_NOT_INITIALIZED_ERROR		When DLL library has not been initialized (or it has been uninitialized during warmup).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When warmup has been cancelled.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode WarmupDll(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL prefault.
+	* @details		Returns result of prefault of loaded dynamic/shared library (see IMsvDllAdapter::GetDllPrefault).
+	* @param[out]	prefaultedPages					Count of prefaulted pages (0 when DLL has not been prefaulted).
+	* @param[out]	prefaultTime						Time of prefault.
+	******************************************************************************************************/
+	virtual void GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const = 0;
 };
 
 
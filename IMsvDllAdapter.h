@@ -35,8 +35,21 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 #define MARSTECH_IDLLBASE_H
 
 
+#include "MsvDllLoadOptions.h"
+
 #include "merror/MsvError.h"
 
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+MSV_ENABLE_WARNINGS
+
 
 /**************************************************************************************************//**
 * @brief		MarsTech DLL Adapter Interface.
@@ -63,6 +76,19 @@ public:
 	******************************************************************************************************/
 	virtual MsvErrorCode GetDllAddress(const char* dllAddressName, void*& pdllAddress) = 0;
 
+	/**************************************************************************************************//**
+	* @brief			Get DLL addresses.
+	* @details		Gets table of dynamic/shared library addresses in one pass (decorators binding many
+	*					functions should use it instead of calling @ref GetDllAddress for each of them).
+	*					All addresses are resolved even when some of them are not found.
+	* @param[in]	dllAddressNames					Address names to get/load.
+	* @param[out]	dllAddresses						Pointers to loaded addresses (in order of names, nullptr for not found ones).
+	* @retval		MSV_NOT_INITIALIZED_ERROR		When DLL library has not been loaded.
+	* @retval		MSV_NOT_FOUND_ERROR				When any DLL address was not found (all of them are logged).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllAddresses(const std::vector<const char*>& dllAddressNames, std::vector<void*>& dllAddresses) = 0;
+
 	/**************************************************************************************************//**
 	* @brief			Load check.
 	* @details		Returns flag if DLL library is loaded (true) or not (false).
@@ -75,11 +101,12 @@ public:
 	* @brief			Load DLL library.
 	* @details		Loads dynamic/shared library.
 	* @param[in]	dllPath								Path to DLL library.
+	* @param[in]	loadOptions							DLL load options (see @ref MsvDllLoadOption).
 	* @retval		MSV_ALREADY_INITIALIZED_INFO	When DLL has been already loaded (this is info, not error).
 	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
 	* @retval		MSV_SUCCESS							On success.
 	******************************************************************************************************/
-	virtual MsvErrorCode LoadDllLibrary(const char* dllPath) = 0;
+	virtual MsvErrorCode LoadDllLibrary(const char* dllPath, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT) = 0;
 
 	/**************************************************************************************************//**
 	* @brief			Unload DLL library.
@@ -91,6 +118,52 @@ public:
 	*					unloading dynamic/shared library.
 	******************************************************************************************************/
 	virtual MsvErrorCode UnloadDllLibrary() = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Detach DLL library.
+	* @details		Forgets loaded dynamic/shared library without unloading it - it stays in memory until
+	*					process exits (its static destructors are run by process exit).
+	* @retval		MSV_NOT_INITIALIZED_INFO		When DLL library has not been loaded (this is info, not error).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode DetachDllLibrary() = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Warm up DLL library.
+	* @details		Resolves hot addresses (they are cached, so next @ref GetDllAddress calls do not search
+	*					library) and faults in code pages of loaded library, so first calls do not stall in
+	*					page faults. Library is touched in small chunks and warmup stops between them when
+	*					it is cancelled or when library is unloaded.
+	* @param[in]	dllAddressNames					Hot address names (not found ones are logged only).
+	* @param[in]	cancelled							Cancel flag (it is checked between chunks).
+	* @retval		MSV_NOT_INITIALIZED_ERROR		When DLL library has not been loaded (or it has been unloaded during warmup).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When warmup has been cancelled.
+	* @retval		MSV_SUCCESS							On success.
+	* @note			It is slow (it touches whole code of library) - it should be called by background thread.
+	******************************************************************************************************/
+	virtual MsvErrorCode WarmupDllLibrary(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL prefault.
+	* @details		Returns result of prefault of library loaded with MSV_DLL_LOAD_PREFAULT option (count of
+	*					faulted in pages of code and read-only data and time it took), so it can be enabled only
+	*					for libraries where it pays off.
+	* @param[out]	prefaultedPages					Count of prefaulted pages (0 when library has not been prefaulted).
+	* @param[out]	prefaultTime						Time of prefault.
+	******************************************************************************************************/
+	virtual void GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Readahead DLL library.
+	* @details		Asks system to read whole file of library to page cache in background (it does not
+	*					wait for disk), so library which will be loaded later does not wait for disk reads
+	*					during its load. Library does not need to be loaded by this adapter.
+	* @param[in]	dllPath								Path to DLL library file.
+	* @retval		MSV_OPEN_ERROR						When DLL library file can't be opened.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When readahead is not supported (platform or file system).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode ReadaheadDllLibrary(const char* dllPath) const = 0;
 };
 
 
@@ -41,6 +41,7 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 MSV_DISABLE_ALL_WARNINGS
 
 #include <memory>
+#include <vector>
 
 MSV_ENABLE_WARNINGS
 
@@ -71,6 +72,17 @@ public:
 	* @retval		MSV_SUCCESS							On success.
 	******************************************************************************************************/
 	virtual MsvErrorCode DecorateDllObject(const char* id, std::shared_ptr<IMsvDllAdapter> spMsvDllAdapter) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL address names.
+	* @details		Returns names of hot DLL addresses (they are resolved by warmup of DLL loaded with
+	*					MSV_DLL_LOAD_WARMUP option). Default implementation returns no names.
+	* @param[out]	dllAddressNames					Hot address names (they must be valid while decorator is alive).
+	******************************************************************************************************/
+	virtual void GetDllAddressNames(std::vector<const char*>& dllAddressNames) const
+	{
+		dllAddressNames.clear();
+	}
 };
 
 
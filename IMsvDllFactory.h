@@ -36,9 +36,27 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "IMsvDll.h"
+#include "MsvDllId.h"
+#include "MsvDllObjectAwaitable.h"
+#include "MsvDllObjectId.h"
+#include "MsvDllObjectPtr.h"
+#include "MsvDllObjectResult.h"
+#include "MsvDllPreloadResult.h"
+#include "MsvDllReclaimer.h"
+#include "MsvDllToken.h"
 
 #include "merror/MsvErrorCodes.h"
 
+MSV_DISABLE_ALL_WARNINGS
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+MSV_ENABLE_WARNINGS
+
 
 /**************************************************************************************************//**
 * @brief		MarsTech DLL Factory Interface.
@@ -80,19 +98,234 @@ public:
 	/**************************************************************************************************//**
 	* @brief			Release DLL library.
 	* @details		Releases dynamic/shared library and unloads it.
-	* @retval		MSV_NOT_ALLOWED_ERROR			When someone else holds shared pointer to dynamic/shared library.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When someone else holds shared pointer to dynamic/shared library or to its DLL objects.
 	* @retval		MSV_NOT_INITIALIZED_INFO		When DLL library has not been initialized (this is info, not error).
 	* @retval		MSV_CLOSE_ERROR					When unload DLL library failed.
 	* @retval		MSV_NOT_FOUND_INFO				When DLL library was not found in loaded DLLs(this is info, not error).
 	* @retval		MSV_SUCCESS							On success.
-	* @warning		All references to dynamic/shared library must be release. Other way fails with MSV_NOT_ALLOWED_ERROR.
+	* @warning		All references to dynamic/shared library and to DLL objects acquired by factory (see
+	*					IMsvDll::GetDllReferenceCount) must be released. Other way fails with MSV_NOT_ALLOWED_ERROR.
 	* @warning		Libraries with reference count greater then 0 should not be unitialized. It might lead
 	*					to crash. On the other way, some DLLs might hold its acquired objects in shared_ptr
 	*					too. Uninitialize just logs warning when uninitializing dynamic/shared library
 	*					with references, but unloads it anyway.
+	* @note			DLL is detached first and it is unloaded after grace period - objects used inside
+	*					read-side sections of @ref GetDllReclaimer stay valid until the sections are left.
 	******************************************************************************************************/
 	virtual MsvErrorCode ReleaseDll(const char* id) = 0;
 
+	/**************************************************************************************************//**
+	* @brief			Get DLL.
+	* @details		Same as @ref GetDll(const char* id, std::shared_ptr<IMsvDll>& spDll), but DLL id is
+	*					binary GUID.
+	* @param[in]	id										DLL id.
+	* @param[out]	spDll									Shared pointer to loaded dynamic/shared library.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const MsvDllId& id, std::shared_ptr<IMsvDll>& spDll) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object.
+	* @details		Same as @ref GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject),
+	*					but DLL (object) id is binary GUID - already acquired objects are found without any
+	*					string comparison.
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @note			DLL entry point gets canonical (upper case) braced GUID string.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObject(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Release DLL library.
+	* @details		Same as @ref ReleaseDll(const char* id), but DLL id is binary GUID.
+	* @param[in]	id										DLL id.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When someone else holds shared pointer to dynamic/shared library or to its DLL objects.
+	* @retval		MSV_NOT_INITIALIZED_INFO		When DLL library has not been initialized (this is info, not error).
+	* @retval		MSV_CLOSE_ERROR					When unload DLL library failed.
+	* @retval		MSV_NOT_FOUND_INFO				When DLL library was not found in loaded DLLs(this is info, not error).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode ReleaseDll(const MsvDllId& id) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Resolve DLL (object) id.
+	* @details		Returns token for DLL (object) id. Token is index to dense token table, so DLL object
+	*					is got by token without DLL list lookup or any map search (see
+	*					@ref GetDllObject(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject)).
+	*					It does not load DLL. Same id always returns same token.
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	token									Token for DLL (object) id.
+	* @retval		MSV_NOT_FOUND_ERROR				When DLL id was not found in DLL list.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed (or token table is full).
+	* @retval		MSV_SUCCESS							On success.
+	* @note			Token is valid for whole life of DLL factory - when DLL is released, it is loaded again
+	*					by next @ref GetDllObject(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject).
+	******************************************************************************************************/
+	virtual MsvErrorCode Resolve(const char* id, MsvDllToken& token) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Resolve DLL (object) id.
+	* @details		Same as @ref Resolve(const char* id, MsvDllToken& token), but DLL (object) id is binary GUID.
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	token									Token for DLL (object) id.
+	* @retval		MSV_NOT_FOUND_ERROR				When DLL id was not found in DLL list.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed (or token table is full).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode Resolve(const MsvDllId& id, MsvDllToken& token) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object.
+	* @details		Same as @ref GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject),
+	*					but DLL (object) is identified by token returned by @ref Resolve. Already acquired
+	*					DLL object is returned by array index only.
+	* @param[in]	token									DLL (object) token.
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @retval		MSV_INVALID_DATA_ERROR			When token is not valid token of this factory.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObject(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get reference counted DLL object.
+	* @details		Same as @ref GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject),
+	*					but DLL object is referenced by intrusive pointer. Factory owns the object (one its
+	*					reference) until its DLL is released and returned pointer counts pin of the DLL (pin
+	*					count is kept by factory) - already acquired object is returned without any shared
+	*					pointer and copies of pointer change pin count only.
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	dllObject							Pointer to acquired DLL object (it must inherit from @ref MsvDllRefCountedObject).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @note			DLL is not released while it is pinned (@ref ReleaseDll returns MSV_NOT_ALLOWED_ERROR).
+	******************************************************************************************************/
+	virtual MsvErrorCode GetRefCountedDllObject(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get reference counted DLL object.
+	* @details		Same as @ref GetRefCountedDllObject(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject),
+	*					but DLL (object) is identified by token returned by @ref Resolve.
+	* @param[in]	token									DLL (object) token.
+	* @param[out]	dllObject							Pointer to acquired DLL object (it must inherit from @ref MsvDllRefCountedObject).
+	* @retval		MSV_INVALID_DATA_ERROR			When token is not valid token of this factory.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetRefCountedDllObject(const MsvDllToken& token, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Preload DLLs.
+	* @details		Loads DLLs of requested DLL (object) ids in parallel - each DLL (path) is loaded only
+	*					once, even when more ids are in it. Startup takes time of the slowest DLL then (not
+	*					sum of all of them) and first requests do not wait for DLL loads.
+	* @param[in]	ids									DLL (object) ids.
+	* @param[in]	instantiate							Flag if DLL objects of ids should be created too (true) or not (false).
+	* @param[in]	threadCount							Maximal count of loading threads (0 means count of hardware threads).
+	* @param[out]	results								Preload result of each DLL (path).
+	* @retval		other_error_code					When any DLL failed (error of the first failed DLL - see results).
+	* @retval		MSV_NOT_FOUND_ERROR				When any DLL id was not found (no DLL is loaded then).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode Preload(const std::vector<std::string>& ids, bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Preload all DLLs.
+	* @details		Same as @ref Preload(const std::vector<std::string>& ids, bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results),
+	*					but all DLLs from DLL list are preloaded.
+	* @param[in]	instantiate							Flag if DLL objects of all ids should be created too (true) or not (false).
+	* @param[in]	threadCount							Maximal count of loading threads (0 means count of hardware threads).
+	* @param[out]	results								Preload result of each DLL (path).
+	* @retval		other_error_code					When any DLL failed (error of the first failed DLL - see results).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When DLL list can't enumerate its DLLs.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode Preload(bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object asynchronously.
+	* @details		Same as @ref GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject),
+	*					but caller is never blocked by DLL load - already acquired DLL object is returned
+	*					inline (callback is called before this method returns), otherwise DLL object is
+	*					acquired by loader thread of factory and callback is called by it.
+	* @param[in]	id										DLL (object) id.
+	* @param[in]	callback								Completion callback (it is called exactly once).
+	* @param[in]	deadline								Deadline of request - when DLL object is not acquired in time, callback
+	*															is called with MSV_TIMEOUT_ERROR (by timer thread of factory). Load is not
+	*															cancelled - acquired DLL object is cached for next requests.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed (callback is not called).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When factory is being destroyed (callback is not called).
+	* @retval		MSV_SUCCESS							When request has been completed or queued.
+	* @note			Callback must not block - it blocks loader (or timer) thread.
+	* @note			Callback (or its captures) might release the last reference to factory - factory is
+	*					destroyed by loader (or timer) thread then (that thread is detached, not joined).
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObjectAsync(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object asynchronously.
+	* @details		Same as @ref GetDllObjectAsync(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline),
+	*					but result is returned by future (it is ready immediately when DLL object has already
+	*					been acquired).
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	future								Future of request result.
+	* @param[in]	deadline								Deadline of request (result is MSV_TIMEOUT_ERROR when DLL object is not acquired in time).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed (future is not valid).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When factory is being destroyed (future is not valid).
+	* @retval		MSV_SUCCESS							When request has been completed or queued.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObjectAsync(const char* id, std::future<MsvDllObjectResult>& future, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL reclaimer.
+	* @details		Returns reclaimer of this factory. Calls into DLL objects inside its read-side section
+	*					(see @ref MsvDllReadSection) are safe even when theirs DLL is being released by other
+	*					thread - release waits for grace period (until all sections entered before DLL has been
+	*					detached are left) before DLL is unloaded. Read-side section is lock-free.
+	* @returns		MsvDllReclaimer&						DLL reclaimer (it is valid as long as factory).
+	* @warning		DLL must not be released inside read-side section of the same thread.
+	******************************************************************************************************/
+	virtual MsvDllReclaimer& GetDllReclaimer() = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Release DLL library asynchronously.
+	* @details		Same as @ref ReleaseDll(const char* id), but DLL is only detached from factory by caller
+	*					(new requests load it again) - grace period, uninitialization and unload (static
+	*					destructors of DLL and unmapping) are done by reaper thread of factory.
+	* @param[in]	id										DLL id.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When someone else holds shared pointer to dynamic/shared library or to its DLL objects.
+	* @retval		MSV_NOT_FOUND_INFO				When DLL library was not found in loaded DLLs(this is info, not error).
+	* @retval		MSV_SUCCESS							When DLL has been detached and its unload has been queued.
+	* @note			Errors of unload are logged only. Pending unloads are finished by factory destructor.
+	* @see			WaitForDllUnloads
+	******************************************************************************************************/
+	virtual MsvErrorCode ReleaseDllAsync(const char* id) = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Wait for DLL unloads.
+	* @details		Waits until all DLLs released by @ref ReleaseDllAsync are unloaded.
+	* @warning		It must not be called inside read-side section (unloads wait for grace periods).
+	******************************************************************************************************/
+	virtual void WaitForDllUnloads() = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL unload metrics.
+	* @details		Returns state of reaper queue and times of DLL unloads (both synchronous and asynchronous).
+	* @param[out]	pendingCount						Count of DLLs released asynchronously which have not been unloaded yet.
+	* @param[out]	unloadedCount						Count of unloaded DLLs.
+	* @param[out]	unloadTime							Total time of unloads (uninitialization of DLLs).
+	* @param[out]	maxUnloadTime						Longest unload.
+	******************************************************************************************************/
+	virtual void GetDllUnloadMetrics(std::uint32_t& pendingCount, std::uint64_t& unloadedCount, std::chrono::microseconds& unloadTime, std::chrono::microseconds& maxUnloadTime) const = 0;
+
 	/**************************************************************************************************//**
 	* @brief			Get DLL object and cast it to right type.
 	* @details		Loads dynamic/shared library (if not already loaded) and gets DLL object from it. Internally
@@ -112,6 +345,125 @@ public:
 		
 		return MSV_SUCCESS;
 	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object and cast it to right type.
+	* @details		Same as @ref GetDllObject(const char* id, std::shared_ptr<T>& spDllObject), but DLL
+	*					(object) id is binary GUID.
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	template<class T> inline MsvErrorCode GetDllObject(const MsvDllId& id, std::shared_ptr<T>& spDllObject)
+	{
+		std::shared_ptr<IMsvDllObject> spInnerDllObject;
+		MSV_RETURN_FAILED(GetDllObject(id, spInnerDllObject));
+
+		spDllObject = std::static_pointer_cast<T, IMsvDllObject>(spInnerDllObject);
+
+		return MSV_SUCCESS;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object and cast it to right type.
+	* @details		Same as @ref GetDllObject(const char* id, std::shared_ptr<T>& spDllObject), but DLL
+	*					(object) is identified by token returned by @ref Resolve.
+	* @param[in]	token									DLL (object) token.
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @retval		MSV_INVALID_DATA_ERROR			When token is not valid token of this factory.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	template<class T> inline MsvErrorCode GetDllObject(const MsvDllToken& token, std::shared_ptr<T>& spDllObject)
+	{
+		std::shared_ptr<IMsvDllObject> spInnerDllObject;
+		MSV_RETURN_FAILED(GetDllObject(token, spInnerDllObject));
+
+		spDllObject = std::static_pointer_cast<T, IMsvDllObject>(spInnerDllObject);
+
+		return MSV_SUCCESS;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get reference counted DLL object.
+	* @details		Same as @ref GetRefCountedDllObject(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject),
+	*					but pointer is cast to right type (no counter is changed by the cast).
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	dllObject							Pointer to acquired DLL object (it must inherit from @ref MsvDllRefCountedObject).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	template<class T> inline MsvErrorCode GetDllObject(const char* id, MsvDllObjectPtr<T>& dllObject)
+	{
+		MsvDllObjectPtr<MsvDllRefCountedObject> innerDllObject;
+		MSV_RETURN_FAILED(GetRefCountedDllObject(id, innerDllObject));
+
+		dllObject = MsvStaticDllObjectCast<T>(std::move(innerDllObject));
+
+		return MSV_SUCCESS;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get reference counted DLL object.
+	* @details		Same as @ref GetDllObject(const char* id, MsvDllObjectPtr<T>& dllObject), but DLL
+	*					(object) is identified by token returned by @ref Resolve.
+	* @param[in]	token									DLL (object) token.
+	* @param[out]	dllObject							Pointer to acquired DLL object (it must inherit from @ref MsvDllRefCountedObject).
+	* @retval		MSV_INVALID_DATA_ERROR			When token is not valid token of this factory.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	template<class T> inline MsvErrorCode GetDllObject(const MsvDllToken& token, MsvDllObjectPtr<T>& dllObject)
+	{
+		MsvDllObjectPtr<MsvDllRefCountedObject> innerDllObject;
+		MSV_RETURN_FAILED(GetRefCountedDllObject(token, innerDllObject));
+
+		dllObject = MsvStaticDllObjectCast<T>(std::move(innerDllObject));
+
+		return MSV_SUCCESS;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object and cast it to right type.
+	* @details		Same as @ref GetDllObject(const MsvDllId& id, std::shared_ptr<T>& spDllObject), but DLL
+	*					(object) id is bound to type T at compile time (no id at call site, no runtime parsing).
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @see			MSV_DLLOBJECT_ID
+	******************************************************************************************************/
+	template<class T> inline MsvErrorCode GetDllObject(std::shared_ptr<T>& spDllObject)
+	{
+		static constexpr MsvDllId id = MsvDllObjectId<T>::Get();
+
+		return GetDllObject<T>(id, spDllObject);
+	}
+
+#ifdef MSV_DLL_COROUTINES
+	/**************************************************************************************************//**
+	* @brief			Await DLL object and cast it to right type.
+	* @details		Coroutine version of @ref GetDllObjectAsync(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline)
+	*					- co_await returns error code of request. Awaiting coroutine is not suspended when DLL
+	*					object has already been acquired, otherwise it is resumed by executor when DLL object
+	*					is acquired by loader thread of factory (or when deadline expires).
+	* @param[in]	id										DLL (object) id (it must be valid until co_await is finished).
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @param[in]	executor								Executor of resumed coroutine (it is called with coroutine handle).
+	* @param[in]	deadline								Deadline of request (result is MSV_TIMEOUT_ERROR when DLL object is not acquired in time).
+	* @returns		MsvDllObjectAwaitable			Awaitable request (it must be awaited immediately).
+	* @note			It is available with C++20 coroutines only (see @ref MSV_DLL_COROUTINES).
+	******************************************************************************************************/
+	template<class T, class Executor = MsvDllInlineExecutor> inline MsvDllObjectAwaitable<T, Executor> AwaitDllObject(const char* id, std::shared_ptr<T>& spDllObject, const Executor& executor = Executor(), std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+	{
+		return MsvDllObjectAwaitable<T, Executor>(*this, id, spDllObject, executor, deadline);
+	}
+#endif // MSV_DLL_COROUTINES
 };
 
 
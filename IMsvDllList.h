@@ -36,10 +36,15 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "IMsvDllDecorator.h"
+#include "MsvDllId.h"
+#include "MsvDllLoadOptions.h"
+
+#include "merror/MsvErrorCodes.h"
 
 MSV_DISABLE_ALL_WARNINGS
 
 #include <string>
+#include <vector>
 
 MSV_ENABLE_WARNINGS
 
@@ -70,6 +75,80 @@ public:
 	* @retval		MSV_SUCCESS					On success.
 	******************************************************************************************************/
 	virtual MsvErrorCode GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const = 0;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL data.
+	* @details		Returns DLL data (path, decorarator) for DLL by it binary GUID id. Default implementation
+	*					formats id to string and calls @ref GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const.
+	* @param[in]	id								DLL id.
+	* @param[out]	dllPath						Path to DLL.
+	* @param[out]	spDllDecorator				Shared pointer to DLL/object decorator.
+	* @retval		other_error_code			When failed.
+	* @retval		MSV_NOT_FOUND_ERROR		When DLL id was not found.
+	* @retval		MSV_SUCCESS					On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const
+	{
+		char idString[MSV_DLL_ID_STRING_SIZE];
+
+		return GetDll(id.ToString(idString), dllPath, spDllDecorator);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL data.
+	* @details		Returns DLL data (path, decorarator, load options) for DLL by it id. Default implementation
+	*					calls @ref GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const
+	*					and returns default load options (DLL list which does not store load options does not
+	*					override it).
+	* @param[in]	id								DLL id.
+	* @param[out]	dllPath						Path to DLL.
+	* @param[out]	spDllDecorator				Shared pointer to DLL/object decorator.
+	* @param[out]	loadOptions					DLL load options (see @ref MsvDllLoadOption).
+	* @retval		other_error_code			When failed.
+	* @retval		MSV_NOT_FOUND_ERROR		When DLL id was not found.
+	* @retval		MSV_SUCCESS					On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+	{
+		loadOptions = MSV_DLL_LOAD_DEFAULT;
+
+		return GetDll(id, dllPath, spDllDecorator);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL data.
+	* @details		Returns DLL data (path, decorarator, load options) for DLL by it binary GUID id. Default
+	*					implementation formats id to string and calls @ref GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const.
+	* @param[in]	id								DLL id.
+	* @param[out]	dllPath						Path to DLL.
+	* @param[out]	spDllDecorator				Shared pointer to DLL/object decorator.
+	* @param[out]	loadOptions					DLL load options (see @ref MsvDllLoadOption).
+	* @retval		other_error_code			When failed.
+	* @retval		MSV_NOT_FOUND_ERROR		When DLL id was not found.
+	* @retval		MSV_SUCCESS					On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+	{
+		char idString[MSV_DLL_ID_STRING_SIZE];
+
+		return GetDll(id.ToString(idString), dllPath, spDllDecorator, loadOptions);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL ids.
+	* @details		Returns ids of all DLLs in list (braced GUID ids are in canonical upper case form). Default
+	*					implementation fails - DLL list which can't enumerate its DLLs does not override it.
+	* @param[out]	ids							DLL ids.
+	* @retval		other_error_code			When failed.
+	* @retval		MSV_NOT_ALLOWED_ERROR	When DLL list can't enumerate its DLLs.
+	* @retval		MSV_SUCCESS					On success.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllIds(std::vector<std::string>& ids) const
+	{
+		ids.clear();
+
+		return MSV_NOT_ALLOWED_ERROR;
+	}
 };
 
 
@@ -18,9 +18,14 @@ class MsvDllAdapter_Mock:
 {
 public:
 	MOCK_METHOD2(GetDllAddress, MsvErrorCode(const char* dllAddressName, void*& pdllAddress));
+	MOCK_METHOD2(GetDllAddresses, MsvErrorCode(const std::vector<const char*>& dllAddressNames, std::vector<void*>& dllAddresses));
 	MOCK_CONST_METHOD0(Loaded, bool());
-	MOCK_METHOD1(LoadDllLibrary, MsvErrorCode(const char* dllPath));
+	MOCK_METHOD2(LoadDllLibrary, MsvErrorCode(const char* dllPath, MsvDllLoadOptions loadOptions));
 	MOCK_METHOD0(UnloadDllLibrary, MsvErrorCode());
+	MOCK_METHOD0(DetachDllLibrary, MsvErrorCode());
+	MOCK_METHOD2(WarmupDllLibrary, MsvErrorCode(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled));
+	MOCK_CONST_METHOD2(GetDllPrefault, void(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime));
+	MOCK_CONST_METHOD1(ReadaheadDllLibrary, MsvErrorCode(const char* dllPath));
 };
 
 
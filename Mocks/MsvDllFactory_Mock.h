@@ -20,6 +20,22 @@ public:
 	MOCK_METHOD2(GetDll, MsvErrorCode(const char* id, std::shared_ptr<IMsvDll>& spDll));
 	MOCK_METHOD2(GetDllObject, MsvErrorCode(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject));
 	MOCK_METHOD1(ReleaseDll, MsvErrorCode(const char* id));
+	MOCK_METHOD2(GetDll, MsvErrorCode(const MsvDllId& id, std::shared_ptr<IMsvDll>& spDll));
+	MOCK_METHOD2(GetDllObject, MsvErrorCode(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject));
+	MOCK_METHOD1(ReleaseDll, MsvErrorCode(const MsvDllId& id));
+	MOCK_METHOD2(Resolve, MsvErrorCode(const char* id, MsvDllToken& token));
+	MOCK_METHOD2(Resolve, MsvErrorCode(const MsvDllId& id, MsvDllToken& token));
+	MOCK_METHOD2(GetDllObject, MsvErrorCode(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject));
+	MOCK_METHOD2(GetRefCountedDllObject, MsvErrorCode(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject));
+	MOCK_METHOD2(GetRefCountedDllObject, MsvErrorCode(const MsvDllToken& token, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject));
+	MOCK_METHOD4(Preload, MsvErrorCode(const std::vector<std::string>& ids, bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results));
+	MOCK_METHOD3(Preload, MsvErrorCode(bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results));
+	MOCK_METHOD3(GetDllObjectAsync, MsvErrorCode(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline));
+	MOCK_METHOD3(GetDllObjectAsync, MsvErrorCode(const char* id, std::future<MsvDllObjectResult>& future, std::chrono::steady_clock::time_point deadline));
+	MOCK_METHOD0(GetDllReclaimer, MsvDllReclaimer&());
+	MOCK_METHOD1(ReleaseDllAsync, MsvErrorCode(const char* id));
+	MOCK_METHOD0(WaitForDllUnloads, void());
+	MOCK_CONST_METHOD4(GetDllUnloadMetrics, void(std::uint32_t& pendingCount, std::uint64_t& unloadedCount, std::chrono::microseconds& unloadTime, std::chrono::microseconds& maxUnloadTime));
 };
 
 
@@ -18,6 +18,7 @@ class MsvDllList_Mock:
 {
 public:
 	MOCK_METHOD3(GetDll, MsvErrorCode(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator));
+	MOCK_CONST_METHOD4(GetDll, MsvErrorCode(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions));
 };
 
 
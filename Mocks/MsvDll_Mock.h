@@ -17,11 +17,14 @@ class MsvDll_Mock:
 	public IMsvDll
 {
 public:
-	MOCK_METHOD1(Initialize, MsvErrorCode(const char* dllPath));
+	MOCK_METHOD2(Initialize, MsvErrorCode(const char* dllPath, MsvDllLoadOptions loadOptions));
 	MOCK_METHOD0(Uninitialize, MsvErrorCode());
+	MOCK_METHOD0(Detach, MsvErrorCode());
 	MOCK_CONST_METHOD0(Initialized, bool());
 	MOCK_METHOD3(GetDllObject, MsvErrorCode(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject, std::shared_ptr<IMsvDllDecorator> spDecorator = nullptr));
 	MOCK_CONST_METHOD0(GetDllReferenceCount, std::int64_t());
+	MOCK_METHOD2(WarmupDll, MsvErrorCode(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled));
+	MOCK_CONST_METHOD2(GetDllPrefault, void(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime));
 };
 
 
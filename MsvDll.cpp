@@ -63,7 +63,7 @@ MsvDll::~MsvDll()
 ********************************************************************************************************************************/
 
 
-MsvErrorCode MsvDll::Initialize(const char* dllPath)
+MsvErrorCode MsvDll::Initialize(const char* dllPath, MsvDllLoadOptions loadOptions)
 {
 	std::lock_guard<std::recursive_mutex> lock(m_lock);
 
@@ -83,7 +83,15 @@ MsvErrorCode MsvDll::Initialize(const char* dllPath)
 		return MSV_ALLOCATION_ERROR;
 	}
 	
-	MSV_RETURN_FAILED(m_spDllAdapter->LoadDllLibrary(dllPath));
+	//references of objects from previously loaded library are not counted
+	m_spReferenceCount.reset(new (std::nothrow) std::atomic<std::int64_t>(0));
+	if (!m_spReferenceCount)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Create reference count for DLL library \"{}\" failed.", dllPath);
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	MSV_RETURN_FAILED(m_spDllAdapter->LoadDllLibrary(dllPath, loadOptions));
 
 	m_initialized = true;
 
@@ -92,7 +100,7 @@ MsvErrorCode MsvDll::Initialize(const char* dllPath)
 
 MsvErrorCode MsvDll::Uninitialize()
 {
-	std::lock_guard<std::recursive_mutex> lock(m_lock);
+	std::unique_lock<std::recursive_mutex> lock(m_lock);
 
 	MSV_LOG_INFO(m_spLogger, "Uninitializing DLL library.");
 
@@ -102,10 +110,19 @@ MsvErrorCode MsvDll::Uninitialize()
 		return MSV_NOT_INITIALIZED_INFO;
 	}
 
-	if (GetDllReferenceCount() > 0)
+	//wait for objects which are being created right now (they are created outside of lock and they run DLL code)
+	for (std::shared_ptr<MsvDllSingleFlight<std::shared_ptr<IMsvDllObject>>::MsvFlight> spFlight = m_creatingObjects.GetAnyFlight(); spFlight; spFlight = m_creatingObjects.GetAnyFlight())
+	{
+		lock.unlock();
+		spFlight->Wait();
+		lock.lock();
+	}
+
+	std::int64_t referenceCount = GetDllReferenceCount();
+	if (referenceCount > 0)
 	{
 		//DLL has referenced objects (it might me shared_ptr in DLL but it might be shared_ptr anywhere else, we don't know) -> just log WARNING
-		MSV_LOG_WARN(m_spLogger, "Unloading DLL library with references - reference count: {}", GetDllReferenceCount());
+		MSV_LOG_WARN(m_spLogger, "Unloading DLL library with references - reference count: {}", referenceCount);
 
 		//return MSV_INVALID_DATA_ERROR;
 	}
@@ -116,6 +133,29 @@ MsvErrorCode MsvDll::Uninitialize()
 
 	m_pGetDllObjectFunction = nullptr;	
 	m_spDllAdapter.reset();
+	m_spReferenceCount.reset();
+
+	m_initialized = false;
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDll::Detach()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	if (!Initialized())
+	{
+		return MSV_NOT_INITIALIZED_INFO;
+	}
+
+	//library stays loaded - objects which are being created right now are not waited for (DLL code stays mapped)
+	m_dllObjects.clear();
+	MSV_RETURN_FAILED(m_spDllAdapter->DetachDllLibrary());
+
+	m_pGetDllObjectFunction = nullptr;
+	m_spDllAdapter.reset();
+	m_spReferenceCount.reset();
 
 	m_initialized = false;
 
@@ -131,65 +171,131 @@ bool MsvDll::Initialized() const
 
 MsvErrorCode MsvDll::GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject, std::shared_ptr<IMsvDllDecorator> spDecorator)
 {
-	std::lock_guard<std::recursive_mutex> lock(m_lock);
+	std::shared_ptr<MsvDllSingleFlight<std::shared_ptr<IMsvDllObject>>::MsvFlight> spFlight;
+	std::shared_ptr<IMsvDllAdapter> spDllAdapter;
+	std::shared_ptr<std::atomic<std::int64_t>> spReferenceCount;
+	MsvErrorCode(*pGetDllObjectFunction)(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject) = nullptr;
+	bool leader = false;
 
-	MSV_LOG_INFO(m_spLogger, "Getting DLL object \"{}\".", id);
-
-	if (!Initialized())
 	{
-		MSV_LOG_ERROR(m_spLogger, "Trying to get DLL object \"{}\" from uninitialized DLL.", id);
-		return MSV_NOT_INITIALIZED_ERROR;
-	}
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
 
-	//check if is in map
-	std::map<std::string, std::weak_ptr<IMsvDllObject>>::iterator it = m_dllObjects.find(id);
-	if (it != m_dllObjects.end())
-	{
-		if ((spDllObject = it->second.lock()))
+		MSV_LOG_INFO(m_spLogger, "Getting DLL object \"{}\".", id);
+
+		if (!Initialized())
 		{
-			return MSV_SUCCESS;
+			MSV_LOG_ERROR(m_spLogger, "Trying to get DLL object \"{}\" from uninitialized DLL.", id);
+			return MSV_NOT_INITIALIZED_ERROR;
+		}
+
+		//check if is in map
+		std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>>::iterator it = m_dllObjects.find(id);
+		if (it != m_dllObjects.end())
+		{
+			if ((spDllObject = it->second.lock()))
+			{
+				return MSV_SUCCESS;
+			}
+		}
+
+		//not in map or weak_ptr is expired -> join creation of this object (only one thread creates it)
+		spFlight = m_creatingObjects.Join(id, leader);
+		if (!spFlight)
+		{
+			MSV_LOG_ERROR(m_spLogger, "Create DLL object creation for \"{}\" failed.", id);
+			return MSV_ALLOCATION_ERROR;
+		}
+
+		if (leader)
+		{
+			spDllAdapter = m_spDllAdapter;
+			spReferenceCount = m_spReferenceCount;
+
+			//it is DLL with exported function GetDllObject -> check if GetDllObject is already loaded and load it if not
+			if (!spDecorator && !m_pGetDllObjectFunction)
+			{
+				MsvErrorCode errorCode = MSV_SUCCESS;
+				void* pDllAddress = nullptr;
+				if (MSV_FAILED(errorCode = m_spDllAdapter->GetDllAddress("GetDllObject", pDllAddress)))
+				{
+					MSV_LOG_ERROR(m_spLogger, "Get DLL address \"GetDllObject\" (for object \"{}\") failed with error: {0:x}.", id, errorCode);
+					m_creatingObjects.Leave(id);
+					spFlight->Complete(errorCode, nullptr);
+					return errorCode;
+				}
+
+				//m_pGetDllObjectFunction = (MsvErrorCode (*)(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject))pDllAddress;
+				m_pGetDllObjectFunction = reinterpret_cast<MsvErrorCode(*)(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject)>(pDllAddress);
+			}
+
+			pGetDllObjectFunction = m_pGetDllObjectFunction;
 		}
 	}
 
-	//not in map or weak_ptr is expired
+	MsvErrorCode errorCode = MSV_SUCCESS;
 
-	//object is not in the map -> load it
-	std::shared_ptr<IMsvDllObject> spInnerDllObject;
-	if (spDecorator)
+	if (!leader)
 	{
-		//it is DLL without exported function GetDllObject (probably C DLL, third party DLL, etc.)
-		MSV_RETURN_FAILED(spDecorator->DecorateDllObject(id, m_spDllAdapter));
-		spInnerDllObject = spDecorator;
+		//other thread is creating this object -> wait for it and share its result (even error)
+		if (MSV_FAILED(errorCode = spFlight->Wait(spDllObject)))
+		{
+			MSV_LOG_ERROR(m_spLogger, "Get DLL object \"{}\" in other thread failed with error: {0:x}.", id, errorCode);
+		}
+
+		return errorCode;
 	}
-	else
+
+	//create object outside of DLL lock (waiters wait for flight, not for lock), but one by one (objects of other ids)
+	std::shared_ptr<IMsvDllObject> spInnerDllObject;
 	{
-		//it is DLL with exported function GetDllObject
-		MsvErrorCode errorCode = MSV_SUCCESS;
+		std::lock_guard<std::recursive_mutex> createLock(m_createLock);
 
-		//check if GetDllObject is already loaded and load it if not
-		if (!m_pGetDllObjectFunction)
+		if (spDecorator)
 		{
-			void* pDllAddress = nullptr;
-			if (MSV_FAILED(errorCode = m_spDllAdapter->GetDllAddress("GetDllObject", pDllAddress)))
+			//it is DLL without exported function GetDllObject (probably C DLL, third party DLL, etc.)
+			if (MSV_SUCCEEDED(errorCode = spDecorator->DecorateDllObject(id, spDllAdapter)))
 			{
-				MSV_LOG_ERROR(m_spLogger, "Get DLL address \"GetDllObject\" (for object \"{}\") failed with error: {0:x}.", id, errorCode);
-				return errorCode;
+				spInnerDllObject = spDecorator;
 			}
-
-			//m_pGetDllObjectFunction = (MsvErrorCode (*)(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject))pDllAddress;
-			m_pGetDllObjectFunction = reinterpret_cast<MsvErrorCode(*)(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject)>(pDllAddress);
 		}
+		else
+		{
+			//GetDllObject function is loaded -> load requested DLL object
+			errorCode = pGetDllObjectFunction(id, spInnerDllObject);
+		}
+	}
+
+	if (MSV_SUCCEEDED(errorCode) && spInnerDllObject)
+	{
+		//returned shared pointers share counting wrapper - its deleter releases object and then decrements reference count (O(1) count)
+		spReferenceCount->fetch_add(1, std::memory_order_relaxed);
+		std::shared_ptr<IMsvDllObject> spCountedDllObject(spInnerDllObject.get(), [spInnerDllObject, spReferenceCount](IMsvDllObject*) mutable
+		{
+			spInnerDllObject.reset();
+			spReferenceCount->fetch_sub(1, std::memory_order_release);
+		});
+		spInnerDllObject = spCountedDllObject;
+	}
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
 
-		//GetDllObject function is loaded -> load requested DLL object
-		if (MSV_FAILED(errorCode = m_pGetDllObjectFunction(id, spInnerDllObject)))
+		m_creatingObjects.Leave(id);
+		if (MSV_SUCCEEDED(errorCode))
 		{
-			MSV_LOG_ERROR(m_spLogger, "Get DLL object \"{}\" from DLL failed with error: {0:x}.", id, errorCode);
-			return errorCode;
+			//insert object to map
+			m_dllObjects[id] = spInnerDllObject;
 		}
 	}
 
-	//insert object to map
-	m_dllObjects[id] = spInnerDllObject;
+	if (MSV_FAILED(errorCode))
+	{
+		MSV_LOG_ERROR(m_spLogger, "Get DLL object \"{}\" from DLL failed with error: {0:x}.", id, errorCode);
+		spFlight->Complete(errorCode, nullptr);
+		return errorCode;
+	}
+
+	spFlight->Complete(MSV_SUCCESS, spInnerDllObject);
 	spDllObject = spInnerDllObject;
 
 	return MSV_SUCCESS;
@@ -199,19 +305,44 @@ std::int64_t MsvDll::GetDllReferenceCount() const
 {
 	std::lock_guard<std::recursive_mutex> lock(m_lock);
 
-	std::int64_t referenceCount = 0;
+	//count is maintained by acquired objects (it does not depend on count of objects ids)
+	return m_spReferenceCount ? m_spReferenceCount->load(std::memory_order_acquire) : 0;
+}
+
+MsvErrorCode MsvDll::WarmupDll(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled)
+{
+	std::shared_ptr<IMsvDllAdapter> spDllAdapter;
 
-	//get all objects from DLL and add reference count
-	std::map<std::string, std::weak_ptr<IMsvDllObject>>::const_iterator endIt = m_dllObjects.end();
-	for (std::map<std::string, std::weak_ptr<IMsvDllObject>>::const_iterator it = m_dllObjects.begin(); it != endIt; ++it)
 	{
-		referenceCount += it->second.use_count();
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		MSV_LOG_INFO(m_spLogger, "Warming up DLL library.");
+
+		if (!Initialized())
+		{
+			MSV_LOG_ERROR(m_spLogger, "Trying to warm up uninitialized DLL.");
+			return MSV_NOT_INITIALIZED_ERROR;
+		}
+
+		spDllAdapter = m_spDllAdapter;
+	}
+
+	//warm up outside of DLL lock (adapter stops warmup when library is unloaded meanwhile)
+	return spDllAdapter->WarmupDllLibrary(dllAddressNames, cancelled);
+}
 
-		//consider to add reference counting to IMsvDllObject
-		//referenceCount += it->second->GetReferenceCount();
+void MsvDll::GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	if (!Initialized())
+	{
+		prefaultedPages = 0;
+		prefaultTime = std::chrono::microseconds(0);
+		return;
 	}
 
-	return referenceCount;
+	m_spDllAdapter->GetDllPrefault(prefaultedPages, prefaultTime);
 }
 
 
@@ -36,11 +36,13 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "IMsvDll.h"
+#include "MsvDllSingleFlight.h"
 
 #include "mlogging/mlogging.h"
 
 MSV_DISABLE_ALL_WARNINGS
 
+#include <atomic>
 #include <map>
 #include <mutex>
 
@@ -90,15 +92,20 @@ public:
 	MsvDll& operator= (const MsvDll& origin) = delete;
 
 	/**************************************************************************************************//**
-	* @copydoc IMsvDll::Initialize(const char* dllPath)
+	* @copydoc IMsvDll::Initialize(const char* dllPath, MsvDllLoadOptions loadOptions)
 	******************************************************************************************************/
-	virtual MsvErrorCode Initialize(const char* dllPath) override;
+	virtual MsvErrorCode Initialize(const char* dllPath, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT) override;
 
 	/**************************************************************************************************//**
 	* @copydoc IMsvDll::Uninitialize()
 	******************************************************************************************************/
 	virtual MsvErrorCode Uninitialize() override;
 
+	/**************************************************************************************************//**
+	* @copydoc IMsvDll::Detach()
+	******************************************************************************************************/
+	virtual MsvErrorCode Detach() override;
+
 	/**************************************************************************************************//**
 	* @copydoc IMsvDll::Initialized()
 	******************************************************************************************************/
@@ -114,6 +121,16 @@ public:
 	******************************************************************************************************/
 	virtual std::int64_t GetDllReferenceCount() const override;
 
+	/**************************************************************************************************//**
+	* @copydoc IMsvDll::WarmupDll(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled)
+	******************************************************************************************************/
+	virtual MsvErrorCode WarmupDll(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDll::GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const
+	******************************************************************************************************/
+	virtual void GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const override;
+
 protected:
 	/**************************************************************************************************//**
 	* @brief		Thread pool mutex.
@@ -126,7 +143,23 @@ protected:
 	* @details	Stored weak_ptrs to objects acquired from DLL.
 	* @see		IMsvDllObject
 	******************************************************************************************************/
-	std::map<std::string, std::weak_ptr<IMsvDllObject>> m_dllObjects;
+	std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>> m_dllObjects;
+
+	/**************************************************************************************************//**
+	* @brief		Objects being created.
+	* @details	Objects which are being acquired from DLL right now (each object is created by one thread
+	*				only, other threads wait for its result).
+	* @see		MsvDllSingleFlight
+	******************************************************************************************************/
+	MsvDllSingleFlight<std::shared_ptr<IMsvDllObject>> m_creatingObjects;
+
+	/**************************************************************************************************//**
+	* @brief		Create mutex.
+	* @details	Serializes creation of DLL objects of different ids (decorator and exported GetDllObject
+	*				function are not required to be thread safe). It is separate from @ref m_lock - cached
+	*				objects are returned while object is created and waiters for same id wait for its flight.
+	******************************************************************************************************/
+	std::recursive_mutex m_createLock;
 
 	/**************************************************************************************************//**
 	* @brief		Initialize flag.
@@ -151,6 +184,15 @@ protected:
 	* @see		IMsvDllAdapter
 	******************************************************************************************************/
 	std::shared_ptr<IMsvDllAdapter> m_spDllAdapter;
+
+	/**************************************************************************************************//**
+	* @brief		Reference count.
+	* @details	Count of acquired DLL objects which are referenced. It is decremented by deleter of returned
+	*				shared pointers (it is shared with them, so they can outlive this object), so it is read
+	*				without walking @ref m_dllObjects.
+	* @see		GetDllReferenceCount
+	******************************************************************************************************/
+	std::shared_ptr<std::atomic<std::int64_t>> m_spReferenceCount;
 	
 	/**************************************************************************************************//**
 	* @brief		Dependency injection factory.
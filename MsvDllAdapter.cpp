@@ -35,6 +35,32 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 #include "merror/MsvErrorCodes.h"
 
+MSV_DISABLE_ALL_WARNINGS
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // !_WIN32
+
+#if !defined(_WIN32) && defined(__GLIBC__)
+#include <link.h>
+
+//dynamic symbol table of loaded library can be read (see MsvDllAdapter::MsvDllSymbolTable)
+#define MSV_DLL_GNU_HASH
+
+//program headers of loaded library can be read (see MsvDllAdapter::GetDllCodeRanges)
+#define MSV_DLL_LINK_MAP
+#endif // !defined(_WIN32) && defined(__GLIBC__)
+
+MSV_ENABLE_WARNINGS
+
 
 /********************************************************************************************************************************
 *															Constructors and destructors
@@ -43,6 +69,11 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 MsvDllAdapter::MsvDllAdapter(std::shared_ptr<MsvLogger> spLogger):
 	m_pHandle(nullptr),
+	m_addressCacheCount(0),
+	m_addressCacheHits(0),
+	m_addressCacheMisses(0),
+	m_prefaultedPages(0),
+	m_prefaultTime(0),
 	m_spLogger(spLogger)
 {
 	
@@ -53,6 +84,24 @@ MsvDllAdapter::~MsvDllAdapter()
 	UnloadDllLibrary();
 }
 
+MsvDllAdapter::MsvDllSymbolTable::MsvDllSymbolTable():
+	m_baseAddress(0),
+	m_pGnuHash(nullptr),
+	m_pSymbols(nullptr),
+	m_pStrings(nullptr),
+	m_pVersions(nullptr)
+{
+
+}
+
+MsvDllAdapter::MsvDllAddressCacheEntry::MsvDllAddressCacheEntry():
+	m_hash(0),
+	m_pDllAddress(nullptr),
+	m_nameOffset(0)
+{
+
+}
+
 
 /********************************************************************************************************************************
 *															IMsvDllAdapter public methods
@@ -61,37 +110,104 @@ MsvDllAdapter::~MsvDllAdapter()
 
 MsvErrorCode MsvDllAdapter::GetDllAddress(const char* dllAddressName, void*& pdllAddress)
 {
+	std::size_t hash = HashDllAddressName(dllAddressName);
+
 	std::lock_guard<std::recursive_mutex> lock(m_lock);
 
+	pdllAddress = nullptr;
+
+	if (!m_pHandle)
+	{
+		MSV_LOG_ERROR(m_spLogger, "The library has not been loaded (it must be loaded before calling GetProcAddress)!");
+		return MSV_NOT_INITIALIZED_ERROR;
+	}
+
+	//already resolved address -> hash probe only (no dynamic linker, no logging)
+	pdllAddress = FindDllAddress(dllAddressName, hash);
+	if (pdllAddress)
+	{
+		m_addressCacheHits.fetch_add(1, std::memory_order_relaxed);
+		return MSV_SUCCESS;
+	}
+
+	m_addressCacheMisses.fetch_add(1, std::memory_order_relaxed);
+
 	MSV_LOG_INFO(m_spLogger, "Loading DLL address \"{}\".", dllAddressName);
 
-	pdllAddress = nullptr;
+	MSV_RETURN_FAILED(LoadDllAddress(dllAddressName, pdllAddress));
+	CacheDllAddress(dllAddressName, hash, pdllAddress);
 
-	if (!Loaded())
+	MSV_LOG_INFO(m_spLogger, "DLL address \"{}\" has been successfully loaded.", dllAddressName);
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllAdapter::GetDllAddresses(const std::vector<const char*>& dllAddressNames, std::vector<void*>& dllAddresses)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	dllAddresses.assign(dllAddressNames.size(), nullptr);
+
+	if (!m_pHandle)
 	{
 		MSV_LOG_ERROR(m_spLogger, "The library has not been loaded (it must be loaded before calling GetProcAddress)!");
 		return MSV_NOT_INITIALIZED_ERROR;
 	}
 
-#ifdef _WIN32
-	FARPROC farProc = GetProcAddress(m_pHandle, dllAddressName);
-	if (!farProc)
+	MSV_LOG_INFO(m_spLogger, "Loading {} DLL addresses.", dllAddressNames.size());
+
+	//all addresses fit to cache without rehashing
+	ReserveDllAddresses(m_addressCacheCount + dllAddressNames.size());
+
+	//symbol table is read only when any address is not cached
+	MsvDllSymbolTable symbolTable;
+	bool symbolTableRead = false;
+	bool symbolTableAvailable = false;
+
+	std::size_t notFoundCount = 0;
+	std::size_t hitCount = 0;
+	for (std::size_t i = 0; i < dllAddressNames.size(); ++i)
 	{
-		MSV_LOG_ERROR(m_spLogger, "GetProcAddress \"{}\" failed with error: {}", dllAddressName, GetLastError());
-		return MSV_NOT_FOUND_ERROR;
+		const char* dllAddressName = dllAddressNames[i];
+		std::size_t hash = HashDllAddressName(dllAddressName);
+
+		void* pdllAddress = FindDllAddress(dllAddressName, hash);
+		if (pdllAddress)
+		{
+			++hitCount;
+			dllAddresses[i] = pdllAddress;
+			continue;
+		}
+
+		if (!symbolTableRead)
+		{
+			symbolTableAvailable = symbolTable.Initialize(m_pHandle);
+			symbolTableRead = true;
+		}
+
+		//symbol of library itself -> GNU hash lookup, otherwise system lookup (dependencies, indirect functions, etc.)
+		pdllAddress = symbolTableAvailable ? symbolTable.Find(dllAddressName) : nullptr;
+		if (!pdllAddress && MSV_FAILED(LoadDllAddress(dllAddressName, pdllAddress)))
+		{
+			//keep going - all not found addresses are reported at once
+			++notFoundCount;
+			continue;
+		}
+
+		CacheDllAddress(dllAddressName, hash, pdllAddress);
+		dllAddresses[i] = pdllAddress;
 	}
-#else
-	void* farProc = dlsym(m_pHandle, dllAddressName);
-	if (!farProc)
+
+	m_addressCacheHits.fetch_add(hitCount, std::memory_order_relaxed);
+	m_addressCacheMisses.fetch_add(dllAddressNames.size() - hitCount, std::memory_order_relaxed);
+
+	if (notFoundCount)
 	{
-		MSV_LOG_ERROR(m_spLogger, "Load symbol \"{}\" failed with error: {}", dllAddressName, dlerror());
+		MSV_LOG_ERROR(m_spLogger, "{} of {} DLL addresses have not been found.", notFoundCount, dllAddressNames.size());
 		return MSV_NOT_FOUND_ERROR;
 	}
-#endif //_WIN32
 
-	pdllAddress = farProc;
-
-	MSV_LOG_INFO(m_spLogger, "DLL address \"{}\" has been successfully loaded.", dllAddressName);
+	MSV_LOG_INFO(m_spLogger, "{} DLL addresses have been successfully loaded.", dllAddressNames.size());
 
 	return MSV_SUCCESS;
 }
@@ -103,7 +219,7 @@ bool MsvDllAdapter::Loaded() const
 	return m_pHandle ? true : false;
 }
 
-MsvErrorCode MsvDllAdapter::LoadDllLibrary(const char* dllPath)
+MsvErrorCode MsvDllAdapter::LoadDllLibrary(const char* dllPath, MsvDllLoadOptions loadOptions)
 {
 	std::lock_guard<std::recursive_mutex> lock(m_lock);
 
@@ -122,8 +238,32 @@ MsvErrorCode MsvDllAdapter::LoadDllLibrary(const char* dllPath)
 		MSV_LOG_ERROR(m_spLogger, "Load DLL library \"{}\" failed with error: {}", dllPath, GetLastError());
 		return MSV_OPEN_ERROR;
 	}
+
+	//imports are always bound at load time (there is no lazy binding and no symbol scope), only pinning is supported
+	HMODULE pPinnedHandle = nullptr;
+	if ((loadOptions & MSV_DLL_LOAD_NODELETE) && !GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_PIN | GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCTSTR>(m_pHandle), &pPinnedHandle))
+	{
+		MSV_LOG_WARN(m_spLogger, "Pin DLL library \"{}\" failed with error: {}", dllPath, GetLastError());
+	}
 #else
-	m_pHandle = dlopen(dllPath, RTLD_LAZY);
+	int flags = (loadOptions & MSV_DLL_LOAD_NOW) ? RTLD_NOW : RTLD_LAZY;
+	flags |= (loadOptions & MSV_DLL_LOAD_GLOBAL) ? RTLD_GLOBAL : RTLD_LOCAL;
+
+	if (loadOptions & MSV_DLL_LOAD_DEEPBIND)
+	{
+#ifdef RTLD_DEEPBIND
+		flags |= RTLD_DEEPBIND;
+#else
+		MSV_LOG_WARN(m_spLogger, "RTLD_DEEPBIND is not supported - DLL library \"{}\" is loaded without it.", dllPath);
+#endif // RTLD_DEEPBIND
+	}
+
+	if (loadOptions & MSV_DLL_LOAD_NODELETE)
+	{
+		flags |= RTLD_NODELETE;
+	}
+
+	m_pHandle = dlopen(dllPath, flags);
 	if (!m_pHandle)
 	{
 		MSV_LOG_ERROR(m_spLogger, "Load DLL library \"{}\" failed with error: {}", dllPath, dlerror());
@@ -131,6 +271,19 @@ MsvErrorCode MsvDllAdapter::LoadDllLibrary(const char* dllPath)
 	}
 #endif //_WIN32
 
+	m_prefaultedPages = 0;
+	m_prefaultTime = std::chrono::microseconds(0);
+
+	if (loadOptions & MSV_DLL_LOAD_HUGE_PAGES)
+	{
+		RemapDllLibraryHugePages();
+	}
+
+	if (loadOptions & MSV_DLL_LOAD_PREFAULT)
+	{
+		PrefaultDllLibrary();
+	}
+
 	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" has been successfully loaded.", dllPath);
 
 	return MSV_SUCCESS;
@@ -166,10 +319,606 @@ MsvErrorCode MsvDllAdapter::UnloadDllLibrary()
 
 	m_pHandle = nullptr;
 
+	//cached addresses belong to unloaded library (library loaded next time might be mapped elsewhere)
+	std::vector<MsvDllAddressCacheEntry>().swap(m_addressCache);
+	std::vector<char>().swap(m_addressNames);
+	m_addressCacheCount = 0;
+
 	MSV_LOG_INFO(m_spLogger, "DLL library has been successfully unloaded.");
 
 	return MSV_SUCCESS;
 }
 
+MsvErrorCode MsvDllAdapter::DetachDllLibrary()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	if (!Loaded())
+	{
+		return MSV_NOT_INITIALIZED_INFO;
+	}
+
+	//handle is leaked - library is unloaded by process exit
+	m_pHandle = nullptr;
+
+	std::vector<MsvDllAddressCacheEntry>().swap(m_addressCache);
+	std::vector<char>().swap(m_addressNames);
+	m_addressCacheCount = 0;
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllAdapter::WarmupDllLibrary(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled)
+{
+	const void* pHandle = nullptr;
+	std::vector<void*> dllAddresses;
+	std::vector<std::pair<std::uintptr_t, std::size_t>> codeRanges;
+	std::size_t pageSize = GetPageSize();
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		MSV_LOG_INFO(m_spLogger, "Warming up DLL library.");
+
+		if (!m_pHandle)
+		{
+			MSV_LOG_ERROR(m_spLogger, "The library has not been loaded (it must be loaded before warmup)!");
+			return MSV_NOT_INITIALIZED_ERROR;
+		}
+
+		pHandle = m_pHandle;
+
+		//resolved hot addresses are cached -> decorators do not search library
+		if (MSV_FAILED(GetDllAddresses(dllAddressNames, dllAddresses)))
+		{
+			MSV_LOG_WARN(m_spLogger, "Not found hot DLL addresses are not warmed up.");
+		}
+
+		//pages of hot addresses are touched first
+		for (std::vector<void*>::const_iterator it = dllAddresses.begin(); it != dllAddresses.end(); ++it)
+		{
+			if (*it)
+			{
+				codeRanges.push_back(std::make_pair(reinterpret_cast<std::uintptr_t>(*it), std::size_t(1)));
+			}
+		}
+
+		if (!GetDllCodeRanges(codeRanges))
+		{
+			MSV_LOG_WARN(m_spLogger, "Code of DLL library can't be read on this platform - only hot DLL addresses are warmed up.");
+		}
+	}
+
+	std::size_t touchedPages = 0;
+	for (std::vector<std::pair<std::uintptr_t, std::size_t>>::const_iterator it = codeRanges.begin(); it != codeRanges.end(); ++it)
+	{
+		std::uintptr_t endAddress = it->first + it->second;
+		std::uintptr_t address = it->first & ~static_cast<std::uintptr_t>(pageSize - 1);
+		while (address < endAddress)
+		{
+			if (cancelled.load(std::memory_order_relaxed))
+			{
+				MSV_LOG_INFO(m_spLogger, "Warmup of DLL library has been cancelled ({} pages have been touched).", touchedPages);
+				return MSV_NOT_ALLOWED_ERROR;
+			}
+
+			//library can't be unloaded while chunk is touched (lock is released between chunks, so unload waits for one chunk only)
+			std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+			if (m_pHandle != pHandle)
+			{
+				MSV_LOG_INFO(m_spLogger, "DLL library has been unloaded during warmup ({} pages have been touched).", touchedPages);
+				return MSV_NOT_INITIALIZED_ERROR;
+			}
+
+			std::uintptr_t chunkEndAddress = std::min(endAddress, address + MSV_DLL_WARMUP_CHUNK_PAGES * pageSize);
+			for (; address < chunkEndAddress; address += pageSize, ++touchedPages)
+			{
+				//read one byte of page -> page is faulted in (it is mapped readable)
+				static_cast<void>(*reinterpret_cast<const volatile char*>(address));
+			}
+		}
+	}
+
+	MSV_LOG_INFO(m_spLogger, "DLL library has been successfully warmed up ({} pages have been touched).", touchedPages);
+
+	return MSV_SUCCESS;
+}
+
+void MsvDllAdapter::GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	prefaultedPages = m_prefaultedPages;
+	prefaultTime = m_prefaultTime;
+}
+
+MsvErrorCode MsvDllAdapter::ReadaheadDllLibrary(const char* dllPath) const
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+	int fileDescriptor = open(dllPath, O_RDONLY | O_CLOEXEC);
+	if (fileDescriptor < 0)
+	{
+		return MSV_OPEN_ERROR;
+	}
+
+	//only starts reads (whole file), pages stay in page cache after file is closed
+	int result = posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_WILLNEED);
+	close(fileDescriptor);
+
+	return result == 0 ? MSV_SUCCESS : MSV_NOT_ALLOWED_ERROR;
+#else
+	(void)dllPath;
+	return MSV_NOT_ALLOWED_ERROR;
+#endif // !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllAdapter public methods
+********************************************************************************************************************************/
+
+
+std::uint64_t MsvDllAdapter::GetAddressCacheHits() const
+{
+	return m_addressCacheHits.load(std::memory_order_relaxed);
+}
+
+std::uint64_t MsvDllAdapter::GetAddressCacheMisses() const
+{
+	return m_addressCacheMisses.load(std::memory_order_relaxed);
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllAdapter protected methods
+********************************************************************************************************************************/
+
+
+MsvErrorCode MsvDllAdapter::LoadDllAddress(const char* dllAddressName, void*& pdllAddress) const
+{
+#ifdef _WIN32
+	FARPROC farProc = GetProcAddress(m_pHandle, dllAddressName);
+	if (!farProc)
+	{
+		MSV_LOG_ERROR(m_spLogger, "GetProcAddress \"{}\" failed with error: {}", dllAddressName, GetLastError());
+		return MSV_NOT_FOUND_ERROR;
+	}
+#else
+	void* farProc = dlsym(m_pHandle, dllAddressName);
+	if (!farProc)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Load symbol \"{}\" failed with error: {}", dllAddressName, dlerror());
+		return MSV_NOT_FOUND_ERROR;
+	}
+#endif //_WIN32
+
+	pdllAddress = reinterpret_cast<void*>(farProc);
+
+	return MSV_SUCCESS;
+}
+
+std::size_t MsvDllAdapter::HashDllAddressName(const char* dllAddressName)
+{
+	//8 bytes per multiply (byte by byte hashing is latency bound - it would cost more than dynamic linker lookup of short names)
+	std::size_t length = std::strlen(dllAddressName);
+	std::uint64_t hash = 0xCBF29CE484222325ull ^ length;
+	for (; length >= sizeof(std::uint64_t); length -= sizeof(std::uint64_t), dllAddressName += sizeof(std::uint64_t))
+	{
+		std::uint64_t word = 0;
+		std::memcpy(&word, dllAddressName, sizeof(std::uint64_t));
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+		hash ^= hash >> 32;
+	}
+
+	std::uint64_t tail = 0;
+	std::memcpy(&tail, dllAddressName, length);
+	hash = (hash ^ tail) * 0x9E3779B97F4A7C15ull;
+	hash ^= hash >> 29;
+
+	return static_cast<std::size_t>(hash);
+}
+
+void* MsvDllAdapter::FindDllAddress(const char* dllAddressName, std::size_t hash) const
+{
+	if (m_addressCache.empty())
+	{
+		return nullptr;
+	}
+
+	std::size_t mask = m_addressCache.size() - 1;
+	for (std::size_t slot = hash & mask; m_addressCache[slot].m_pDllAddress; slot = (slot + 1) & mask)
+	{
+		const MsvDllAddressCacheEntry& entry = m_addressCache[slot];
+		if (entry.m_hash == hash && std::strcmp(&m_addressNames[entry.m_nameOffset], dllAddressName) == 0)
+		{
+			return entry.m_pDllAddress;
+		}
+	}
+
+	return nullptr;
+}
+
+void MsvDllAdapter::ReserveDllAddresses(std::size_t count)
+{
+	//cache is half full at most, so probe sequences stay short
+	std::size_t capacity = m_addressCache.empty() ? MSV_DLL_ADDRESS_CACHE_MIN_CAPACITY : m_addressCache.size();
+	while (count * 2 > capacity)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity == m_addressCache.size())
+	{
+		return;
+	}
+
+	std::vector<MsvDllAddressCacheEntry> addressCache(capacity);
+	std::size_t mask = capacity - 1;
+	for (const MsvDllAddressCacheEntry& entry: m_addressCache)
+	{
+		if (entry.m_pDllAddress)
+		{
+			std::size_t slot = entry.m_hash & mask;
+			while (addressCache[slot].m_pDllAddress)
+			{
+				slot = (slot + 1) & mask;
+			}
+
+			addressCache[slot] = entry;
+		}
+	}
+
+	m_addressCache.swap(addressCache);
+}
+
+bool MsvDllAdapter::GetDllCodeRanges(std::vector<std::pair<std::uintptr_t, std::size_t>>& codeRanges, bool readOnlyData) const
+{
+#ifdef _WIN32
+	//module handle is base address of mapped PE image
+	const char* pBaseAddress = reinterpret_cast<const char*>(m_pHandle);
+	const IMAGE_DOS_HEADER* pDosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(pBaseAddress);
+	const IMAGE_NT_HEADERS* pNtHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(pBaseAddress + pDosHeader->e_lfanew);
+	const IMAGE_SECTION_HEADER* pSection = IMAGE_FIRST_SECTION(pNtHeaders);
+	for (WORD index = 0; index < pNtHeaders->FileHeader.NumberOfSections; ++index, ++pSection)
+	{
+		if ((pSection->Characteristics & IMAGE_SCN_MEM_READ) && ((pSection->Characteristics & IMAGE_SCN_MEM_EXECUTE) || (readOnlyData && !(pSection->Characteristics & IMAGE_SCN_MEM_WRITE))))
+		{
+			codeRanges.push_back(std::make_pair(reinterpret_cast<std::uintptr_t>(pBaseAddress + pSection->VirtualAddress), static_cast<std::size_t>(pSection->Misc.VirtualSize)));
+		}
+	}
+
+	return true;
+#elif defined(MSV_DLL_LINK_MAP)
+	struct link_map* pLinkMap = nullptr;
+	if (dlinfo(m_pHandle, RTLD_DI_LINKMAP, &pLinkMap) != 0 || !pLinkMap)
+	{
+		return false;
+	}
+
+	//program headers are found by base address and name of library (writable segments are not read-only data)
+	struct MsvDllPhdrContext
+	{
+		const struct link_map* m_pLinkMap;
+		std::vector<std::pair<std::uintptr_t, std::size_t>>* m_pCodeRanges;
+		ElfW(Word) m_requiredFlags;
+		ElfW(Word) m_excludedFlags;
+	} context = { pLinkMap, &codeRanges, static_cast<ElfW(Word)>(readOnlyData ? PF_R : PF_R | PF_X), static_cast<ElfW(Word)>(readOnlyData ? PF_W : 0) };
+
+	return dl_iterate_phdr([](struct dl_phdr_info* pInfo, std::size_t, void* pData) -> int
+	{
+		const MsvDllPhdrContext* pContext = static_cast<const MsvDllPhdrContext*>(pData);
+		if (pInfo->dlpi_addr != pContext->m_pLinkMap->l_addr || !pInfo->dlpi_name || !pContext->m_pLinkMap->l_name || std::strcmp(pInfo->dlpi_name, pContext->m_pLinkMap->l_name) != 0)
+		{
+			return 0;
+		}
+
+		for (ElfW(Half) index = 0; index < pInfo->dlpi_phnum; ++index)
+		{
+			const ElfW(Phdr)& programHeader = pInfo->dlpi_phdr[index];
+			if (programHeader.p_type == PT_LOAD && (programHeader.p_flags & pContext->m_requiredFlags) == pContext->m_requiredFlags && !(programHeader.p_flags & pContext->m_excludedFlags))
+			{
+				pContext->m_pCodeRanges->push_back(std::make_pair(static_cast<std::uintptr_t>(pInfo->dlpi_addr + programHeader.p_vaddr), static_cast<std::size_t>(programHeader.p_memsz)));
+			}
+		}
+
+		//library has been found -> stop iteration
+		return 1;
+	}, &context) != 0;
+#else
+	(void)codeRanges;
+	return false;
+#endif // _WIN32
+}
+
+void MsvDllAdapter::PrefaultDllLibrary()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<std::pair<std::uintptr_t, std::size_t>> codeRanges;
+	if (!GetDllCodeRanges(codeRanges, true))
+	{
+		MSV_LOG_WARN(m_spLogger, "Segments of DLL library can't be read on this platform - it is not prefaulted.");
+		return;
+	}
+
+	std::size_t pageSize = GetPageSize();
+
+#ifdef MADV_WILLNEED
+	//whole segments are read by system at once (not page by page by faults below)
+	for (std::vector<std::pair<std::uintptr_t, std::size_t>>::const_iterator it = codeRanges.begin(); it != codeRanges.end(); ++it)
+	{
+		std::uintptr_t address = it->first & ~static_cast<std::uintptr_t>(pageSize - 1);
+		if (madvise(reinterpret_cast<void*>(address), it->first + it->second - address, MADV_WILLNEED) != 0)
+		{
+			MSV_LOG_WARN(m_spLogger, "Advise segment of DLL library failed with error: {}", errno);
+		}
+	}
+#endif // MADV_WILLNEED
+
+	std::uint64_t prefaultedPages = 0;
+	for (std::vector<std::pair<std::uintptr_t, std::size_t>>::const_iterator it = codeRanges.begin(); it != codeRanges.end(); ++it)
+	{
+		std::uintptr_t endAddress = it->first + it->second;
+		for (std::uintptr_t address = it->first & ~static_cast<std::uintptr_t>(pageSize - 1); address < endAddress; address += pageSize, ++prefaultedPages)
+		{
+			//read one byte of page -> page is faulted in (it is mapped readable)
+			static_cast<void>(*reinterpret_cast<const volatile char*>(address));
+		}
+	}
+
+	m_prefaultedPages = prefaultedPages;
+	m_prefaultTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	MSV_LOG_INFO(m_spLogger, "DLL library has been prefaulted ({} pages in {} us).", m_prefaultedPages, m_prefaultTime.count());
+}
+
+void MsvDllAdapter::RemapDllLibraryHugePages()
+{
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE) && defined(MREMAP_FIXED)
+	std::size_t hugePageSize = GetHugePageSize();
+	if (hugePageSize == 0)
+	{
+		MSV_LOG_WARN(m_spLogger, "Transparent huge pages are not available - DLL library is kept on normal pages.");
+		return;
+	}
+
+	std::vector<std::pair<std::uintptr_t, std::size_t>> codeRanges;
+	if (!GetDllCodeRanges(codeRanges))
+	{
+		MSV_LOG_WARN(m_spLogger, "Code of DLL library can't be read on this platform - it is kept on normal pages.");
+		return;
+	}
+
+	std::size_t remappedSize = 0;
+	for (std::vector<std::pair<std::uintptr_t, std::size_t>>::const_iterator it = codeRanges.begin(); it != codeRanges.end(); ++it)
+	{
+		//only whole huge pages are remapped (head and tail of segment stay on normal pages)
+		std::uintptr_t address = (it->first + hugePageSize - 1) & ~static_cast<std::uintptr_t>(hugePageSize - 1);
+		std::uintptr_t endAddress = (it->first + it->second) & ~static_cast<std::uintptr_t>(hugePageSize - 1);
+		if (address >= endAddress)
+		{
+			continue;
+		}
+
+		std::size_t size = endAddress - address;
+
+		//anonymous copy must be huge page aligned too (one more huge page is mapped to align it)
+		void* pMemory = mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pMemory == MAP_FAILED)
+		{
+			MSV_LOG_WARN(m_spLogger, "Map memory for huge pages failed with error: {}", errno);
+			break;
+		}
+
+		std::uintptr_t memoryAddress = reinterpret_cast<std::uintptr_t>(pMemory);
+		std::uintptr_t copyAddress = (memoryAddress + hugePageSize - 1) & ~static_cast<std::uintptr_t>(hugePageSize - 1);
+		if (copyAddress > memoryAddress)
+		{
+			munmap(pMemory, copyAddress - memoryAddress);
+		}
+		munmap(reinterpret_cast<void*>(copyAddress + size), memoryAddress + hugePageSize - copyAddress);
+
+		void* pCopy = reinterpret_cast<void*>(copyAddress);
+		if (madvise(pCopy, size, MADV_HUGEPAGE) != 0)
+		{
+			MSV_LOG_WARN(m_spLogger, "Advise huge pages failed with error: {}", errno);
+			munmap(pCopy, size);
+			break;
+		}
+
+		//copy is moved over original mapping at once (original code is kept when it fails)
+		std::memcpy(pCopy, reinterpret_cast<const void*>(address), size);
+		if (mprotect(pCopy, size, PROT_READ | PROT_EXEC) != 0 || mremap(pCopy, size, size, MREMAP_MAYMOVE | MREMAP_FIXED, reinterpret_cast<void*>(address)) == MAP_FAILED)
+		{
+			MSV_LOG_WARN(m_spLogger, "Remap code of DLL library onto huge pages failed with error: {}", errno);
+			munmap(pCopy, size);
+			break;
+		}
+
+		remappedSize += size;
+	}
+
+	MSV_LOG_INFO(m_spLogger, "{} bytes of code of DLL library have been remapped onto huge pages.", remappedSize);
+#else
+	MSV_LOG_WARN(m_spLogger, "Transparent huge pages are not supported on this platform - DLL library is kept on normal pages.");
+#endif // !defined(_WIN32) && defined(MADV_HUGEPAGE) && defined(MREMAP_FIXED)
+}
+
+std::size_t MsvDllAdapter::GetHugePageSize()
+{
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+	//huge pages can be used by madvise when they are enabled "always" or "madvise" (current mode is in brackets)
+	std::ifstream enabledFile("/sys/kernel/mm/transparent_hugepage/enabled");
+	std::string enabled;
+	if (!std::getline(enabledFile, enabled) || enabled.find("[never]") != std::string::npos)
+	{
+		return 0;
+	}
+
+	std::ifstream sizeFile("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+	std::size_t hugePageSize = 0;
+	if (!(sizeFile >> hugePageSize) || hugePageSize == 0 || (hugePageSize & (hugePageSize - 1)) != 0)
+	{
+		hugePageSize = MSV_DLL_HUGE_PAGE_SIZE;
+	}
+
+	return hugePageSize;
+#else
+	return 0;
+#endif // !defined(_WIN32) && defined(MADV_HUGEPAGE)
+}
+
+std::size_t MsvDllAdapter::GetPageSize()
+{
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return static_cast<std::size_t>(systemInfo.dwPageSize);
+#else
+	long pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize > 0 ? static_cast<std::size_t>(pageSize) : 4096;
+#endif // _WIN32
+}
+
+void MsvDllAdapter::CacheDllAddress(const char* dllAddressName, std::size_t hash, void* pDllAddress)
+{
+	ReserveDllAddresses(m_addressCacheCount + 1);
+
+	std::size_t mask = m_addressCache.size() - 1;
+	std::size_t slot = hash & mask;
+	while (m_addressCache[slot].m_pDllAddress)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	MsvDllAddressCacheEntry& entry = m_addressCache[slot];
+	entry.m_hash = hash;
+	entry.m_pDllAddress = pDllAddress;
+	entry.m_nameOffset = m_addressNames.size();
+	m_addressNames.insert(m_addressNames.end(), dllAddressName, dllAddressName + std::strlen(dllAddressName) + 1);
+	++m_addressCacheCount;
+}
+
+
+
+
+/********************************************************************************************************************************
+*															MsvDllAdapter::MsvDllSymbolTable public methods
+********************************************************************************************************************************/
+
+
+bool MsvDllAdapter::MsvDllSymbolTable::Initialize(void* pHandle)
+{
+#ifdef MSV_DLL_GNU_HASH
+	struct link_map* pLinkMap = nullptr;
+	if (dlinfo(pHandle, RTLD_DI_LINKMAP, &pLinkMap) != 0 || !pLinkMap || !pLinkMap->l_ld)
+	{
+		return false;
+	}
+
+	m_baseAddress = static_cast<std::uintptr_t>(pLinkMap->l_addr);
+	for (const ElfW(Dyn)* pDynamic = pLinkMap->l_ld; pDynamic->d_tag != DT_NULL; ++pDynamic)
+	{
+		//dynamic linker relocates dynamic section in place on most platforms (read only ones keep unrelocated values)
+		std::uintptr_t address = static_cast<std::uintptr_t>(pDynamic->d_un.d_ptr);
+		if (address < m_baseAddress)
+		{
+			address += m_baseAddress;
+		}
+
+		switch (pDynamic->d_tag)
+		{
+		case DT_GNU_HASH:
+			m_pGnuHash = reinterpret_cast<const std::uint32_t*>(address);
+			break;
+		case DT_SYMTAB:
+			m_pSymbols = reinterpret_cast<const void*>(address);
+			break;
+		case DT_STRTAB:
+			m_pStrings = reinterpret_cast<const char*>(address);
+			break;
+		case DT_VERSYM:
+			m_pVersions = reinterpret_cast<const std::uint16_t*>(address);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return m_pGnuHash && m_pSymbols && m_pStrings && m_pGnuHash[0] != 0;
+#else
+	(void)pHandle;
+	return false;
+#endif // MSV_DLL_GNU_HASH
+}
+
+void* MsvDllAdapter::MsvDllSymbolTable::Find(const char* dllAddressName) const
+{
+#ifdef MSV_DLL_GNU_HASH
+	//GNU hash table: bucket count, symbol offset, bloom filter size, bloom shift, bloom filter, buckets, hash chains
+	std::uint32_t bucketCount = m_pGnuHash[0];
+	std::uint32_t symbolOffset = m_pGnuHash[1];
+	std::uint32_t bloomSize = m_pGnuHash[2];
+	std::uint32_t bloomShift = m_pGnuHash[3];
+	const ElfW(Addr)* pBloom = reinterpret_cast<const ElfW(Addr)*>(m_pGnuHash + 4);
+	const std::uint32_t* pBuckets = reinterpret_cast<const std::uint32_t*>(pBloom + bloomSize);
+	const std::uint32_t* pChains = pBuckets + bucketCount;
+	const ElfW(Sym)* pSymbols = static_cast<const ElfW(Sym)*>(m_pSymbols);
+
+	std::uint32_t hash = 5381;
+	for (const char* pChar = dllAddressName; *pChar; ++pChar)
+	{
+		hash = hash * 33 + static_cast<unsigned char>(*pChar);
+	}
+
+	//bloom filter rejects most of symbols which are not defined by library
+	const std::uint32_t bloomBits = sizeof(ElfW(Addr)) * 8;
+	ElfW(Addr) bloomWord = pBloom[(hash / bloomBits) & (bloomSize - 1)];
+	ElfW(Addr) bloomMask = (static_cast<ElfW(Addr)>(1) << (hash % bloomBits)) | (static_cast<ElfW(Addr)>(1) << ((hash >> bloomShift) % bloomBits));
+	if ((bloomWord & bloomMask) != bloomMask)
+	{
+		return nullptr;
+	}
+
+	std::uint32_t index = pBuckets[hash % bucketCount];
+	if (index < symbolOffset)
+	{
+		return nullptr;
+	}
+
+	for (;; ++index)
+	{
+		std::uint32_t chainHash = pChains[index - symbolOffset];
+		if ((chainHash | 1) == (hash | 1) && std::strcmp(dllAddressName, m_pStrings + pSymbols[index].st_name) == 0)
+		{
+			const ElfW(Sym)& symbol = pSymbols[index];
+			unsigned char symbolType = ELF64_ST_TYPE(symbol.st_info);	//same for ELF32 and ELF64
+
+			//hidden (not default) version -> other version might be default one
+			if (!m_pVersions || !(m_pVersions[index] & 0x8000))
+			{
+				if (symbol.st_shndx == SHN_UNDEF || (symbolType != STT_FUNC && symbolType != STT_OBJECT && symbolType != STT_NOTYPE))
+				{
+					//defined by dependency, indirect function, TLS, etc. -> it must be resolved by system
+					return nullptr;
+				}
+
+				return reinterpret_cast<void*>(m_baseAddress + static_cast<std::uintptr_t>(symbol.st_value));
+			}
+		}
+
+		//last symbol of hash chain
+		if (chainHash & 1)
+		{
+			return nullptr;
+		}
+	}
+#else
+	(void)dllAddressName;
+	return nullptr;
+#endif // MSV_DLL_GNU_HASH
+}
+
 
 /** @} */	//End of group MDLLFACTORY.
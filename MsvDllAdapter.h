@@ -47,11 +47,42 @@ MSV_DISABLE_ALL_WARNINGS
 #include <dlfcn.h>
 #endif //_WIN32
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 MSV_ENABLE_WARNINGS
 
 
+/**************************************************************************************************//**
+* @def			MSV_DLL_ADDRESS_CACHE_MIN_CAPACITY
+* @brief			Minimal capacity of DLL address cache.
+* @details		Count of slots of DLL address cache allocated by first cached address (it is doubled
+*					when it is half full).
+******************************************************************************************************/
+#define MSV_DLL_ADDRESS_CACHE_MIN_CAPACITY 16
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_WARMUP_CHUNK_PAGES
+* @brief			Page count of warmup chunk.
+* @details		Count of code pages touched by warmup at once (lock of adapter is held and cancel flag
+*					is not checked during chunk).
+******************************************************************************************************/
+#define MSV_DLL_WARMUP_CHUNK_PAGES 64
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_HUGE_PAGE_SIZE
+* @brief			Default size of huge page.
+* @details		Size of transparent huge page used when system does not report it.
+******************************************************************************************************/
+#define MSV_DLL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+
 /**************************************************************************************************//**
 * @brief		MarsTech DLL Adapter Implementation.
 * @details	Implementation for MarsTech dynamic/shared library adapter. Wraps real (system) implementation
@@ -94,21 +125,255 @@ public:
 	******************************************************************************************************/
 	virtual MsvErrorCode GetDllAddress(const char* dllAddressName, void*& pdllAddress) override;
 
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllAdapter::GetDllAddresses(const std::vector<const char*>& dllAddressNames, std::vector<void*>& dllAddresses)
+	* @note			On Linux (glibc), addresses are looked up in GNU hash table of library itself (no dynamic
+	*					linker call), other ones (defined by dependencies, indirect functions, TLS) are resolved
+	*					by system.
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllAddresses(const std::vector<const char*>& dllAddressNames, std::vector<void*>& dllAddresses) override;
+
 	/**************************************************************************************************//**
 	* @copydoc IMsvDllAdapter::Loaded() const
 	******************************************************************************************************/
 	virtual bool Loaded() const override;
 
 	/**************************************************************************************************//**
-	* @copydoc IMsvDllAdapter::LoadDllLibrary(const char* dllPath)
+	* @copydoc IMsvDllAdapter::LoadDllLibrary(const char* dllPath, MsvDllLoadOptions loadOptions)
 	******************************************************************************************************/
-	virtual MsvErrorCode LoadDllLibrary(const char* dllPath) override;
+	virtual MsvErrorCode LoadDllLibrary(const char* dllPath, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT) override;
 
 	/**************************************************************************************************//**
 	* @copydoc IMsvDllAdapter::UnloadDllLibrary()
 	******************************************************************************************************/
 	virtual MsvErrorCode UnloadDllLibrary() override;
 
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllAdapter::DetachDllLibrary()
+	******************************************************************************************************/
+	virtual MsvErrorCode DetachDllLibrary() override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllAdapter::WarmupDllLibrary(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled)
+	* @note			Pages of hot addresses are touched first, then all executable segments (sections on
+	*					Windows) of library.
+	******************************************************************************************************/
+	virtual MsvErrorCode WarmupDllLibrary(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllAdapter::GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const
+	******************************************************************************************************/
+	virtual void GetDllPrefault(std::uint64_t& prefaultedPages, std::chrono::microseconds& prefaultTime) const override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllAdapter::ReadaheadDllLibrary(const char* dllPath) const
+	* @note			Readahead is supported on POSIX systems only (posix_fadvise).
+	******************************************************************************************************/
+	virtual MsvErrorCode ReadaheadDllLibrary(const char* dllPath) const override;
+
+	/**************************************************************************************************//**
+	* @brief			Get cache hits.
+	* @details		Returns count of DLL addresses which have been found in DLL address cache.
+	* @returns		std::uint64_t		Count of cache hits.
+	******************************************************************************************************/
+	std::uint64_t GetAddressCacheHits() const;
+
+	/**************************************************************************************************//**
+	* @brief			Get cache misses.
+	* @details		Returns count of DLL addresses which have been resolved from library.
+	* @returns		std::uint64_t		Count of cache misses.
+	******************************************************************************************************/
+	std::uint64_t GetAddressCacheMisses() const;
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Address Cache Entry.
+	* @details	Cached DLL address (slot of open addressing hash table).
+	******************************************************************************************************/
+	class MsvDllAddressCacheEntry
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @details		Creates empty slot.
+		******************************************************************************************************/
+		MsvDllAddressCacheEntry();
+
+		/**************************************************************************************************//**
+		* @brief		Hash.
+		* @details	Hash of DLL address name.
+		******************************************************************************************************/
+		std::size_t m_hash;
+
+		/**************************************************************************************************//**
+		* @brief		DLL address.
+		* @details	Resolved DLL address (nullptr in empty slot).
+		******************************************************************************************************/
+		void* m_pDllAddress;
+
+		/**************************************************************************************************//**
+		* @brief		DLL address name.
+		* @details	Offset of DLL address name in @ref m_addressNames.
+		******************************************************************************************************/
+		std::size_t m_nameOffset;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Symbol Table.
+	* @details	Dynamic symbol table of loaded library (ELF .gnu.hash, .dynsym, .dynstr and versions) -
+	*				it looks up symbols defined by library itself without dynamic linker. It is available on
+	*				Linux (glibc) only.
+	******************************************************************************************************/
+	class MsvDllSymbolTable
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @details		Creates empty symbol table.
+		******************************************************************************************************/
+		MsvDllSymbolTable();
+
+		/**************************************************************************************************//**
+		* @brief			Initialize symbol table.
+		* @details		Reads dynamic section of loaded library.
+		* @param[in]	pHandle			System handle of loaded library.
+		* @retval		true				When library has GNU hash table.
+		* @retval		false				When symbol table is not available (symbols must be resolved by system).
+		******************************************************************************************************/
+		bool Initialize(void* pHandle);
+
+		/**************************************************************************************************//**
+		* @brief			Find symbol.
+		* @details		Looks up default version of symbol defined by library.
+		* @param[in]	dllAddressName	DLL address (symbol) name.
+		* @returns		void*				Symbol address (nullptr when it is not defined by library or when it must be
+		*										resolved by system - indirect functions, TLS).
+		******************************************************************************************************/
+		void* Find(const char* dllAddressName) const;
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		Base address.
+		* @details	Load bias of library (difference between symbol values and theirs addresses).
+		******************************************************************************************************/
+		std::uintptr_t m_baseAddress;
+
+		/**************************************************************************************************//**
+		* @brief		GNU hash table.
+		* @details	Pointer to .gnu.hash section.
+		******************************************************************************************************/
+		const std::uint32_t* m_pGnuHash;
+
+		/**************************************************************************************************//**
+		* @brief		Symbols.
+		* @details	Pointer to .dynsym section.
+		******************************************************************************************************/
+		const void* m_pSymbols;
+
+		/**************************************************************************************************//**
+		* @brief		Strings.
+		* @details	Pointer to .dynstr section.
+		******************************************************************************************************/
+		const char* m_pStrings;
+
+		/**************************************************************************************************//**
+		* @brief		Symbol versions.
+		* @details	Pointer to .gnu.version section (nullptr when library does not use symbol versioning).
+		******************************************************************************************************/
+		const std::uint16_t* m_pVersions;
+	};
+
+	/**************************************************************************************************//**
+	* @brief			Load DLL address.
+	* @details		Resolves DLL address by system (dynamic linker) and logs failure.
+	* @param[in]	dllAddressName		DLL address name.
+	* @param[out]	pdllAddress			Pointer to loaded address.
+	* @retval		MSV_NOT_FOUND_ERROR	When DLL address was not found.
+	* @retval		MSV_SUCCESS				On success.
+	* @warning		Must be called with locked @ref m_lock and loaded library.
+	******************************************************************************************************/
+	MsvErrorCode LoadDllAddress(const char* dllAddressName, void*& pdllAddress) const;
+
+	/**************************************************************************************************//**
+	* @brief			Hash DLL address name.
+	* @details		Multiplicative hash of DLL address name (it hashes 8 chars at once).
+	* @param[in]	dllAddressName		DLL address name.
+	* @returns		std::size_t			Hash of DLL address name.
+	******************************************************************************************************/
+	static std::size_t HashDllAddressName(const char* dllAddressName);
+
+	/**************************************************************************************************//**
+	* @brief			Find cached DLL address.
+	* @param[in]	dllAddressName		DLL address name.
+	* @param[in]	hash					Hash of DLL address name.
+	* @returns		void*					Cached DLL address (nullptr when it is not cached).
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	void* FindDllAddress(const char* dllAddressName, std::size_t hash) const;
+
+	/**************************************************************************************************//**
+	* @brief			Reserve DLL address cache.
+	* @details		Grows cache (rehashes cached addresses), so count of addresses can be cached without next
+	*					growth.
+	* @param[in]	count					Count of cached addresses.
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	void ReserveDllAddresses(std::size_t count);
+
+	/**************************************************************************************************//**
+	* @brief			Cache DLL address.
+	* @details		Inserts DLL address to cache (cache is grown when it is half full).
+	* @param[in]	dllAddressName		DLL address name.
+	* @param[in]	hash					Hash of DLL address name.
+	* @param[in]	pDllAddress			Resolved DLL address.
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	void CacheDllAddress(const char* dllAddressName, std::size_t hash, void* pDllAddress);
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL code ranges.
+	* @details		Returns address ranges of executable and readable segments (sections on Windows) of
+	*					loaded library.
+	* @param[out]	codeRanges			Code ranges (start address and size).
+	* @param[in]	readOnlyData		Flag if readable and not writable data segments should be returned too (true) or not (false).
+	* @retval		true					When code ranges have been read.
+	* @retval		false					When code ranges are not available on this platform.
+	* @warning		Must be called with locked @ref m_lock and loaded library.
+	******************************************************************************************************/
+	bool GetDllCodeRanges(std::vector<std::pair<std::uintptr_t, std::size_t>>& codeRanges, bool readOnlyData = false) const;
+
+	/**************************************************************************************************//**
+	* @brief			Prefault DLL library.
+	* @details		Asks system to read code and read-only data of loaded library (MADV_WILLNEED on Linux)
+	*					and touches all theirs pages, so they are mapped before first request. Count of
+	*					prefaulted pages and time of prefault are stored (see @ref GetDllPrefault).
+	* @warning		Must be called with locked @ref m_lock and loaded library.
+	******************************************************************************************************/
+	void PrefaultDllLibrary();
+
+	/**************************************************************************************************//**
+	* @brief			Remap DLL library onto huge pages.
+	* @details		Copies huge page aligned parts of code segments of loaded library to anonymous memory
+	*					backed by transparent huge pages and moves it over original mapping (code keeps its
+	*					addresses). Library is kept on normal pages when transparent huge pages are not
+	*					available (or when any step fails).
+	* @warning		Must be called with locked @ref m_lock and loaded library (its code must not run
+	*					meanwhile).
+	******************************************************************************************************/
+	void RemapDllLibraryHugePages();
+
+	/**************************************************************************************************//**
+	* @brief			Get huge page size.
+	* @returns		std::size_t			Size of transparent huge page (0 when they are not available).
+	******************************************************************************************************/
+	static std::size_t GetHugePageSize();
+
+	/**************************************************************************************************//**
+	* @brief			Get page size.
+	* @returns		std::size_t			Size of memory page.
+	******************************************************************************************************/
+	static std::size_t GetPageSize();
+
 protected:
 	/**************************************************************************************************//**
 	* @brief		Thread pool mutex.
@@ -130,6 +395,50 @@ protected:
 	void* m_pHandle;
 #endif //_WIN32
 
+	/**************************************************************************************************//**
+	* @brief		DLL address cache.
+	* @details	Open addressing hash table (power of two slots, linear probing) of DLL addresses
+	*				resolved from loaded library. It is cleared when library is unloaded.
+	******************************************************************************************************/
+	std::vector<MsvDllAddressCacheEntry> m_addressCache;
+
+	/**************************************************************************************************//**
+	* @brief		DLL address names.
+	* @details	Pool of null terminated names of cached DLL addresses (entries of @ref m_addressCache
+	*				refer to it by offset, so they are trivially copyable and they do not allocate).
+	******************************************************************************************************/
+	std::vector<char> m_addressNames;
+
+	/**************************************************************************************************//**
+	* @brief		Cached DLL addresses count.
+	* @details	Count of used slots of @ref m_addressCache.
+	******************************************************************************************************/
+	std::size_t m_addressCacheCount;
+
+	/**************************************************************************************************//**
+	* @brief		Cache hits.
+	* @details	Count of DLL addresses found in @ref m_addressCache.
+	******************************************************************************************************/
+	std::atomic<std::uint64_t> m_addressCacheHits;
+
+	/**************************************************************************************************//**
+	* @brief		Cache misses.
+	* @details	Count of DLL addresses resolved by system.
+	******************************************************************************************************/
+	std::atomic<std::uint64_t> m_addressCacheMisses;
+
+	/**************************************************************************************************//**
+	* @brief		Prefaulted pages.
+	* @details	Count of pages prefaulted by load of library (see @ref PrefaultDllLibrary).
+	******************************************************************************************************/
+	std::uint64_t m_prefaultedPages;
+
+	/**************************************************************************************************//**
+	* @brief		Prefault time.
+	* @details	Time of prefault of library (see @ref PrefaultDllLibrary).
+	******************************************************************************************************/
+	std::chrono::microseconds m_prefaultTime;
+
 	/**************************************************************************************************//**
 	* @brief		Logger.
 	* @details	Shared pointer to logger for logging.
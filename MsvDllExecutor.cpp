@@ -0,0 +1,306 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Executor
+* @details		Contains implementation of @ref MsvDllExecutor.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "MsvDllExecutor.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // _WIN32
+
+MSV_ENABLE_WARNINGS
+
+
+/********************************************************************************************************************************
+*															Static members
+********************************************************************************************************************************/
+
+
+thread_local bool MsvDllExecutor::s_threadDetached = false;
+
+
+/********************************************************************************************************************************
+*															Constructors and destructors
+********************************************************************************************************************************/
+
+
+MsvDllExecutor::MsvDllExecutor(std::uint32_t maxThreadCount, bool lowPriority):
+	m_idleCount(0),
+	m_maxThreadCount(maxThreadCount > 0 ? maxThreadCount : 1),
+	m_lowPriority(lowPriority),
+	m_stopped(false)
+{
+
+}
+
+MsvDllExecutor::~MsvDllExecutor()
+{
+	Stop();
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllExecutor public methods
+********************************************************************************************************************************/
+
+
+MsvErrorCode MsvDllExecutor::Execute(const std::function<void()>& task)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_stopped)
+	{
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	m_tasks.push_back(task);
+
+	//all workers are busy -> start new one (when maximal count has not been reached)
+	if (m_idleCount < m_tasks.size() && m_workers.size() < m_maxThreadCount)
+	{
+		m_workers.reserve(m_maxThreadCount);
+
+		try
+		{
+			m_workers.emplace_back(&MsvDllExecutor::RunWorker, this);
+		}
+		catch (const std::system_error&)
+		{
+			//system is out of threads - task is run by started workers later (it can't be run without any)
+			if (m_workers.empty())
+			{
+				m_tasks.pop_back();
+				return MSV_ALLOCATION_ERROR;
+			}
+		}
+	}
+
+	m_taskCondition.notify_one();
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllExecutor::ExecuteAt(std::chrono::steady_clock::time_point time, const std::function<void()>& task)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_stopped)
+	{
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>::iterator it = m_timedTasks.insert(std::make_pair(time, task));
+
+	if (!m_timer.joinable())
+	{
+		try
+		{
+			m_timer = std::thread(&MsvDllExecutor::RunTimer, this);
+		}
+		catch (const std::system_error&)
+		{
+			//system is out of threads - timed task can't be run
+			m_timedTasks.erase(it);
+			return MSV_ALLOCATION_ERROR;
+		}
+	}
+
+	m_timerCondition.notify_one();
+
+	return MSV_SUCCESS;
+}
+
+void MsvDllExecutor::Stop()
+{
+	std::vector<std::thread> workers;
+	std::thread timer;
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		m_stopped = true;
+		workers.swap(m_workers);
+		timer.swap(m_timer);
+	}
+
+	m_taskCondition.notify_all();
+	m_timerCondition.notify_all();
+
+	//thread can't join itself (task has destroyed owner of executor) -> it is detached
+	std::thread::id currentThreadId = std::this_thread::get_id();
+	for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+	{
+		if (it->get_id() == currentThreadId)
+		{
+			s_threadDetached = true;
+			it->detach();
+		}
+		else
+		{
+			it->join();
+		}
+	}
+
+	if (timer.get_id() == currentThreadId)
+	{
+		s_threadDetached = true;
+		timer.detach();
+	}
+	else if (timer.joinable())
+	{
+		timer.join();
+	}
+
+	//tasks are destroyed outside of lock (theirs captures might destroy owner of executor)
+	std::deque<std::function<void()>> tasks;
+	std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> timedTasks;
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		tasks.swap(m_tasks);
+		timedTasks.swap(m_timedTasks);
+	}
+
+	//queued tasks are left only when detached thread was the last worker
+	for (std::deque<std::function<void()>>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+	{
+		(*it)();
+	}
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllExecutor protected methods
+********************************************************************************************************************************/
+
+
+void MsvDllExecutor::RunWorker()
+{
+	if (m_lowPriority)
+	{
+		LowerThreadPriority();
+	}
+
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	for (;;)
+	{
+		++m_idleCount;
+		m_taskCondition.wait(lock, [this]() { return m_stopped || !m_tasks.empty(); });
+		--m_idleCount;
+
+		if (m_tasks.empty())
+		{
+			//stopped and all tasks have been run
+			return;
+		}
+
+		std::function<void()> task;
+		task.swap(m_tasks.front());
+		m_tasks.pop_front();
+
+		//run and destroy task outside of lock (it might be slow, schedule other tasks or destroy executor)
+		lock.unlock();
+		task();
+		task = nullptr;
+
+		if (s_threadDetached)
+		{
+			//executor might be destroyed
+			return;
+		}
+
+		lock.lock();
+	}
+}
+
+void MsvDllExecutor::RunTimer()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	while (!m_stopped)
+	{
+		if (m_timedTasks.empty())
+		{
+			m_timerCondition.wait(lock);
+			continue;
+		}
+
+		std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>::iterator it = m_timedTasks.begin();
+		if (it->first > std::chrono::steady_clock::now())
+		{
+			//wait for the first timed task (or for earlier timed task)
+			m_timerCondition.wait_until(lock, it->first);
+			continue;
+		}
+
+		std::function<void()> task;
+		task.swap(it->second);
+		m_timedTasks.erase(it);
+
+		lock.unlock();
+		task();
+		task = nullptr;
+
+		if (s_threadDetached)
+		{
+			//executor might be destroyed
+			return;
+		}
+
+		lock.lock();
+	}
+}
+
+void MsvDllExecutor::LowerThreadPriority()
+{
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+	//nice value is per thread on Linux (idle scheduling class is not used - it would starve thread holding locks on busy machine)
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#else
+	//nice value is per process on other systems -> priority of thread is not changed
+#endif // _WIN32
+}
+
+
+/** @} */	//End of group MDLLFACTORY.
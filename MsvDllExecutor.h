@@ -0,0 +1,229 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Executor
+* @details		Contains definition of @ref MsvDllExecutor.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLEXECUTOR_H
+#define MARSTECH_DLLEXECUTOR_H
+
+
+#include "merror/MsvErrorCodes.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Executor.
+* @details	Bounded pool of threads which run tasks (DLL loads) in background. Worker threads are
+*				started on demand (up to maximal count) and they run until executor is stopped. Timed
+*				tasks (deadlines) are run by one timer thread, so they are run in time even when all
+*				worker threads are blocked by slow loads.
+* @note		Tasks are run outside of executor lock - they might schedule other tasks.
+* @note		Task (or its captures) might destroy owner of executor (e.g. last reference to DLL factory is
+*				released by callback) - thread of task is detached by @ref Stop and it does not touch executor
+*				anymore.
+******************************************************************************************************/
+class MsvDllExecutor
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @param[in]	maxThreadCount		Maximal count of worker threads.
+	* @param[in]	lowPriority			Flag if worker threads run with low priority (true) or with normal priority (false).
+	******************************************************************************************************/
+	MsvDllExecutor(std::uint32_t maxThreadCount, bool lowPriority = false);
+
+	/**************************************************************************************************//**
+	* @brief			Virtual destructor.
+	* @details		Stops executor.
+	* @see			Stop
+	******************************************************************************************************/
+	virtual ~MsvDllExecutor();
+
+	/**************************************************************************************************//**
+	* @brief			Deleted copy constructor.
+	* @details		Copy constructor deleted -> copying is not allowed.
+	* @param[in]	origin			Reference to copyied object.
+	* @warning		Do not copy this object.
+	******************************************************************************************************/
+	MsvDllExecutor(const MsvDllExecutor& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Deleted assign operator.
+	* @details		Assign operator deleted -> assign is not allowed.
+	* @param[in]	origin			Reference to assigned object.
+	* @warning		Do not assign this object.
+	******************************************************************************************************/
+	MsvDllExecutor& operator= (const MsvDllExecutor& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Execute task.
+	* @details		Queues task - it is run by first free worker thread (new worker thread is started when
+	*					all are busy and maximal count has not been reached).
+	* @param[in]	task								Task to run.
+	* @retval		MSV_ALLOCATION_ERROR			When no worker thread is running and new one can't be started.
+	* @retval		MSV_NOT_ALLOWED_ERROR		When executor has been stopped.
+	* @retval		MSV_SUCCESS						On success.
+	* @note			Task is queued when new worker thread can't be started, but other ones are running.
+	******************************************************************************************************/
+	MsvErrorCode Execute(const std::function<void()>& task);
+
+	/**************************************************************************************************//**
+	* @brief			Execute task at time.
+	* @details		Task is run by timer thread at requested time (it must be short - it delays other timed
+	*					tasks).
+	* @param[in]	time								Time when task is run.
+	* @param[in]	task								Task to run.
+	* @retval		MSV_ALLOCATION_ERROR			When timer thread can't be started.
+	* @retval		MSV_NOT_ALLOWED_ERROR		When executor has been stopped.
+	* @retval		MSV_SUCCESS						On success.
+	******************************************************************************************************/
+	MsvErrorCode ExecuteAt(std::chrono::steady_clock::time_point time, const std::function<void()>& task);
+
+	/**************************************************************************************************//**
+	* @brief			Stop executor.
+	* @details		Runs all queued tasks, drops timed tasks which have not been run yet and waits for all
+	*					threads. When it is called from task (executor is destroyed by its own thread), thread of
+	*					task is detached instead of joined (it ends when task returns) and queued tasks which
+	*					are left are run by calling thread.
+	******************************************************************************************************/
+	void Stop();
+
+protected:
+	/**************************************************************************************************//**
+	* @brief			Worker thread.
+	* @details		Runs queued tasks until executor is stopped and queue is empty.
+	******************************************************************************************************/
+	void RunWorker();
+
+	/**************************************************************************************************//**
+	* @brief			Timer thread.
+	* @details		Runs timed tasks in time until executor is stopped.
+	******************************************************************************************************/
+	void RunTimer();
+
+	/**************************************************************************************************//**
+	* @brief			Lower thread priority.
+	* @details		Lowers priority of calling thread (it gets CPU time when other threads do not need it).
+	******************************************************************************************************/
+	static void LowerThreadPriority();
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Executor lock.
+	* @details	Locks tasks and threads.
+	******************************************************************************************************/
+	std::mutex m_lock;
+
+	/**************************************************************************************************//**
+	* @brief		Task condition.
+	* @details	Wakes up worker threads (new task or stop).
+	******************************************************************************************************/
+	std::condition_variable m_taskCondition;
+
+	/**************************************************************************************************//**
+	* @brief		Timer condition.
+	* @details	Wakes up timer thread (new timed task or stop).
+	******************************************************************************************************/
+	std::condition_variable m_timerCondition;
+
+	/**************************************************************************************************//**
+	* @brief		Tasks.
+	* @details	Queued tasks (FIFO).
+	******************************************************************************************************/
+	std::deque<std::function<void()>> m_tasks;
+
+	/**************************************************************************************************//**
+	* @brief		Timed tasks.
+	* @details	Timed tasks sorted by time.
+	******************************************************************************************************/
+	std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> m_timedTasks;
+
+	/**************************************************************************************************//**
+	* @brief		Worker threads.
+	* @details	Started worker threads.
+	******************************************************************************************************/
+	std::vector<std::thread> m_workers;
+
+	/**************************************************************************************************//**
+	* @brief		Timer thread.
+	* @details	Timer thread (it is started with first timed task).
+	******************************************************************************************************/
+	std::thread m_timer;
+
+	/**************************************************************************************************//**
+	* @brief		Idle worker count.
+	* @details	Count of worker threads which are waiting for task.
+	******************************************************************************************************/
+	std::uint32_t m_idleCount;
+
+	/**************************************************************************************************//**
+	* @brief		Maximal thread count.
+	* @details	Maximal count of worker threads.
+	******************************************************************************************************/
+	std::uint32_t m_maxThreadCount;
+
+	/**************************************************************************************************//**
+	* @brief		Low priority flag.
+	* @details	Flag if worker threads run with low priority (true) or with normal priority (false).
+	******************************************************************************************************/
+	const bool m_lowPriority;
+
+	/**************************************************************************************************//**
+	* @brief		Stopped flag.
+	* @details	Flag if executor has been stopped (true) or not (false).
+	******************************************************************************************************/
+	bool m_stopped;
+
+	/**************************************************************************************************//**
+	* @brief		Thread detached flag.
+	* @details	Flag if executor thread has been detached by @ref Stop (true) or not (false) - its executor
+	*				might be destroyed, so thread returns right after its task.
+	******************************************************************************************************/
+	static thread_local bool s_threadDetached;
+};
+
+
+#endif // MARSTECH_DLLEXECUTOR_H
+
+/** @} */	//End of group MDLLFACTORY.
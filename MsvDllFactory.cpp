@@ -36,6 +36,288 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 #include "merror/MsvErrorCodes.h"
 
+MSV_DISABLE_ALL_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		Factory instance count.
+* @details	Source of unique factory instance ids.
+******************************************************************************************************/
+static std::atomic<std::uint64_t> g_factoryInstanceCount(0);
+
+/**************************************************************************************************//**
+* @brief		Leaked DLL pins lock.
+* @details	Locks leaked DLL pins.
+******************************************************************************************************/
+static std::mutex g_leakedDllPinsLock;
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory::MsvDllCacheEntry implementation
+********************************************************************************************************************************/
+
+
+MsvDllFactory::MsvDllCacheEntry::MsvDllCacheEntry(const IMsvDll* pDll, const std::shared_ptr<IMsvDllObject>& spDllObject, MsvDllPin* pDllPin, MsvDllRefCountedObject* pRefCountedDllObject):
+	m_pDll(pDll),
+	m_wpDllObject(spDllObject),
+	m_pDllPin(pDllPin),
+	m_pRefCountedDllObject(pRefCountedDllObject)
+{
+
+}
+
+const IMsvDll* MsvDllFactory::MsvDllCacheEntry::GetDll() const
+{
+	return m_pDll;
+}
+
+bool MsvDllFactory::MsvDllCacheEntry::GetDllObject(std::shared_ptr<IMsvDllObject>& spDllObject) const
+{
+	if ((spDllObject = m_wpDllObject.lock()))
+	{
+		return true;
+	}
+
+	//object owned by pin is alive until its DLL is released - shared pointer holds pin of the DLL
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+	if (!GetDllObject(dllObject))
+	{
+		return false;
+	}
+
+	spDllObject = dllObject.ToSharedPtr();
+
+	return true;
+}
+
+bool MsvDllFactory::MsvDllCacheEntry::GetDllObject(MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject) const
+{
+	return m_pDllPin && m_pDllPin->Acquire(m_pRefCountedDllObject, dllObject);
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory::MsvDllPin implementation
+********************************************************************************************************************************/
+
+
+MsvDllFactory::MsvDllPin::MsvDllPin():
+	m_pinCount(0),
+	m_detaching(false)
+{
+
+}
+
+void MsvDllFactory::MsvDllPin::Own(MsvDllRefCountedObject* pDllObject)
+{
+	for (std::vector<MsvDllObjectPtr<MsvDllRefCountedObject>>::const_iterator it = m_dllObjects.begin(); it != m_dllObjects.end(); ++it)
+	{
+		if (it->Get() == pDllObject)
+		{
+			//DLL returned the same object for more ids
+			return;
+		}
+	}
+
+	m_dllObjects.push_back(MsvDllObjectPtr<MsvDllRefCountedObject>(pDllObject));
+}
+
+bool MsvDllFactory::MsvDllPin::Acquire(MsvDllRefCountedObject* pDllObject, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject)
+{
+	//pin count is incremented before detaching flag is checked (release checks them in reverse order)
+	m_pinCount.fetch_add(1);
+	if (m_detaching.load())
+	{
+		m_pinCount.fetch_sub(1);
+		return false;
+	}
+
+	//object is owned by this pin (it is alive until DLL objects are released) - pointer adopts the pin
+	dllObject = MsvDllObjectPtr<MsvDllRefCountedObject>(pDllObject, &m_pinCount);
+
+	return true;
+}
+
+bool MsvDllFactory::MsvDllPin::Detach(std::int64_t& pinCount)
+{
+	//detaching flag is set before pin count is checked (readers check them in reverse order)
+	m_detaching.store(true);
+	pinCount = m_pinCount.load();
+	if (pinCount > 0)
+	{
+		m_detaching.store(false);
+		return false;
+	}
+
+	return true;
+}
+
+void MsvDllFactory::MsvDllPin::CancelDetach()
+{
+	m_detaching.store(false);
+}
+
+void MsvDllFactory::MsvDllPin::ReleaseDllObjects()
+{
+	m_dllObjects.clear();
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory::MsvDllTokenSlot implementation
+********************************************************************************************************************************/
+
+
+MsvDllFactory::MsvDllTokenSlot::MsvDllTokenSlot():
+	m_pEntry(nullptr)
+{
+
+}
+
+MsvDllFactory::MsvDllTokenSlot::~MsvDllTokenSlot()
+{
+	delete m_pEntry.load();
+}
+
+void MsvDllFactory::MsvDllTokenSlot::SetId(const char* id, const MsvDllId& dllId)
+{
+	m_id.assign(id);
+	m_dllId = dllId;
+}
+
+const char* MsvDllFactory::MsvDllTokenSlot::GetId() const
+{
+	return m_id.c_str();
+}
+
+const MsvDllId& MsvDllFactory::MsvDllTokenSlot::GetDllId() const
+{
+	return m_dllId;
+}
+
+const MsvDllFactory::MsvDllCacheEntry* MsvDllFactory::MsvDllTokenSlot::GetEntry() const
+{
+	return m_pEntry.load();
+}
+
+void MsvDllFactory::MsvDllTokenSlot::SetEntry(const MsvDllCacheEntry* pEntry, MsvDllReclaimer& reclaimer)
+{
+	//replaced entry might be used by readers - it is deleted after grace period
+	reclaimer.Retire(m_pEntry.exchange(pEntry));
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory::MsvDllCache implementation
+********************************************************************************************************************************/
+
+
+const MsvDllFactory::MsvDllCacheEntry* MsvDllFactory::MsvDllCache::Find(const char* id) const
+{
+	std::map<std::string, std::shared_ptr<const MsvDllCacheEntry>, std::less<>>::const_iterator it = m_dllObjectsByName.find(id);
+
+	return it != m_dllObjectsByName.end() ? it->second.get() : nullptr;
+}
+
+const MsvDllFactory::MsvDllCacheEntry* MsvDllFactory::MsvDllCache::Find(const MsvDllId& id) const
+{
+	std::unordered_map<MsvDllId, std::shared_ptr<const MsvDllCacheEntry>>::const_iterator it = m_dllObjectsById.find(id);
+
+	return it != m_dllObjectsById.end() ? it->second.get() : nullptr;
+}
+
+void MsvDllFactory::MsvDllCache::Insert(const char* id, const MsvDllId& dllId, const std::shared_ptr<const MsvDllCacheEntry>& spEntry)
+{
+	m_dllObjectsByName[id] = spEntry;
+
+	if (dllId.Valid())
+	{
+		m_dllObjectsById[dllId] = spEntry;
+	}
+}
+
+void MsvDllFactory::MsvDllCache::Remove(const IMsvDll* pDll)
+{
+	for (std::unordered_map<MsvDllId, std::shared_ptr<const MsvDllCacheEntry>>::iterator it = m_dllObjectsById.begin(); it != m_dllObjectsById.end();)
+	{
+		it = it->second->GetDll() == pDll ? m_dllObjectsById.erase(it) : ++it;
+	}
+
+	for (std::map<std::string, std::shared_ptr<const MsvDllCacheEntry>, std::less<>>::iterator it = m_dllObjectsByName.begin(); it != m_dllObjectsByName.end();)
+	{
+		it = it->second->GetDll() == pDll ? m_dllObjectsByName.erase(it) : ++it;
+	}
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory::MsvDllObjectRequest implementation
+********************************************************************************************************************************/
+
+
+MsvDllFactory::MsvDllObjectRequest::MsvDllObjectRequest(const MsvDllObjectCallback& callback):
+	m_completed(false),
+	m_callback(callback)
+{
+
+}
+
+void MsvDllFactory::MsvDllObjectRequest::Complete(MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	//loader and timer race for it - only the first one calls callback
+	if (!m_completed.exchange(true))
+	{
+		m_callback(errorCode, spDllObject);
+	}
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory::MsvDllWarmup implementation
+********************************************************************************************************************************/
+
+
+MsvDllFactory::MsvDllWarmup::MsvDllWarmup():
+	m_cancelled(false),
+	m_completed(false)
+{
+
+}
+
+void MsvDllFactory::MsvDllWarmup::Cancel()
+{
+	m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+const std::atomic<bool>& MsvDllFactory::MsvDllWarmup::GetCancelled() const
+{
+	return m_cancelled;
+}
+
+void MsvDllFactory::MsvDllWarmup::Complete()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_completed = true;
+	}
+
+	m_completedCondition.notify_all();
+}
+
+void MsvDllFactory::MsvDllWarmup::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_completedCondition.wait(lock, [this]() { return m_completed; });
+}
+
 
 /********************************************************************************************************************************
 *															Constructors and destructors
@@ -43,11 +325,51 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 
 MsvDllFactory::MsvDllFactory(const std::shared_ptr<IMsvDllList>& spDllList, std::shared_ptr<MsvLogger> spLogger, std::shared_ptr<MsvDllFactory_Factory> spFactory):
+	m_pDllCache(new (std::nothrow) MsvDllCache()),
+	m_tokenCount(0),
+	m_instanceId(++g_factoryInstanceCount),
+	m_epoch(0),
+	m_threadCacheEnabled(false),
+	m_shutdownPolicy(MSV_DLL_SHUTDOWN_ORDERED),
 	m_spDllList(spDllList),
 	m_spLogger(spLogger),
-	m_spFactory(spFactory ? spFactory : MsvDllFactory_Factory::Get())
+	m_spFactory(spFactory ? spFactory : MsvDllFactory_Factory::Get()),
+	m_loader(MSV_DLL_LOADER_THREAD_COUNT),
+	m_warmer(MSV_DLL_WARMER_THREAD_COUNT, true),
+	m_reaper(MSV_DLL_REAPER_THREAD_COUNT, true),
+	m_pendingUnloadCount(0),
+	m_unloadedCount(0),
+	m_unloadTime(0),
+	m_maxUnloadTime(0)
+{
+
+}
+
+MsvDllFactory::~MsvDllFactory()
 {
+	//finish asynchronous requests first (loader tasks use this factory)
+	m_loader.Stop();
+
+	//cancel warmups and wait for them (warmer tasks use this factory and its DLLs)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		for (std::map<std::string, std::shared_ptr<MsvDllWarmup>, std::less<>>::iterator it = m_warmups.begin(); it != m_warmups.end(); ++it)
+		{
+			it->second->Cancel();
+		}
+	}
+
+	m_warmer.Stop();
+
+	//finish pending unloads (reaper tasks use this factory)
+	m_reaper.Stop();
+
+	//loaded DLLs are released now - readers must be gone
+	m_reclaimer.Synchronize();
 
+	//release loaded DLLs by shutdown policy
+	ShutdownDlls();
 }
 
 
@@ -58,8 +380,6 @@ MsvDllFactory::MsvDllFactory(const std::shared_ptr<IMsvDllList>& spDllList, std:
 
 MsvErrorCode MsvDllFactory::GetDll(const char* id, std::shared_ptr<IMsvDll>& spDll)
 {
-	std::lock_guard<std::recursive_mutex> lock(m_lock);
-
 	std::shared_ptr<IMsvDllDecorator> spDecorator;
 
 	return GetDll(id, spDll, spDecorator);
@@ -67,101 +387,1137 @@ MsvErrorCode MsvDllFactory::GetDll(const char* id, std::shared_ptr<IMsvDll>& spD
 
 MsvErrorCode MsvDllFactory::GetDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject)
 {
-	std::lock_guard<std::recursive_mutex> lock(m_lock);
-
-	MSV_LOG_INFO(m_spLogger, "Getting DLL object \"{}\".", id);
+	MsvDllThreadCache* pThreadCache = nullptr;
+	std::uint64_t epoch = 0;
+	if (m_threadCacheEnabled.load(std::memory_order_relaxed) && (pThreadCache = GetThreadCache()) != nullptr)
+	{
+		//thread local fast path - it does not touch any memory shared by more threads (except epoch read)
+		epoch = m_epoch.load();
+		if (pThreadCache->GetDllObject(id, epoch, spDllObject))
+		{
+			return MSV_SUCCESS;
+		}
+	}
 
-	std::shared_ptr<IMsvDll> spDll;
-	std::shared_ptr<IMsvDllDecorator> spDecorator;
-	MSV_RETURN_FAILED(GetDll(id, spDll, spDecorator));
-	MSV_RETURN_FAILED(spDll->GetDllObject(id, spDllObject, spDecorator));
+	//lock-free fast path - DLL object has been already acquired and it is still alive (braced GUID id is parsed only on slow path)
+	if (GetCachedDllObject(id, spDllObject) != MSV_SUCCESS)
+	{
+		MSV_RETURN_FAILED(AcquireDllObject(id, MsvDllId(id), spDllObject));
+	}
 
-	MSV_LOG_INFO(m_spLogger, "Returning DLL object \"{}\".", id);
+	if (pThreadCache)
+	{
+		pThreadCache->CacheDllObject(id, MsvDllId(id), epoch, spDllObject);
+	}
 
 	return MSV_SUCCESS;
 }
 
 MsvErrorCode MsvDllFactory::ReleaseDll(const char* id)
 {
-	std::lock_guard<std::recursive_mutex> lock(m_lock);
-
 	MSV_LOG_INFO(m_spLogger, "Releasing DLL library \"{}\".", id);
 
 	std::string dllPath;
-	std::shared_ptr<IMsvDllDecorator> spDecorator;
-	MSV_RETURN_FAILED(m_spDllList->GetDll(id, dllPath, spDecorator));
+	std::shared_ptr<IMsvDll> spDll;
+	std::shared_ptr<MsvDllWarmup> spWarmup;
+	std::shared_ptr<MsvDllPin> spDllPin;
+	MsvErrorCode errorCode = DetachDll(id, dllPath, spDll, spWarmup, spDllPin);
+	if (errorCode != MSV_SUCCESS)
+	{
+		//DLL has not been detached (not loaded is info only)
+		return errorCode;
+	}
+
+	return UnloadDll(id, dllPath, spDll, spWarmup, spDllPin);
+}
+
+MsvErrorCode MsvDllFactory::GetDll(const MsvDllId& id, std::shared_ptr<IMsvDll>& spDll)
+{
+	char idString[MSV_DLL_ID_STRING_SIZE];
+
+	return GetDll(id.ToString(idString), spDll);
+}
 
-	//we have DLL data -> check if is already loaded (in list)
-	std::map<std::string, std::shared_ptr<IMsvDll>>::const_iterator it = m_loadedDlls.find(dllPath);
-	if (it != m_loadedDlls.end())
+MsvErrorCode MsvDllFactory::GetDllObject(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	MsvDllThreadCache* pThreadCache = nullptr;
+	std::uint64_t epoch = 0;
+	if (m_threadCacheEnabled.load(std::memory_order_relaxed) && (pThreadCache = GetThreadCache()) != nullptr)
 	{
-		//check if can unload DLL
-		if (it->second.use_count() > 1)
+		//thread local fast path - it does not touch any memory shared by more threads (except epoch read)
+		epoch = m_epoch.load();
+		if (pThreadCache->GetDllObject(id, epoch, spDllObject))
 		{
-			//DLL is holded by anyone else (can't release)
-			MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" (\"{}\") is hold by someone else (not only by DLL factory).", id, dllPath);
-			return MSV_NOT_ALLOWED_ERROR;
+			return MSV_SUCCESS;
 		}
+	}
 
-		MSV_LOG_INFO(m_spLogger, "Uninitializing DLL library \"{}\" (\"{}\").", id, dllPath);
-		
-		//uninitialize, unload and release DLL
-		MSV_RETURN_FAILED(it->second->Uninitialize());
-		m_loadedDlls.erase(it);
-
-		MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has been successfully unitialized, unloaded and released.", id, dllPath);
-
-		return MSV_SUCCESS;
+	//lock-free fast path - id is not formatted to string at all
+	char idString[MSV_DLL_ID_STRING_SIZE];
+	if (GetCachedDllObject(id, spDllObject) != MSV_SUCCESS)
+	{
+		//invalid (nil) id is formatted too - it is handled as any other not GUID id
+		MSV_RETURN_FAILED(AcquireDllObject(id.ToString(idString), id, spDllObject));
+	}
+	else if (pThreadCache)
+	{
+		id.ToString(idString);
 	}
 
-	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has not been loaded.", id, dllPath);
+	if (pThreadCache)
+	{
+		pThreadCache->CacheDllObject(idString, id, epoch, spDllObject);
+	}
 
-	//not in list (not loaded or already released) - just info
-	return MSV_NOT_FOUND_INFO;
+	return MSV_SUCCESS;
 }
 
-MsvErrorCode MsvDllFactory::GetDll(const char* id, std::shared_ptr<IMsvDll>& spDll, std::shared_ptr<IMsvDllDecorator>& spDecorator)
+MsvErrorCode MsvDllFactory::ReleaseDll(const MsvDllId& id)
 {
-	std::lock_guard<std::recursive_mutex> lock(m_lock);
+	char idString[MSV_DLL_ID_STRING_SIZE];
 
-	MSV_LOG_INFO(m_spLogger, "Getting DLL library \"{}\".", id);
-
-	std::string dllPath;
+	return ReleaseDll(id.ToString(idString));
+}
 
-	MSV_RETURN_FAILED(m_spDllList->GetDll(id, dllPath, spDecorator));
+MsvErrorCode MsvDllFactory::Resolve(const char* id, MsvDllToken& token)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
 
-	//we have DLL data -> check if is already loaded (in list)
-	std::map<std::string, std::shared_ptr<IMsvDll>>::const_iterator it = m_loadedDlls.find(dllPath);
-	if (it != m_loadedDlls.end())
+	std::map<std::string, std::uint32_t, std::less<>>::const_iterator it = m_tokens.find(id);
+	if (it != m_tokens.end())
 	{
-		MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has been already loaded - returning it.", id, dllPath);
-		spDll = it->second;
+		//already resolved -> same id has always same token
+		token = MsvDllToken(it->second);
 		return MSV_SUCCESS;
 	}
 
-	//not in list
-	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") is not loaded - loading it.", id, dllPath);
+	MSV_LOG_INFO(m_spLogger, "Resolving DLL object \"{}\".", id);
 
-	MsvErrorCode errorCode = MSV_SUCCESS;
-	std::shared_ptr<IMsvDll> spInnerDll = m_spFactory->GetIMsvDll(m_spLogger);
-	if (!spInnerDll)
+	//only DLLs from list can be resolved
+	std::string dllPath;
+	std::shared_ptr<IMsvDllDecorator> spDecorator;
+	MSV_RETURN_FAILED(m_spDllList->GetDll(id, dllPath, spDecorator));
+
+	std::uint32_t index = m_tokenCount.load(std::memory_order_relaxed);
+	std::uint32_t chunk = index / MSV_DLL_TOKEN_CHUNK_SIZE;
+	if (chunk >= MSV_DLL_TOKEN_CHUNK_COUNT)
 	{
-		MSV_LOG_ERROR(m_spLogger, "Create DLL library object for \"{}\" (\"{}\") failed.", id, dllPath);
+		MSV_LOG_ERROR(m_spLogger, "Token table is full - DLL object \"{}\" can't be resolved.", id);
 		return MSV_ALLOCATION_ERROR;
 	}
 
-	if (MSV_FAILED(errorCode = spInnerDll->Initialize(dllPath.c_str())))
+	if (!m_tokenChunks[chunk])
 	{
-		MSV_LOG_ERROR(m_spLogger, "Initialize DLL library object for \"{}\" (\"{}\") failed with error: {}", id, dllPath, errorCode);
-		return errorCode;
+		m_tokenChunks[chunk].reset(new (std::nothrow) MsvDllTokenSlot[MSV_DLL_TOKEN_CHUNK_SIZE]);
+		if (!m_tokenChunks[chunk])
+		{
+			MSV_LOG_ERROR(m_spLogger, "Create token table chunk for DLL object \"{}\" failed.", id);
+			return MSV_ALLOCATION_ERROR;
+		}
 	}
 
-	m_loadedDlls[dllPath] = spInnerDll;
-	spDll = spInnerDll;
+	MsvDllTokenSlot& slot = m_tokenChunks[chunk][index % MSV_DLL_TOKEN_CHUNK_SIZE];
+	slot.SetId(id, MsvDllId(id));
 
-	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has been successfully loaded.", id, dllPath);
+	m_tokens[id] = index;
+
+	//publish token - slot is fully initialized now
+	m_tokenCount.store(index + 1, std::memory_order_release);
+	token = MsvDllToken(index);
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::Resolve(const MsvDllId& id, MsvDllToken& token)
+{
+	char idString[MSV_DLL_ID_STRING_SIZE];
+
+	return Resolve(id.ToString(idString), token);
+}
+
+MsvErrorCode MsvDllFactory::GetDllObject(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	MsvDllTokenSlot* pSlot = GetTokenSlot(token);
+	if (!pSlot)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Invalid DLL object token {}.", token.GetIndex());
+		return MSV_INVALID_DATA_ERROR;
+	}
+
+	{
+		//lock-free fast path - array index only (entry is not deleted until read-side section is left)
+		MsvDllReadSection readSection(m_reclaimer);
+
+		const MsvDllCacheEntry* pEntry = pSlot->GetEntry();
+		if (pEntry && pEntry->GetDllObject(spDllObject))
+		{
+			return MSV_SUCCESS;
+		}
+	}
+
+	//not acquired yet, expired or DLL has been released -> acquire it (loads DLL again when needed, it fills the slot too)
+	return AcquireDllObject(pSlot->GetId(), pSlot->GetDllId(), spDllObject);
+}
+
+MsvErrorCode MsvDllFactory::GetRefCountedDllObject(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject)
+{
+	{
+		//lock-free fast path - owned object is returned by raw pointer (only pin count of its DLL is incremented)
+		MsvDllReadSection readSection(m_reclaimer);
+
+		const MsvDllCache* pDllCache = m_pDllCache.load();
+		const MsvDllCacheEntry* pEntry = pDllCache ? pDllCache->Find(id) : nullptr;
+		if (pEntry && pEntry->GetDllObject(dllObject))
+		{
+			return MSV_SUCCESS;
+		}
+	}
+
+	return AcquireRefCountedDllObject(id, MsvDllId(id), dllObject);
+}
+
+MsvErrorCode MsvDllFactory::GetRefCountedDllObject(const MsvDllToken& token, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject)
+{
+	MsvDllTokenSlot* pSlot = GetTokenSlot(token);
+	if (!pSlot)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Invalid DLL object token {}.", token.GetIndex());
+		return MSV_INVALID_DATA_ERROR;
+	}
+
+	{
+		//lock-free fast path - array index only (entry is not deleted until read-side section is left)
+		MsvDllReadSection readSection(m_reclaimer);
+
+		const MsvDllCacheEntry* pEntry = pSlot->GetEntry();
+		if (pEntry && pEntry->GetDllObject(dllObject))
+		{
+			return MSV_SUCCESS;
+		}
+	}
+
+	return AcquireRefCountedDllObject(pSlot->GetId(), pSlot->GetDllId(), dllObject);
+}
+
+
+MsvErrorCode MsvDllFactory::Preload(const std::vector<std::string>& ids, bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results)
+{
+	MSV_LOG_INFO(m_spLogger, "Preloading {} DLL objects.", ids.size());
+
+	results.clear();
+
+	//group ids by DLL path - each DLL is loaded only once (by one thread)
+	std::map<std::string, std::vector<std::pair<const char*, std::shared_ptr<IMsvDllDecorator>>>> dllIds;
+	for (std::vector<std::string>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+	{
+		std::string dllPath;
+		std::shared_ptr<IMsvDllDecorator> spDecorator;
+		MSV_RETURN_FAILED(m_spDllList->GetDll(it->c_str(), dllPath, spDecorator));
+
+		dllIds[dllPath].push_back(std::make_pair(it->c_str(), spDecorator));
+	}
+
+	std::vector<std::map<std::string, std::vector<std::pair<const char*, std::shared_ptr<IMsvDllDecorator>>>>::const_iterator> dlls;
+	dlls.reserve(dllIds.size());
+	for (std::map<std::string, std::vector<std::pair<const char*, std::shared_ptr<IMsvDllDecorator>>>>::const_iterator it = dllIds.begin(); it != dllIds.end(); ++it)
+	{
+		dlls.push_back(it);
+	}
+
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	//files of next DLLs are read to page cache while current ones are loaded (each file is read ahead by one thread only)
+	std::shared_ptr<IMsvDllAdapter> spDllAdapter = m_spFactory->GetIMsvDllAdapter(m_spLogger);
+	if (!spDllAdapter)
+	{
+		//not fatal - DLLs are read by theirs loads then
+		MSV_LOG_WARN(m_spLogger, "Create DLL adapter for readahead failed.");
+	}
+
+	std::atomic<std::size_t> nextReadahead(0);
+	auto readahead = [this, &dlls, &nextReadahead, &spDllAdapter](std::size_t end)
+	{
+		end = spDllAdapter ? std::min(end, dlls.size()) : 0;
+		for (std::size_t index = nextReadahead.load(); index < end; index = nextReadahead.load())
+		{
+			if (nextReadahead.compare_exchange_weak(index, index + 1))
+			{
+				MsvErrorCode errorCode = spDllAdapter->ReadaheadDllLibrary(dlls[index]->first.c_str());
+				if (MSV_FAILED(errorCode))
+				{
+					//not fatal - DLL is read by its load then (e.g. it is found by search path of system)
+					MSV_LOG_INFO(m_spLogger, "Readahead DLL library \"{}\" failed with error: {}", dlls[index]->first, errorCode);
+				}
+			}
+		}
+	};
+
+	//each thread takes next DLL until all are loaded (each result is written by one thread only)
+	results.resize(dlls.size());
+	std::atomic<std::size_t> nextDll(0);
+	auto preload = [this, &dlls, &results, &nextDll, &readahead, threadCount, instantiate]()
+	{
+		for (std::size_t index = nextDll++; index < dlls.size(); index = nextDll++)
+		{
+			readahead(index + threadCount + MSV_DLL_READAHEAD_DEPTH);
+			results[index] = PreloadDll(dlls[index]->first, dlls[index]->second, instantiate);
+		}
+	};
+
+	readahead(threadCount + MSV_DLL_READAHEAD_DEPTH);
+
+	//calling thread is one of the loading threads
+	std::vector<std::thread> threads;
+	threads.reserve(std::min(static_cast<std::size_t>(threadCount), dlls.size()));
+	for (std::size_t index = 1; index < threadCount && index < dlls.size(); ++index)
+	{
+		try
+		{
+			threads.emplace_back(preload);
+		}
+		catch (const std::system_error& error)
+		{
+			//not fatal - DLLs are loaded by started threads (calling thread loads all of them at least)
+			MSV_LOG_WARN(m_spLogger, "Start preload thread failed with error: {}", error.what());
+			break;
+		}
+	}
+
+	preload();
+
+	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+	{
+		it->join();
+	}
+
+	for (std::vector<MsvDllPreloadResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+	{
+		if (MSV_FAILED(it->GetErrorCode()))
+		{
+			MSV_LOG_ERROR(m_spLogger, "Preload DLL library \"{}\" failed with error: {}", it->GetDllPath(), it->GetErrorCode());
+			return it->GetErrorCode();
+		}
+	}
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::Preload(bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results)
+{
+	std::vector<std::string> ids;
+	MsvErrorCode errorCode = m_spDllList->GetDllIds(ids);
+	if (MSV_FAILED(errorCode))
+	{
+		MSV_LOG_ERROR(m_spLogger, "Get DLL ids from DLL list failed with error: {}", errorCode);
+		results.clear();
+		return errorCode;
+	}
+
+	return Preload(ids, instantiate, threadCount, results);
+}
+
+
+MsvErrorCode MsvDllFactory::GetDllObjectAsync(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline)
+{
+	//already acquired DLL object -> complete inline (no thread switch)
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	if (GetCachedDllObject(id, spDllObject) == MSV_SUCCESS)
+	{
+		callback(MSV_SUCCESS, spDllObject);
+		return MSV_SUCCESS;
+	}
+
+	std::shared_ptr<MsvDllObjectRequest> spRequest(new (std::nothrow) MsvDllObjectRequest(callback));
+	if (!spRequest)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Create asynchronous request for DLL object \"{}\" failed.", id);
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	MSV_LOG_INFO(m_spLogger, "Queueing asynchronous request for DLL object \"{}\".", id);
+
+	//slow path of GetDllObject on loader thread (id is copied - caller's buffer might not live so long)
+	std::string requestId(id);
+	MsvErrorCode errorCode = m_loader.Execute([this, spRequest, requestId]()
+	{
+		std::shared_ptr<IMsvDllObject> spLoadedDllObject;
+		MsvErrorCode loadErrorCode = GetCachedDllObject(requestId.c_str(), spLoadedDllObject);
+		if (loadErrorCode != MSV_SUCCESS)
+		{
+			loadErrorCode = AcquireDllObject(requestId.c_str(), MsvDllId(requestId.c_str()), spLoadedDllObject);
+		}
+
+		spRequest->Complete(loadErrorCode, spLoadedDllObject);
+	});
+
+	if (MSV_FAILED(errorCode))
+	{
+		MSV_LOG_ERROR(m_spLogger, "Queue asynchronous request for DLL object \"{}\" failed with error: {}", id, errorCode);
+		return errorCode;
+	}
+
+	if (deadline != std::chrono::steady_clock::time_point::max())
+	{
+		//timer completes request when it is not completed in time (load keeps going and its object is cached)
+		//request is held by loader task only - completed request (its callback and captures) is not kept until deadline
+		std::weak_ptr<MsvDllObjectRequest> wpRequest(spRequest);
+		errorCode = m_loader.ExecuteAt(deadline, [wpRequest]()
+		{
+			std::shared_ptr<MsvDllObjectRequest> spTimedRequest = wpRequest.lock();
+			if (spTimedRequest)
+			{
+				spTimedRequest->Complete(MSV_TIMEOUT_ERROR, nullptr);
+			}
+		});
+
+		if (MSV_FAILED(errorCode))
+		{
+			//not fatal - queued request is completed by loader (factory is being destroyed)
+			MSV_LOG_WARN(m_spLogger, "Queue deadline of asynchronous request for DLL object \"{}\" failed with error: {}", id, errorCode);
+		}
+	}
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::GetDllObjectAsync(const char* id, std::future<MsvDllObjectResult>& future, std::chrono::steady_clock::time_point deadline)
+{
+	std::shared_ptr<std::promise<MsvDllObjectResult>> spPromise(new (std::nothrow) std::promise<MsvDllObjectResult>());
+	if (!spPromise)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Create promise for DLL object \"{}\" failed.", id);
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	std::future<MsvDllObjectResult> newFuture = spPromise->get_future();
+	MSV_RETURN_FAILED(GetDllObjectAsync(id, [spPromise](MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>& spDllObject)
+	{
+		spPromise->set_value(MsvDllObjectResult(errorCode, spDllObject));
+	}, deadline));
+
+	future = std::move(newFuture);
+
+	return MSV_SUCCESS;
+}
+
+MsvDllReclaimer& MsvDllFactory::GetDllReclaimer()
+{
+	return m_reclaimer;
+}
+
+MsvErrorCode MsvDllFactory::ReleaseDllAsync(const char* id)
+{
+	MSV_LOG_INFO(m_spLogger, "Releasing DLL library \"{}\" asynchronously.", id);
+
+	std::string dllPath;
+	std::shared_ptr<IMsvDll> spDll;
+	std::shared_ptr<MsvDllWarmup> spWarmup;
+	std::shared_ptr<MsvDllPin> spDllPin;
+	MsvErrorCode errorCode = DetachDll(id, dllPath, spDll, spWarmup, spDllPin);
+	if (errorCode != MSV_SUCCESS)
+	{
+		//DLL has not been detached (not loaded is info only)
+		return errorCode;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_unloadLock);
+		++m_pendingUnloadCount;
+	}
+
+	//id must be copied - caller's one is not valid when reaper unloads DLL
+	std::string idString(id);
+	errorCode = m_reaper.Execute([this, idString, dllPath, spDll, spWarmup, spDllPin]()
+	{
+		UnloadDll(idString.c_str(), dllPath, spDll, spWarmup, spDllPin);
+
+		std::lock_guard<std::mutex> lock(m_unloadLock);
+		--m_pendingUnloadCount;
+		m_unloadCondition.notify_all();
+	});
+
+	if (MSV_FAILED(errorCode))
+	{
+		//DLL has already been detached - it is unloaded by caller's thread
+		MSV_LOG_WARN(m_spLogger, "Queue unload of DLL library \"{}\" (\"{}\") failed with error: {}", id, dllPath, errorCode);
+
+		{
+			std::lock_guard<std::mutex> lock(m_unloadLock);
+			--m_pendingUnloadCount;
+			m_unloadCondition.notify_all();
+		}
+
+		return UnloadDll(id, dllPath, spDll, spWarmup, spDllPin);
+	}
+
+	return MSV_SUCCESS;
+}
+
+void MsvDllFactory::WaitForDllUnloads()
+{
+	std::unique_lock<std::mutex> lock(m_unloadLock);
+
+	m_unloadCondition.wait(lock, [this]() { return m_pendingUnloadCount == 0; });
+}
+
+void MsvDllFactory::GetDllUnloadMetrics(std::uint32_t& pendingCount, std::uint64_t& unloadedCount, std::chrono::microseconds& unloadTime, std::chrono::microseconds& maxUnloadTime) const
+{
+	std::lock_guard<std::mutex> lock(m_unloadLock);
+
+	pendingCount = m_pendingUnloadCount;
+	unloadedCount = m_unloadedCount;
+	unloadTime = m_unloadTime;
+	maxUnloadTime = m_maxUnloadTime;
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory public methods
+********************************************************************************************************************************/
+
+
+void MsvDllFactory::EnableThreadCache(bool enable)
+{
+	m_threadCacheEnabled.store(enable);
+}
+
+void MsvDllFactory::SetShutdownPolicy(MsvDllShutdownPolicy policy)
+{
+	m_shutdownPolicy.store(policy);
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllFactory protected methods
+********************************************************************************************************************************/
+
+
+MsvErrorCode MsvDllFactory::AcquireDllObject(const char* id, const MsvDllId& dllId, std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	//factory lock is not held here - only the requested DLL is locked while its object is being acquired
+	MSV_LOG_INFO(m_spLogger, "Getting DLL object \"{}\".", id);
+
+	std::shared_ptr<IMsvDll> spDll;
+	std::shared_ptr<IMsvDllDecorator> spDecorator;
+	MSV_RETURN_FAILED(GetDll(id, spDll, spDecorator));
+	MSV_RETURN_FAILED(spDll->GetDllObject(id, spDllObject, spDecorator));
+
+	//publish acquired object for lock-free readers (failure is not fatal - next call just takes the slow path again)
+	CacheDllObject(id, dllId, spDll.get(), spDllObject);
+
+	MSV_LOG_INFO(m_spLogger, "Returning DLL object \"{}\".", id);
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::AcquireRefCountedDllObject(const char* id, const MsvDllId& dllId, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject)
+{
+	MSV_LOG_INFO(m_spLogger, "Getting reference counted DLL object \"{}\".", id);
+
+	//DLL is held by shared pointer - it can't be released until its object is owned and cached
+	std::shared_ptr<IMsvDll> spDll;
+	std::shared_ptr<IMsvDllDecorator> spDecorator;
+	MSV_RETURN_FAILED(GetDll(id, spDll, spDecorator));
+
+	//the same object as shared pointer path returns (already acquired one when it is alive)
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	if (GetCachedDllObject(id, spDllObject) != MSV_SUCCESS)
+	{
+		MSV_RETURN_FAILED(spDll->GetDllObject(id, spDllObject, spDecorator));
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	std::shared_ptr<MsvDllPin>& spDllPin = m_dllPins[spDll.get()];
+	if (!spDllPin)
+	{
+		spDllPin.reset(new (std::nothrow) MsvDllPin());
+		if (!spDllPin)
+		{
+			m_dllPins.erase(spDll.get());
+			MSV_LOG_ERROR(m_spLogger, "Create DLL pin for \"{}\" failed.", id);
+			return MSV_ALLOCATION_ERROR;
+		}
+	}
+
+	//object is owned until its DLL is released (caller guarantees it is reference counted object)
+	MsvDllRefCountedObject* pRefCountedDllObject = static_cast<MsvDllRefCountedObject*>(spDllObject.get());
+	spDllPin->Own(pRefCountedDllObject);
+
+	//publish owned object for lock-free readers (failure is not fatal - next call just takes the slow path again)
+	CacheDllObject(id, dllId, spDll.get(), spDllObject, spDllPin.get(), pRefCountedDllObject);
+
+	//DLL can't be detached under factory lock - pin is always acquired here
+	spDllPin->Acquire(pRefCountedDllObject, dllObject);
+
+	MSV_LOG_INFO(m_spLogger, "Returning reference counted DLL object \"{}\".", id);
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::GetDll(const char* id, std::shared_ptr<IMsvDll>& spDll, std::shared_ptr<IMsvDllDecorator>& spDecorator)
+{
+	MSV_LOG_INFO(m_spLogger, "Getting DLL library \"{}\".", id);
+
+	std::string dllPath;
+	MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT;
+	std::shared_ptr<IMsvDll> spInnerDll;
+	std::shared_ptr<MsvDllSingleFlight<std::shared_ptr<IMsvDll>>::MsvFlight> spFlight;
+	bool leader = false;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		MSV_RETURN_FAILED(m_spDllList->GetDll(id, dllPath, spDecorator, loadOptions));
+
+		//we have DLL data -> check if is already loaded (in list)
+		std::map<std::string, std::shared_ptr<IMsvDll>, std::less<>>::const_iterator it = m_loadedDlls.find(dllPath);
+		if (it != m_loadedDlls.end())
+		{
+			MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has been already loaded - returning it.", id, dllPath);
+			spDll = it->second;
+			return MSV_SUCCESS;
+		}
+
+		//not in list -> join loading of this DLL (only one thread loads it)
+		spFlight = m_loadingDlls.Join(dllPath.c_str(), leader);
+		if (!spFlight)
+		{
+			MSV_LOG_ERROR(m_spLogger, "Create DLL library load for \"{}\" (\"{}\") failed.", id, dllPath);
+			return MSV_ALLOCATION_ERROR;
+		}
+
+		if (leader)
+		{
+			spInnerDll = m_spFactory->GetIMsvDll(m_spLogger);
+			if (!spInnerDll)
+			{
+				MSV_LOG_ERROR(m_spLogger, "Create DLL library object for \"{}\" (\"{}\") failed.", id, dllPath);
+				m_loadingDlls.Leave(dllPath.c_str());
+				spFlight->Complete(MSV_ALLOCATION_ERROR, nullptr);
+				return MSV_ALLOCATION_ERROR;
+			}
+		}
+	}
+
+	MsvErrorCode errorCode = MSV_SUCCESS;
+
+	if (!leader)
+	{
+		//other thread is loading this DLL -> wait for it and share its result (even error)
+		MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") is being loaded by other thread - waiting for it.", id, dllPath);
+
+		if (MSV_FAILED(errorCode = spFlight->Wait(spDll)))
+		{
+			MSV_LOG_ERROR(m_spLogger, "Load DLL library \"{}\" (\"{}\") in other thread failed with error: {}", id, dllPath, errorCode);
+		}
+
+		return errorCode;
+	}
+
+	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") is not loaded - loading it.", id, dllPath);
+
+	//load DLL outside of factory lock -> loading one DLL does not block lookups of other DLLs (DLL is loaded once per path -> options of id which loads it are used)
+	errorCode = spInnerDll->Initialize(dllPath.c_str(), loadOptions);
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		m_loadingDlls.Leave(dllPath.c_str());
+		if (MSV_SUCCEEDED(errorCode))
+		{
+			m_loadedDlls[dllPath] = spInnerDll;
+
+			//DLL has been (re)loaded -> thread caches are stale
+			++m_epoch;
+
+			//DLL is returned immediately, it is warmed up in background
+			MsvErrorCode warmupErrorCode = MSV_SUCCESS;
+			if ((loadOptions & MSV_DLL_LOAD_WARMUP) && MSV_FAILED(warmupErrorCode = WarmupDll(dllPath, spInnerDll.get(), spDecorator)))
+			{
+				MSV_LOG_WARN(m_spLogger, "Warmup of DLL library \"{}\" (\"{}\") has not been started - error: {}", id, dllPath, warmupErrorCode);
+			}
+		}
+	}
+
+	if (MSV_FAILED(errorCode))
+	{
+		MSV_LOG_ERROR(m_spLogger, "Initialize DLL library object for \"{}\" (\"{}\") failed with error: {}", id, dllPath, errorCode);
+		spFlight->Complete(errorCode, nullptr);
+		return errorCode;
+	}
+
+	spFlight->Complete(MSV_SUCCESS, spInnerDll);
+	spDll = spInnerDll;
+
+	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has been successfully loaded.", id, dllPath);
+
+	return MSV_SUCCESS;
+}
+
+MsvDllPreloadResult MsvDllFactory::PreloadDll(const std::string& dllPath, const std::vector<std::pair<const char*, std::shared_ptr<IMsvDllDecorator>>>& ids, bool instantiate)
+{
+	MSV_LOG_INFO(m_spLogger, "Preloading DLL library \"{}\".", dllPath);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::uint32_t objectCount = 0;
+	std::uint64_t prefaultedPages = 0;
+	std::chrono::microseconds prefaultTime(0);
+
+	std::shared_ptr<IMsvDll> spDll;
+	std::shared_ptr<IMsvDllDecorator> spDecorator;
+	MsvErrorCode errorCode = GetDll(ids.front().first, spDll, spDecorator);
+
+	if (MSV_SUCCEEDED(errorCode))
+	{
+		spDll->GetDllPrefault(prefaultedPages, prefaultTime);
+	}
+
+	if (MSV_SUCCEEDED(errorCode) && instantiate)
+	{
+		//run objects creation code (and static initializers of theirs types) now, not in first request
+		for (std::vector<std::pair<const char*, std::shared_ptr<IMsvDllDecorator>>>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+		{
+			std::shared_ptr<IMsvDllObject> spDllObject;
+			MsvErrorCode objectErrorCode = spDll->GetDllObject(it->first, spDllObject, it->second);
+			if (MSV_SUCCEEDED(objectErrorCode))
+			{
+				++objectCount;
+			}
+			else if (MSV_SUCCEEDED(errorCode))
+			{
+				//first failed object error is reported (other objects are still created)
+				MSV_LOG_ERROR(m_spLogger, "Preload DLL object \"{}\" failed with error: {}", it->first, objectErrorCode);
+				errorCode = objectErrorCode;
+			}
+		}
+	}
+
+	return MsvDllPreloadResult(dllPath, errorCode, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start), objectCount, prefaultedPages, prefaultTime);
+}
+
+MsvErrorCode MsvDllFactory::GetCachedDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject) const
+{
+	//snapshot is not deleted until read-side section is left (old snapshots are retired by writers)
+	MsvDllReadSection readSection(m_reclaimer);
+
+	const MsvDllCache* pDllCache = m_pDllCache.load();
+	if (pDllCache)
+	{
+		const MsvDllCacheEntry* pEntry = pDllCache->Find(id);
+		if (pEntry && pEntry->GetDllObject(spDllObject))
+		{
+			return MSV_SUCCESS;
+		}
+	}
+
+	return MSV_NOT_FOUND_INFO;
+}
+
+MsvErrorCode MsvDllFactory::GetCachedDllObject(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject) const
+{
+	//snapshot is not deleted until read-side section is left (old snapshots are retired by writers)
+	MsvDllReadSection readSection(m_reclaimer);
+
+	const MsvDllCache* pDllCache = m_pDllCache.load();
+	if (pDllCache)
+	{
+		const MsvDllCacheEntry* pEntry = pDllCache->Find(id);
+		if (pEntry && pEntry->GetDllObject(spDllObject))
+		{
+			return MSV_SUCCESS;
+		}
+	}
+
+	return MSV_NOT_FOUND_INFO;
+}
+
+MsvErrorCode MsvDllFactory::CacheDllObject(const char* id, const MsvDllId& dllId, const IMsvDll* pDll, const std::shared_ptr<IMsvDllObject>& spDllObject, MsvDllPin* pDllPin, MsvDllRefCountedObject* pRefCountedDllObject)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	//writers are serialized by factory lock - snapshot can be read without read-side section here
+	const MsvDllCache* pOldDllCache = m_pDllCache.load();
+	std::shared_ptr<const MsvDllCacheEntry> spEntry(new (std::nothrow) MsvDllCacheEntry(pDll, spDllObject, pDllPin, pRefCountedDllObject));
+	std::unique_ptr<MsvDllCache> spDllCache(pOldDllCache ? new (std::nothrow) MsvDllCache(*pOldDllCache) : new (std::nothrow) MsvDllCache());
+	if (!spEntry || !spDllCache)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Create DLL object cache for \"{}\" failed.", id);
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	spDllCache->Insert(id, dllId, spEntry);
+	m_pDllCache.store(spDllCache.release());
+
+	//fill token slot when id has been resolved (failure is not fatal - token just takes the slow path again)
+	std::map<std::string, std::uint32_t, std::less<>>::const_iterator it = m_tokens.find(id);
+	if (it != m_tokens.end())
+	{
+		const MsvDllCacheEntry* pSlotEntry = new (std::nothrow) MsvDllCacheEntry(pDll, spDllObject, pDllPin, pRefCountedDllObject);
+		if (!pSlotEntry)
+		{
+			MSV_LOG_ERROR(m_spLogger, "Create token slot entry for \"{}\" failed.", id);
+		}
+
+		GetTokenSlot(MsvDllToken(it->second))->SetEntry(pSlotEntry, m_reclaimer);
+	}
+
+	//old snapshot is deleted when its readers are gone (it does not wait for them)
+	m_reclaimer.Retire(pOldDllCache);
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::UncacheDllObjects(const IMsvDll* pDll)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+	const MsvDllCache* pOldDllCache = m_pDllCache.load();
+	std::unique_ptr<MsvDllCache> spDllCache(pOldDllCache ? new (std::nothrow) MsvDllCache(*pOldDllCache) : new (std::nothrow) MsvDllCache());
+	if (!spDllCache)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Create DLL object cache failed.");
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	//remove all entries of objects acquired from released DLL
+	spDllCache->Remove(pDll);
+
+	m_pDllCache.store(spDllCache.release());
+
+	//clear token slots of objects acquired from released DLL (tokens stay valid - DLL is loaded again on demand)
+	std::uint32_t tokenCount = m_tokenCount.load(std::memory_order_relaxed);
+	for (std::uint32_t index = 0; index < tokenCount; ++index)
+	{
+		//entries are replaced under factory lock only - slot entry can be read without read-side section here
+		MsvDllTokenSlot* pSlot = GetTokenSlot(MsvDllToken(index));
+		const MsvDllCacheEntry* pEntry = pSlot->GetEntry();
+		if (pEntry && pEntry->GetDll() == pDll)
+		{
+			pSlot->SetEntry(nullptr, m_reclaimer);
+		}
+	}
+
+	m_reclaimer.Retire(pOldDllCache);
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::WarmupDll(const std::string& dllPath, IMsvDll* pDll, const std::shared_ptr<IMsvDllDecorator>& spDecorator)
+{
+	std::shared_ptr<MsvDllWarmup> spWarmup(new (std::nothrow) MsvDllWarmup());
+	if (!spWarmup)
+	{
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	m_warmups[dllPath] = spWarmup;
+
+	//DLL is not held by warmup (it would block its release) - release waits for warmup instead
+	MsvErrorCode errorCode = m_warmer.Execute([this, dllPath, pDll, spDecorator, spWarmup]()
+	{
+		std::vector<const char*> dllAddressNames;
+		if (spDecorator)
+		{
+			spDecorator->GetDllAddressNames(dllAddressNames);
+		}
+		else
+		{
+			dllAddressNames.push_back("GetDllObject");
+		}
+
+		MSV_LOG_INFO(m_spLogger, "Warming up DLL library \"{}\".", dllPath);
+
+		MsvErrorCode warmupErrorCode = spWarmup->GetCancelled() ? MSV_NOT_ALLOWED_ERROR : pDll->WarmupDll(dllAddressNames, spWarmup->GetCancelled());
+		if (MSV_FAILED(warmupErrorCode) && !spWarmup->GetCancelled())
+		{
+			MSV_LOG_WARN(m_spLogger, "Warmup of DLL library \"{}\" failed with error: {}", dllPath, warmupErrorCode);
+		}
+
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+			std::map<std::string, std::shared_ptr<MsvDllWarmup>, std::less<>>::iterator it = m_warmups.find(dllPath);
+			if (it != m_warmups.end() && it->second == spWarmup)
+			{
+				m_warmups.erase(it);
+			}
+		}
+
+		spWarmup->Complete();
+	});
+
+	if (MSV_FAILED(errorCode))
+	{
+		m_warmups.erase(dllPath);
+		return errorCode;
+	}
+
+	return MSV_SUCCESS;
+}
+
+std::shared_ptr<MsvDllFactory::MsvDllWarmup> MsvDllFactory::CancelDllWarmup(const std::string& dllPath)
+{
+	std::map<std::string, std::shared_ptr<MsvDllWarmup>, std::less<>>::iterator it = m_warmups.find(dllPath);
+	if (it == m_warmups.end())
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<MsvDllWarmup> spWarmup = it->second;
+	m_warmups.erase(it);
+	spWarmup->Cancel();
+
+	return spWarmup;
+}
+
+MsvErrorCode MsvDllFactory::DetachDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDll>& spDll, std::shared_ptr<MsvDllWarmup>& spWarmup, std::shared_ptr<MsvDllPin>& spDllPin)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		std::shared_ptr<IMsvDllDecorator> spDecorator;
+		MSV_RETURN_FAILED(m_spDllList->GetDll(id, dllPath, spDecorator));
+
+		//we have DLL data -> check if is already loaded (in list)
+		std::map<std::string, std::shared_ptr<IMsvDll>, std::less<>>::iterator it = m_loadedDlls.find(dllPath);
+		if (it == m_loadedDlls.end())
+		{
+			MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has not been loaded.", id, dllPath);
+
+			//not in list (not loaded or already released) - just info
+			return MSV_NOT_FOUND_INFO;
+		}
+
+		//check if can unload DLL
+		if (it->second.use_count() > 1)
+		{
+			//DLL is holded by anyone else (can't release)
+			MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" (\"{}\") is hold by someone else (not only by DLL factory).", id, dllPath);
+			return MSV_NOT_ALLOWED_ERROR;
+		}
+
+		//check if its objects are not referenced (objects acquired by factory are counted exactly)
+		std::int64_t referenceCount = it->second->GetDllReferenceCount();
+		if (referenceCount > 0)
+		{
+			MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" (\"{}\") has referenced DLL objects - reference count: {}.", id, dllPath, referenceCount);
+			return MSV_NOT_ALLOWED_ERROR;
+		}
+
+		//check if its owned objects are not referenced (lock-free readers do not pin it since now)
+		std::map<const IMsvDll*, std::shared_ptr<MsvDllPin>>::iterator pinIt = m_dllPins.find(it->second.get());
+		std::int64_t pinCount = 0;
+		if (pinIt != m_dllPins.end() && !pinIt->second->Detach(pinCount))
+		{
+			MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" (\"{}\") is pinned by referenced DLL objects - pin count: {}.", id, dllPath, pinCount);
+			return MSV_NOT_ALLOWED_ERROR;
+		}
+
+		//remove its objects from cache first (lock-free readers must not get objects from unloaded DLL)
+		MsvErrorCode errorCode = UncacheDllObjects(it->second.get());
+		if (MSV_FAILED(errorCode))
+		{
+			if (pinIt != m_dllPins.end())
+			{
+				pinIt->second->CancelDetach();
+			}
+
+			return errorCode;
+		}
+
+		//detach DLL from factory - nobody else can get it now
+		spDll = it->second;
+		m_loadedDlls.erase(it);
+
+		//owned objects are released after grace period (readers might still use detached pin)
+		if (pinIt != m_dllPins.end())
+		{
+			spDllPin = pinIt->second;
+			m_dllPins.erase(pinIt);
+		}
+
+		//DLL must not be unloaded while it is being warmed up
+		spWarmup = CancelDllWarmup(dllPath);
+
+		//all thread caches are stale now (each thread clears its cache by next lookup)
+		++m_epoch;
+	}
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllFactory::UnloadDll(const char* id, const std::string& dllPath, const std::shared_ptr<IMsvDll>& spDll, const std::shared_ptr<MsvDllWarmup>& spWarmup, const std::shared_ptr<MsvDllPin>& spDllPin)
+{
+	//id and path are used by logs only (logging might be compiled out)
+	(void)id;
+	(void)dllPath;
+
+	if (spWarmup)
+	{
+		//cancelled warmup stops at next chunk of DLL code
+		MSV_LOG_INFO(m_spLogger, "Waiting for cancelled warmup of DLL library \"{}\" (\"{}\").", id, dllPath);
+		spWarmup->Wait();
+	}
+
+	//DLL is retired - wait for readers which might still use it (new readers can't get it)
+	m_reclaimer.Synchronize();
+
+	if (spDllPin)
+	{
+		//owned objects are destroyed by DLL code - DLL is still loaded
+		spDllPin->ReleaseDllObjects();
+	}
+
+	MSV_LOG_INFO(m_spLogger, "Uninitializing DLL library \"{}\" (\"{}\").", id, dllPath);
+
+	//uninitialize and unload DLL outside of factory lock (unloading one DLL does not block other DLLs)
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	MsvErrorCode errorCode = spDll->Uninitialize();
+	std::chrono::microseconds unloadTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+
+	{
+		std::lock_guard<std::mutex> lock(m_unloadLock);
+
+		++m_unloadedCount;
+		m_unloadTime += unloadTime;
+		m_maxUnloadTime = std::max(m_maxUnloadTime, unloadTime);
+	}
+
+	if (MSV_FAILED(errorCode))
+	{
+		//DLL has already been detached - its destructor tries to uninitialize it again
+		MSV_LOG_ERROR(m_spLogger, "Uninitialize DLL library \"{}\" (\"{}\") failed with error: {}", id, dllPath, errorCode);
+		return errorCode;
+	}
+
+	MSV_LOG_INFO(m_spLogger, "DLL library \"{}\" (\"{}\") has been successfully unitialized, unloaded and released in {} us.", id, dllPath, unloadTime.count());
+
+	return MSV_SUCCESS;
+}
+
+void MsvDllFactory::ShutdownDlls()
+{
+	std::map<std::string, std::shared_ptr<IMsvDll>, std::less<>> loadedDlls;
+	std::map<const IMsvDll*, std::shared_ptr<MsvDllPin>> dllPins;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+		loadedDlls.swap(m_loadedDlls);
+		dllPins.swap(m_dllPins);
+
+		//cached weak pointers to DLL objects must not outlive DLL code
+		const MsvDllCache* pOldDllCache = m_pDllCache.exchange(nullptr);
+
+		std::uint32_t tokenCount = m_tokenCount.load(std::memory_order_relaxed);
+		for (std::uint32_t index = 0; index < tokenCount; ++index)
+		{
+			GetTokenSlot(MsvDllToken(index))->SetEntry(nullptr, m_reclaimer);
+		}
+
+		m_reclaimer.Retire(pOldDllCache);
+	}
+
+	std::uint32_t policy = m_shutdownPolicy.load();
+	if (policy == MSV_DLL_SHUTDOWN_LEAK)
+	{
+		MSV_LOG_INFO(m_spLogger, "Detaching {} DLL libraries without unloading them.", loadedDlls.size());
+
+		for (std::map<std::string, std::shared_ptr<IMsvDll>, std::less<>>::iterator it = loadedDlls.begin(); it != loadedDlls.end(); ++it)
+		{
+			it->second->Detach();
+		}
+
+		//pins are leaked with theirs DLLs (pointers to owned objects might be released after factory is destroyed)
+		std::lock_guard<std::mutex> lock(g_leakedDllPinsLock);
+		static std::vector<std::shared_ptr<MsvDllPin>>* pLeakedDllPins = new (std::nothrow) std::vector<std::shared_ptr<MsvDllPin>>();
+		for (std::map<const IMsvDll*, std::shared_ptr<MsvDllPin>>::iterator it = dllPins.begin(); pLeakedDllPins && it != dllPins.end(); ++it)
+		{
+			pLeakedDllPins->push_back(it->second);
+		}
+	}
+	else
+	{
+		//owned objects are destroyed by DLL code - DLLs are still loaded
+		for (std::map<const IMsvDll*, std::shared_ptr<MsvDllPin>>::iterator it = dllPins.begin(); it != dllPins.end(); ++it)
+		{
+			it->second->ReleaseDllObjects();
+		}
+	}
+
+	if (policy == MSV_DLL_SHUTDOWN_PARALLEL && loadedDlls.size() > 1)
+	{
+		MSV_LOG_INFO(m_spLogger, "Unloading {} DLL libraries in parallel.", loadedDlls.size());
+
+		//DLLs are independent now (they have been detached from factory) - each one is uninitialized by one task
+		std::uint32_t threadCount = static_cast<std::uint32_t>(std::min(static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u)), loadedDlls.size()));
+		MsvDllExecutor teardown(threadCount);
+
+		for (std::map<std::string, std::shared_ptr<IMsvDll>, std::less<>>::iterator it = loadedDlls.begin(); it != loadedDlls.end(); ++it)
+		{
+			std::shared_ptr<IMsvDll> spDll = it->second;
+			if (MSV_FAILED(teardown.Execute([spDll]() { spDll->Uninitialize(); })))
+			{
+				spDll->Uninitialize();
+			}
+		}
+
+		teardown.Stop();
+	}
+
+	//ordered policy - DLLs are uninitialized one after another by theirs destructors (path order)
+	loadedDlls.clear();
+}
+
+MsvDllFactory::MsvDllTokenSlot* MsvDllFactory::GetTokenSlot(const MsvDllToken& token) const
+{
+	//token is valid when it has been published (index less then token count) - its chunk exists then
+	std::uint32_t index = token.GetIndex();
+	if (!token.Valid() || index >= m_tokenCount.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+
+	return &m_tokenChunks[index / MSV_DLL_TOKEN_CHUNK_SIZE][index % MSV_DLL_TOKEN_CHUNK_SIZE];
+}
+
+MsvDllThreadCache* MsvDllFactory::GetThreadCache()
+{
+	//thread caches of recently used factories (by instance id) - the most recently used one is the first one
+	static thread_local std::pair<std::uint64_t, std::unique_ptr<MsvDllThreadCache>> threadCaches[MSV_DLL_THREAD_CACHE_COUNT];
+
+	if (threadCaches[0].first == m_instanceId)
+	{
+		return threadCaches[0].second.get();
+	}
+
+	std::size_t index = 1;
+	while (index < MSV_DLL_THREAD_CACHE_COUNT && threadCaches[index].first != m_instanceId)
+	{
+		++index;
+	}
+
+	if (index == MSV_DLL_THREAD_CACHE_COUNT)
+	{
+		//replace least recently used thread cache (its factory might be destroyed already)
+		index = MSV_DLL_THREAD_CACHE_COUNT - 1;
+		threadCaches[index].first = 0;
+		threadCaches[index].second.reset(new (std::nothrow) MsvDllThreadCache());
+		if (!threadCaches[index].second)
+		{
+			MSV_LOG_ERROR(m_spLogger, "Create thread cache failed.");
+			return nullptr;
+		}
+
+		threadCaches[index].first = m_instanceId;
+	}
+
+	std::rotate(threadCaches, threadCaches + index, threadCaches + index + 1);
 
-	return errorCode;
+	return threadCaches[0].second.get();
 }
 
 
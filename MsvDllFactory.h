@@ -38,16 +38,82 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 #include "IMsvDllFactory.h"
 
 #include "IMsvDllList.h"
+#include "MsvDllExecutor.h"
+#include "MsvDllShutdownPolicy.h"
+#include "MsvDllSingleFlight.h"
+#include "MsvDllThreadCache.h"
 #include "mlogging/mlogging.h"
 
 MSV_DISABLE_ALL_WARNINGS
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 MSV_ENABLE_WARNINGS
 
 
+/**************************************************************************************************//**
+* @def			MSV_DLL_TOKEN_CHUNK_SIZE
+* @brief			Token chunk size.
+* @details		Count of token slots in one chunk of token table (chunks are never moved or freed while
+*					factory exists, so lock-free readers can index them).
+******************************************************************************************************/
+#define MSV_DLL_TOKEN_CHUNK_SIZE 256
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_TOKEN_CHUNK_COUNT
+* @brief			Token chunk count.
+* @details		Max count of chunks of token table (max count of tokens is MSV_DLL_TOKEN_CHUNK_SIZE * MSV_DLL_TOKEN_CHUNK_COUNT).
+******************************************************************************************************/
+#define MSV_DLL_TOKEN_CHUNK_COUNT 256
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_LOADER_THREAD_COUNT
+* @brief			Loader thread count.
+* @details		Max count of loader threads of factory (they acquire DLL objects for asynchronous requests).
+******************************************************************************************************/
+#define MSV_DLL_LOADER_THREAD_COUNT 4
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_WARMER_THREAD_COUNT
+* @brief			Warmer thread count.
+* @details		Max count of low priority threads of factory which warm up DLLs loaded with
+*					MSV_DLL_LOAD_WARMUP option.
+******************************************************************************************************/
+#define MSV_DLL_WARMER_THREAD_COUNT 1
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_REAPER_THREAD_COUNT
+* @brief			Reaper thread count.
+* @details		Max count of low priority threads of factory which unload DLLs released by ReleaseDllAsync.
+******************************************************************************************************/
+#define MSV_DLL_REAPER_THREAD_COUNT 1
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_READAHEAD_DEPTH
+* @brief			Readahead depth.
+* @details		Count of DLL files which are read to page cache ahead of loading threads of preload (disk
+*					reads of next DLLs overlap loads of current ones).
+******************************************************************************************************/
+#define MSV_DLL_READAHEAD_DEPTH 4
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_THREAD_CACHE_COUNT
+* @brief			Thread cache count.
+* @details		Count of thread caches kept by each thread (one per factory) - thread which uses up to
+*					this count of factories alternately keeps all theirs caches (least recently used one is
+*					replaced by cache of other factory).
+******************************************************************************************************/
+#define MSV_DLL_THREAD_CACHE_COUNT 4
+
+
 //forward declaration of MarsTech Dll Factory Dependency Injection Factory
 class MsvDllFactory_Factory;
 
@@ -88,6 +154,11 @@ public:
 	******************************************************************************************************/
 	MsvDllFactory& operator= (const MsvDllFactory& origin) = delete;
 
+	/**************************************************************************************************//**
+	* @brief			Virtual destructor.
+	******************************************************************************************************/
+	virtual ~MsvDllFactory();
+
 	/*-----------------------------------------------------------------------------------------------------
 	**											IMsvDllFactory public methods
 	**---------------------------------------------------------------------------------------------------*/
@@ -107,6 +178,117 @@ public:
 	******************************************************************************************************/
 	virtual MsvErrorCode ReleaseDll(const char* id) override;
 
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDll(const MsvDllId& id, std::shared_ptr<IMsvDll>& spDll)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const MsvDllId& id, std::shared_ptr<IMsvDll>& spDll) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDllObject(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObject(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::ReleaseDll(const MsvDllId& id)
+	******************************************************************************************************/
+	virtual MsvErrorCode ReleaseDll(const MsvDllId& id) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::Resolve(const char* id, MsvDllToken& token)
+	******************************************************************************************************/
+	virtual MsvErrorCode Resolve(const char* id, MsvDllToken& token) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::Resolve(const MsvDllId& id, MsvDllToken& token)
+	******************************************************************************************************/
+	virtual MsvErrorCode Resolve(const MsvDllId& id, MsvDllToken& token) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDllObject(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObject(const MsvDllToken& token, std::shared_ptr<IMsvDllObject>& spDllObject) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetRefCountedDllObject(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetRefCountedDllObject(const char* id, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetRefCountedDllObject(const MsvDllToken& token, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetRefCountedDllObject(const MsvDllToken& token, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::Preload(const std::vector<std::string>& ids, bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results)
+	* @note			Files of next DLLs are read to page cache ahead of loading threads (see @ref MSV_DLL_READAHEAD_DEPTH).
+	******************************************************************************************************/
+	virtual MsvErrorCode Preload(const std::vector<std::string>& ids, bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::Preload(bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results)
+	******************************************************************************************************/
+	virtual MsvErrorCode Preload(bool instantiate, std::uint32_t threadCount, std::vector<MsvDllPreloadResult>& results) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDllObjectAsync(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObjectAsync(const char* id, const MsvDllObjectCallback& callback, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDllObjectAsync(const char* id, std::future<MsvDllObjectResult>& future, std::chrono::steady_clock::time_point deadline)
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllObjectAsync(const char* id, std::future<MsvDllObjectResult>& future, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDllReclaimer()
+	******************************************************************************************************/
+	virtual MsvDllReclaimer& GetDllReclaimer() override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::ReleaseDllAsync(const char* id)
+	******************************************************************************************************/
+	virtual MsvErrorCode ReleaseDllAsync(const char* id) override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::WaitForDllUnloads()
+	******************************************************************************************************/
+	virtual void WaitForDllUnloads() override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllFactory::GetDllUnloadMetrics(std::uint32_t& pendingCount, std::uint64_t& unloadedCount, std::chrono::microseconds& unloadTime, std::chrono::microseconds& maxUnloadTime) const
+	******************************************************************************************************/
+	virtual void GetDllUnloadMetrics(std::uint32_t& pendingCount, std::uint64_t& unloadedCount, std::chrono::microseconds& unloadTime, std::chrono::microseconds& maxUnloadTime) const override;
+
+	/*-----------------------------------------------------------------------------------------------------
+	**											MsvDllFactory public methods
+	**---------------------------------------------------------------------------------------------------*/
+public:
+	/**************************************************************************************************//**
+	* @brief			Enable thread cache.
+	* @details		Enables/disables per thread cache of DLL objects in front of GetDllObject (it is disabled
+	*					by default). Repeated GetDllObject (by const char* or MsvDllId) on the same thread touches
+	*					thread local memory only then - when shared pointer already holds requested object,
+	*					even its reference count is not changed.
+	* @param[in]	enable				Flag if thread cache is enabled (true) or disabled (false).
+	* @note			Thread caches are invalidated by factory epoch (it is changed by each DLL load and release)
+	*					- each thread clears its cache by next GetDllObject, so cached objects never block release.
+	* @note			Each thread has one thread cache per factory (up to @ref MSV_DLL_THREAD_CACHE_COUNT
+	*					factories used alternately).
+	* @see			MsvDllThreadCache
+	******************************************************************************************************/
+	void EnableThreadCache(bool enable);
+
+	/**************************************************************************************************//**
+	* @brief			Set shutdown policy.
+	* @details		Sets how DLLs which are still loaded are released by destructor of factory (it is
+	*					@ref MSV_DLL_SHUTDOWN_ORDERED by default).
+	* @param[in]	policy				Shutdown policy.
+	* @note			@ref MSV_DLL_SHUTDOWN_LEAK is meant for process exit - DLLs are not unloaded, so
+	*					shutdown does not run theirs static destructors (process exit runs them).
+	* @see			MsvDllShutdownPolicy
+	******************************************************************************************************/
+	void SetShutdownPolicy(MsvDllShutdownPolicy policy);
+
 	/*-----------------------------------------------------------------------------------------------------
 	**											MsvDllFactory protected methods
 	**---------------------------------------------------------------------------------------------------*/
@@ -124,10 +306,628 @@ protected:
 	******************************************************************************************************/
 	MsvErrorCode GetDll(const char* id, std::shared_ptr<IMsvDll>& spDll, std::shared_ptr<IMsvDllDecorator>& spDecorator);
 
+	/**************************************************************************************************//**
+	* @brief			Acquire DLL object.
+	* @details		Slow path of GetDllObject - loads dynamic/shared library (if not already loaded), gets DLL
+	*					object from it and caches it.
+	* @param[in]	id										DLL (object) id.
+	* @param[in]	dllId									Binary DLL (object) id (it is invalid when id is not braced GUID).
+	* @param[out]	spDllObject							Shared pointer to acquired DLL object.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	MsvErrorCode AcquireDllObject(const char* id, const MsvDllId& dllId, std::shared_ptr<IMsvDllObject>& spDllObject);
+
+	/**************************************************************************************************//**
+	* @brief			Acquire reference counted DLL object.
+	* @details		Slow path of GetRefCountedDllObject - gets DLL object (the same one shared pointer path
+	*					returns), takes its ownership by pin of its DLL and caches it.
+	* @param[in]	id										DLL (object) id.
+	* @param[in]	dllId									Binary DLL (object) id (it is invalid when id is not braced GUID).
+	* @param[out]	dllObject							Pointer to acquired DLL object (it counts pin of its DLL).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	MsvErrorCode AcquireRefCountedDllObject(const char* id, const MsvDllId& dllId, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject);
+
+	/**************************************************************************************************//**
+	* @brief			Preload DLL.
+	* @details		Loads one DLL (see @ref Preload) and instantiates its objects (when requested).
+	* @param[in]	dllPath								Path to DLL.
+	* @param[in]	ids									DLL (object) ids which are in the DLL (with theirs decorators).
+	* @param[in]	instantiate							Flag if DLL objects of ids should be created too (true) or not (false).
+	* @returns		MsvDllPreloadResult				Preload result of the DLL.
+	* @note			It is called by preload threads concurrently (DLL is loaded outside of factory lock).
+	******************************************************************************************************/
+	MsvDllPreloadResult PreloadDll(const std::string& dllPath, const std::vector<std::pair<const char*, std::shared_ptr<IMsvDllDecorator>>>& ids, bool instantiate);
+
+	/**************************************************************************************************//**
+	* @brief			Get cached DLL object.
+	* @details		Lock-free lookup of already acquired DLL object in the published DLL object cache.
+	* @param[in]	id										DLL (object) id.
+	* @param[out]	spDllObject							Shared pointer to cached DLL object.
+	* @retval		MSV_NOT_FOUND_INFO				When DLL object is not cached or it has already expired (this is info, not error).
+	* @retval		MSV_SUCCESS							On success.
+	* @note			It does not lock any mutex - cache snapshot is read by one atomic pointer load inside
+	*					read-side section of @ref m_reclaimer (no reference count of snapshot is changed), only
+	*					reference count of found DLL object is incremented.
+	******************************************************************************************************/
+	MsvErrorCode GetCachedDllObject(const char* id, std::shared_ptr<IMsvDllObject>& spDllObject) const;
+
+	/**************************************************************************************************//**
+	* @brief			Get cached DLL object.
+	* @details		Lock-free lookup of already acquired DLL object in the published DLL object cache.
+	* @param[in]	id										Binary DLL (object) id.
+	* @param[out]	spDllObject							Shared pointer to cached DLL object.
+	* @retval		MSV_NOT_FOUND_INFO				When DLL object is not cached or it has already expired (this is info, not error).
+	* @retval		MSV_SUCCESS							On success.
+	* @note			It does not lock any mutex - cache snapshot is read by one atomic pointer load inside
+	*					read-side section of @ref m_reclaimer (no reference count of snapshot is changed), only
+	*					reference count of found DLL object is incremented.
+	******************************************************************************************************/
+	MsvErrorCode GetCachedDllObject(const MsvDllId& id, std::shared_ptr<IMsvDllObject>& spDllObject) const;
+
+	//forward declaration of DLL pin
+	class MsvDllPin;
+
+	/**************************************************************************************************//**
+	* @brief			Cache DLL object.
+	* @details		Publishes new version of DLL object cache which contains DLL object.
+	* @param[in]	id										DLL (object) id.
+	* @param[in]	dllId									Binary DLL (object) id (it is invalid when id is not braced GUID).
+	* @param[in]	pDll									Pointer to DLL the object has been acquired from.
+	* @param[in]	spDllObject							Shared pointer to DLL object.
+	* @param[in]	pDllPin								Pin of DLL which owns reference counted DLL object (nullptr when it is not owned).
+	* @param[in]	pRefCountedDllObject				Reference counted DLL object owned by pin (nullptr when it is not owned).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		Must be called with locked @ref m_lock (it is the only writer of DLL object cache).
+	******************************************************************************************************/
+	MsvErrorCode CacheDllObject(const char* id, const MsvDllId& dllId, const IMsvDll* pDll, const std::shared_ptr<IMsvDllObject>& spDllObject, MsvDllPin* pDllPin = nullptr, MsvDllRefCountedObject* pRefCountedDllObject = nullptr);
+
+	/**************************************************************************************************//**
+	* @brief			Remove DLL objects from cache.
+	* @details		Publishes new version of DLL object cache without objects acquired from DLL and clears
+	*					token slots of these objects.
+	* @param[in]	pDll									Pointer to DLL which objects will be removed.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		Must be called with locked @ref m_lock (it is the only writer of DLL object cache).
+	******************************************************************************************************/
+	MsvErrorCode UncacheDllObjects(const IMsvDll* pDll);
+
+	//forward declaration of DLL warmup
+	class MsvDllWarmup;
+
+	/**************************************************************************************************//**
+	* @brief			Warm up DLL.
+	* @details		Queues warmup of just loaded DLL to low priority warmer thread (see IMsvDll::WarmupDll).
+	*					Hot addresses are given by decorator (IMsvDllDecorator::GetDllAddressNames) or it is
+	*					GetDllObject function when there is no decorator.
+	* @param[in]	dllPath								Path to DLL.
+	* @param[in]	pDll									Pointer to loaded DLL (@ref ReleaseDll waits for warmup before DLL is released).
+	* @param[in]	spDecorator							Shared pointer to decorator of id which has loaded DLL.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When factory is being destroyed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	MsvErrorCode WarmupDll(const std::string& dllPath, IMsvDll* pDll, const std::shared_ptr<IMsvDllDecorator>& spDecorator);
+
+	/**************************************************************************************************//**
+	* @brief			Cancel DLL warmup.
+	* @details		Cancels warmup of DLL (when there is any) and removes it from running warmups.
+	* @param[in]	dllPath								Path to DLL.
+	* @returns		std::shared_ptr<MsvDllWarmup>	Shared pointer to cancelled warmup (nullptr when DLL is not being warmed up).
+	* @warning		Must be called with locked @ref m_lock. Returned warmup must be waited for outside of
+	*					lock before DLL is released.
+	******************************************************************************************************/
+	std::shared_ptr<MsvDllWarmup> CancelDllWarmup(const std::string& dllPath);
+
+	/**************************************************************************************************//**
+	* @brief			Detach DLL.
+	* @details		First part of DLL release - removes DLL and its objects from factory (nobody can get
+	*					them then), cancels its warmup and clears thread caches.
+	* @param[in]	id										DLL id.
+	* @param[out]	dllPath								Path to DLL.
+	* @param[out]	spDll									Shared pointer to detached DLL (it is the only one).
+	* @param[out]	spWarmup								Shared pointer to cancelled warmup of DLL (nullptr when DLL has not been warmed up).
+	* @param[out]	spDllPin								Shared pointer to detached pin of DLL (nullptr when factory does not own any its object).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When someone else holds shared pointer to dynamic/shared library or DLL is pinned.
+	* @retval		MSV_NOT_FOUND_INFO				When DLL library was not found in loaded DLLs(this is info, not error).
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	MsvErrorCode DetachDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDll>& spDll, std::shared_ptr<MsvDllWarmup>& spWarmup, std::shared_ptr<MsvDllPin>& spDllPin);
+
+	/**************************************************************************************************//**
+	* @brief			Unload DLL.
+	* @details		Second part of DLL release - waits for cancelled warmup and grace period of readers,
+	*					releases DLL objects owned by factory and uninitializes detached DLL (it is run by caller
+	*					or by reaper thread).
+	* @param[in]	id										DLL id.
+	* @param[in]	dllPath								Path to DLL.
+	* @param[in]	spDll									Shared pointer to detached DLL.
+	* @param[in]	spWarmup								Shared pointer to cancelled warmup of DLL (it might be nullptr).
+	* @param[in]	spDllPin								Shared pointer to detached pin of DLL (it might be nullptr).
+	* @retval		MSV_NOT_INITIALIZED_INFO		When DLL library has not been initialized (this is info, not error).
+	* @retval		MSV_CLOSE_ERROR					When unload DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		It must not be called with locked @ref m_lock.
+	******************************************************************************************************/
+	MsvErrorCode UnloadDll(const char* id, const std::string& dllPath, const std::shared_ptr<IMsvDll>& spDll, const std::shared_ptr<MsvDllWarmup>& spWarmup, const std::shared_ptr<MsvDllPin>& spDllPin);
+
+	/**************************************************************************************************//**
+	* @brief			Shutdown DLLs.
+	* @details		Releases all loaded DLLs by shutdown policy (see @ref SetShutdownPolicy).
+	* @warning		It is called by destructor only (no other thread uses factory).
+	******************************************************************************************************/
+	void ShutdownDlls();
+
+	/**************************************************************************************************//**
+	* @brief			Get thread cache.
+	* @details		Returns thread cache of calling thread for this factory (creates it when needed).
+	* @returns		MsvDllThreadCache*				Pointer to thread cache (nullptr when memory allocation failed).
+	******************************************************************************************************/
+	MsvDllThreadCache* GetThreadCache();
+
+	//forward declaration of token slot
+	class MsvDllTokenSlot;
+
+	/**************************************************************************************************//**
+	* @brief			Get token slot.
+	* @details		Returns slot of token table.
+	* @param[in]	token									DLL (object) token.
+	* @returns		MsvDllTokenSlot*					Pointer to token slot (nullptr when token is not valid token of this factory).
+	* @note			It does not lock any mutex (it loads published token count only) - entry of returned slot
+	*					is loaded by the caller.
+	******************************************************************************************************/
+	MsvDllTokenSlot* GetTokenSlot(const MsvDllToken& token) const;
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Object Cache Entry.
+	* @details	Immutable entry of DLL object cache - holds weak pointer to acquired DLL object and
+	*				DLL it has been acquired from. Reference counted DLL object owned by pin of its DLL is held
+	*				by raw pointer too (it is alive until the DLL is released).
+	******************************************************************************************************/
+	class MsvDllCacheEntry
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @param[in]	pDll							Pointer to DLL the object has been acquired from (used as identity only).
+		* @param[in]	spDllObject					Shared pointer to acquired DLL object.
+		* @param[in]	pDllPin						Pin of DLL which owns reference counted DLL object (nullptr when it is not owned).
+		* @param[in]	pRefCountedDllObject		Reference counted DLL object owned by pin (nullptr when it is not owned).
+		******************************************************************************************************/
+		MsvDllCacheEntry(const IMsvDll* pDll, const std::shared_ptr<IMsvDllObject>& spDllObject, MsvDllPin* pDllPin = nullptr, MsvDllRefCountedObject* pRefCountedDllObject = nullptr);
+
+		/**************************************************************************************************//**
+		* @brief			Deleted copy constructor.
+		* @details		Copy constructor deleted -> copying is not allowed.
+		* @param[in]	origin			Reference to copyied object.
+		* @warning		Do not copy this object.
+		******************************************************************************************************/
+		MsvDllCacheEntry(const MsvDllCacheEntry& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Deleted assign operator.
+		* @details		Assign operator deleted -> assign is not allowed.
+		* @param[in]	origin			Reference to assigned object.
+		* @warning		Do not assign this object.
+		******************************************************************************************************/
+		MsvDllCacheEntry& operator= (const MsvDllCacheEntry& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL.
+		* @details		Returns pointer to DLL the object has been acquired from.
+		* @returns		const IMsvDll*		Pointer to DLL (do not dereference it, it is identity only).
+		******************************************************************************************************/
+		const IMsvDll* GetDll() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL object.
+		* @details		Returns cached DLL object when it is still alive (DLL object owned by pin is returned
+		*					by shared pointer which holds pin of its DLL when its weak pointer has expired).
+		* @param[out]	spDllObject			Shared pointer to DLL object (nullptr when expired).
+		* @retval		true					When DLL object is alive.
+		* @retval		false					When DLL object has already expired.
+		******************************************************************************************************/
+		bool GetDllObject(std::shared_ptr<IMsvDllObject>& spDllObject) const;
+
+		/**************************************************************************************************//**
+		* @brief			Get reference counted DLL object.
+		* @details		Returns DLL object owned by pin of its DLL (see MsvDllPin::Acquire).
+		* @param[out]	dllObject			Pointer to DLL object (it counts pin of its DLL).
+		* @retval		true					When DLL object is owned by pin and DLL is not being detached.
+		* @retval		false					When DLL object is not owned by pin or DLL is being detached.
+		******************************************************************************************************/
+		bool GetDllObject(MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject) const;
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		DLL.
+		* @details	Pointer to DLL the object has been acquired from. It is used as identity only.
+		******************************************************************************************************/
+		const IMsvDll* m_pDll;
+
+		/**************************************************************************************************//**
+		* @brief		DLL object.
+		* @details	Weak pointer to acquired DLL object (cache does not hold DLL objects alive).
+		******************************************************************************************************/
+		std::weak_ptr<IMsvDllObject> m_wpDllObject;
+
+		/**************************************************************************************************//**
+		* @brief		DLL pin.
+		* @details	Pin of DLL which owns reference counted DLL object (nullptr when it is not owned). Pin
+		*				outlives all cache entries which point to it (it is released after grace period).
+		******************************************************************************************************/
+		MsvDllPin* m_pDllPin;
+
+		/**************************************************************************************************//**
+		* @brief		Reference counted DLL object.
+		* @details	DLL object owned by @ref m_pDllPin (nullptr when it is not owned).
+		******************************************************************************************************/
+		MsvDllRefCountedObject* m_pRefCountedDllObject;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Pin.
+	* @details	Host side pin of one loaded DLL - it owns reference counted DLL objects (one reference of
+	*				each) and counts pointers to them returned by factory. DLL is not released while pin count
+	*				is not zero. Pointers change pin count only (no lock, no shared pointer), readers increment
+	*				it before they check detaching flag and release sets detaching flag before it checks
+	*				pin count - one of them always sees the other one.
+	******************************************************************************************************/
+	class MsvDllPin
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		******************************************************************************************************/
+		MsvDllPin();
+
+		/**************************************************************************************************//**
+		* @brief			Deleted copy constructor.
+		* @details		Copy constructor deleted -> copying is not allowed.
+		* @param[in]	origin			Reference to copyied object.
+		* @warning		Do not copy this object.
+		******************************************************************************************************/
+		MsvDllPin(const MsvDllPin& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Deleted assign operator.
+		* @details		Assign operator deleted -> assign is not allowed.
+		* @param[in]	origin			Reference to assigned object.
+		* @warning		Do not assign this object.
+		******************************************************************************************************/
+		MsvDllPin& operator= (const MsvDllPin& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Own DLL object.
+		* @details		Takes one reference of DLL object (it is owned until DLL objects are released). Object
+		*					which is already owned is not owned twice.
+		* @param[in]	pDllObject			Reference counted DLL object.
+		* @warning		Must be called with locked factory lock.
+		******************************************************************************************************/
+		void Own(MsvDllRefCountedObject* pDllObject);
+
+		/**************************************************************************************************//**
+		* @brief			Acquire DLL object.
+		* @details		Returns pointer to owned DLL object which counts this pin - pin count is incremented
+		*					first and then detaching flag is checked (pin is not acquired when DLL is being
+		*					detached).
+		* @param[in]	pDllObject			Reference counted DLL object owned by this pin.
+		* @param[out]	dllObject			Pointer to DLL object (it counts this pin).
+		* @retval		true					When pin has been acquired.
+		* @retval		false					When DLL is being detached.
+		******************************************************************************************************/
+		bool Acquire(MsvDllRefCountedObject* pDllObject, MsvDllObjectPtr<MsvDllRefCountedObject>& dllObject);
+
+		/**************************************************************************************************//**
+		* @brief			Detach pin.
+		* @details		Sets detaching flag first and then checks pin count (flag is cleared again when DLL is
+		*					pinned).
+		* @param[out]	pinCount				Pin count (count of pointers returned by factory).
+		* @retval		true					When DLL is not pinned (new pointers are not returned since now).
+		* @retval		false					When DLL is pinned.
+		* @warning		Must be called with locked factory lock.
+		******************************************************************************************************/
+		bool Detach(std::int64_t& pinCount);
+
+		/**************************************************************************************************//**
+		* @brief			Cancel detach.
+		* @details		Clears detaching flag (DLL stays loaded).
+		* @warning		Must be called with locked factory lock.
+		******************************************************************************************************/
+		void CancelDetach();
+
+		/**************************************************************************************************//**
+		* @brief			Release DLL objects.
+		* @details		Releases references of owned DLL objects (DLL code destroys them, so DLL must be still
+		*					loaded).
+		* @warning		It must be called after grace period of detached pin (no reader uses it anymore).
+		******************************************************************************************************/
+		void ReleaseDllObjects();
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		Pin count.
+		* @details	Count of pointers returned by factory (pointers change it directly).
+		******************************************************************************************************/
+		std::atomic<std::int64_t> m_pinCount;
+
+		/**************************************************************************************************//**
+		* @brief		Detaching flag.
+		* @details	Flag if DLL is being detached (true) or not (false).
+		******************************************************************************************************/
+		std::atomic<bool> m_detaching;
+
+		/**************************************************************************************************//**
+		* @brief		DLL objects.
+		* @details	Owned reference counted DLL objects (pointers which count references of objects).
+		******************************************************************************************************/
+		std::vector<MsvDllObjectPtr<MsvDllRefCountedObject>> m_dllObjects;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Token Slot.
+	* @details	One slot of token table - holds DLL (object) id and cache entry of acquired DLL object.
+	*				Id is set once (before token is published), cache entry is owned by slot and it is published
+	*				by raw atomic pointer (replaced entries are retired to DLL reclaimer).
+	******************************************************************************************************/
+	class MsvDllTokenSlot
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		******************************************************************************************************/
+		MsvDllTokenSlot();
+
+		/**************************************************************************************************//**
+		* @brief			Destructor.
+		* @details		Deletes current cache entry (there are no readers anymore).
+		******************************************************************************************************/
+		~MsvDllTokenSlot();
+
+		/**************************************************************************************************//**
+		* @brief			Deleted copy constructor.
+		* @details		Copy constructor deleted -> copying is not allowed.
+		* @param[in]	origin			Reference to copyied object.
+		* @warning		Do not copy this object.
+		******************************************************************************************************/
+		MsvDllTokenSlot(const MsvDllTokenSlot& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Deleted assign operator.
+		* @details		Assign operator deleted -> assign is not allowed.
+		* @param[in]	origin			Reference to assigned object.
+		* @warning		Do not assign this object.
+		******************************************************************************************************/
+		MsvDllTokenSlot& operator= (const MsvDllTokenSlot& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Set id.
+		* @details		Sets DLL (object) id of slot.
+		* @param[in]	id					DLL (object) id.
+		* @param[in]	dllId				Binary DLL (object) id (it is invalid when id is not braced GUID).
+		* @warning		Must be called before token is published (it is not thread safe).
+		******************************************************************************************************/
+		void SetId(const char* id, const MsvDllId& dllId);
+
+		/**************************************************************************************************//**
+		* @brief			Get id.
+		* @returns		const char*			DLL (object) id.
+		******************************************************************************************************/
+		const char* GetId() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get binary id.
+		* @returns		const MsvDllId&	Binary DLL (object) id (it is invalid when id is not braced GUID).
+		******************************************************************************************************/
+		const MsvDllId& GetDllId() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get cache entry.
+		* @details		Atomically loads cache entry of acquired DLL object (one pointer load).
+		* @returns		const MsvDllCacheEntry*		Cache entry (nullptr when DLL object has not been acquired or DLL has been released).
+		* @warning		Entry must be used inside read-side section of reclaimer it is retired to (or by writer
+		*					which replaces entries).
+		******************************************************************************************************/
+		const MsvDllCacheEntry* GetEntry() const;
+
+		/**************************************************************************************************//**
+		* @brief			Set cache entry.
+		* @details		Atomically publishes cache entry of acquired DLL object (slot takes its ownership) and
+		*					retires replaced one.
+		* @param[in]	pEntry			Cache entry (nullptr to clear it).
+		* @param[in]	reclaimer		Reclaimer which deletes replaced entry when its readers are gone.
+		* @warning		Writers must be serialized (by factory lock).
+		******************************************************************************************************/
+		void SetEntry(const MsvDllCacheEntry* pEntry, MsvDllReclaimer& reclaimer);
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		DLL (object) id.
+		* @details	DLL (object) id exactly as it was resolved.
+		******************************************************************************************************/
+		std::string m_id;
+
+		/**************************************************************************************************//**
+		* @brief		Binary DLL (object) id.
+		* @details	It is invalid when id is not braced GUID.
+		******************************************************************************************************/
+		MsvDllId m_dllId;
+
+		/**************************************************************************************************//**
+		* @brief		Cache entry.
+		* @details	Cache entry of acquired DLL object owned by slot (readers load it inside read-side section).
+		******************************************************************************************************/
+		std::atomic<const MsvDllCacheEntry*> m_pEntry;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Object Cache.
+	* @details	Maps DLL (object) id to cache entry. Entries are stored by string id (transparent comparator,
+	*				so lookup by const char* id does not allocate temporary std::string key nor parse the id) and
+	*				braced GUID ids also by binary id (hashed, for lookups by @ref MsvDllId).
+	* @see		MsvDllCacheEntry
+	******************************************************************************************************/
+	class MsvDllCache
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Find cache entry.
+		* @param[in]	id					DLL (object) id (exactly as it was requested).
+		* @returns		const MsvDllCacheEntry*		Pointer to cache entry (nullptr when not found).
+		******************************************************************************************************/
+		const MsvDllCacheEntry* Find(const char* id) const;
+
+		/**************************************************************************************************//**
+		* @brief			Find cache entry.
+		* @param[in]	id					Binary DLL (object) id.
+		* @returns		const MsvDllCacheEntry*		Pointer to cache entry (nullptr when not found).
+		******************************************************************************************************/
+		const MsvDllCacheEntry* Find(const MsvDllId& id) const;
+
+		/**************************************************************************************************//**
+		* @brief			Insert cache entry.
+		* @details		Inserts cache entry by string id and also by binary id when it is valid (replaces
+		*					existing ones with the same id).
+		* @param[in]	id					DLL (object) id.
+		* @param[in]	dllId				Binary DLL (object) id (it is invalid when id is not braced GUID).
+		* @param[in]	spEntry			Shared pointer to cache entry.
+		******************************************************************************************************/
+		void Insert(const char* id, const MsvDllId& dllId, const std::shared_ptr<const MsvDllCacheEntry>& spEntry);
+
+		/**************************************************************************************************//**
+		* @brief			Remove cache entries.
+		* @details		Removes all entries of objects acquired from DLL.
+		* @param[in]	pDll				Pointer to DLL which objects will be removed.
+		******************************************************************************************************/
+		void Remove(const IMsvDll* pDll);
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		DLL objects by name.
+		* @details	Cache entries of all DLL objects by string id.
+		******************************************************************************************************/
+		std::map<std::string, std::shared_ptr<const MsvDllCacheEntry>, std::less<>> m_dllObjectsByName;
+
+		/**************************************************************************************************//**
+		* @brief		DLL objects by id.
+		* @details	Cache entries of DLL objects which ids are braced GUIDs.
+		******************************************************************************************************/
+		std::unordered_map<MsvDllId, std::shared_ptr<const MsvDllCacheEntry>> m_dllObjectsById;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Object Request.
+	* @details	Asynchronous DLL object request - it is completed by loader thread (DLL object has been
+	*				acquired) or by timer thread (deadline), whichever is the first.
+	******************************************************************************************************/
+	class MsvDllObjectRequest
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @param[in]	callback				Completion callback.
+		******************************************************************************************************/
+		MsvDllObjectRequest(const MsvDllObjectCallback& callback);
+
+		/**************************************************************************************************//**
+		* @brief			Complete request.
+		* @details		Calls completion callback when request has not been completed yet.
+		* @param[in]	errorCode			Request error code.
+		* @param[in]	spDllObject			Shared pointer to acquired DLL object.
+		******************************************************************************************************/
+		void Complete(MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>& spDllObject);
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		Completed flag.
+		* @details	Flag if request has been completed (true) or not (false).
+		******************************************************************************************************/
+		std::atomic<bool> m_completed;
+
+		/**************************************************************************************************//**
+		* @brief		Callback.
+		* @details	Completion callback.
+		******************************************************************************************************/
+		MsvDllObjectCallback m_callback;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Warmup.
+	* @details	Background warmup of one DLL - it is cancelled by release of DLL (or by destruction of
+	*				factory) and released DLL is unloaded when it has been completed.
+	******************************************************************************************************/
+	class MsvDllWarmup
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		******************************************************************************************************/
+		MsvDllWarmup();
+
+		/**************************************************************************************************//**
+		* @brief			Cancel warmup.
+		* @details		Warmup stops at next chunk (it is not completed immediately).
+		******************************************************************************************************/
+		void Cancel();
+
+		/**************************************************************************************************//**
+		* @brief			Get cancel flag.
+		* @returns		const std::atomic<bool>&		Cancel flag (it is checked by warmup between chunks).
+		******************************************************************************************************/
+		const std::atomic<bool>& GetCancelled() const;
+
+		/**************************************************************************************************//**
+		* @brief			Complete warmup.
+		* @details		Wakes up waiting threads (DLL is not used by warmup anymore).
+		******************************************************************************************************/
+		void Complete();
+
+		/**************************************************************************************************//**
+		* @brief			Wait for warmup.
+		* @details		Waits until warmup is completed.
+		******************************************************************************************************/
+		void Wait();
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		Cancel flag.
+		* @details	Flag if warmup has been cancelled (true) or not (false).
+		******************************************************************************************************/
+		std::atomic<bool> m_cancelled;
+
+		/**************************************************************************************************//**
+		* @brief		Warmup mutex.
+		* @details	Locks completed flag.
+		******************************************************************************************************/
+		std::mutex m_lock;
+
+		/**************************************************************************************************//**
+		* @brief		Completed condition.
+		* @details	Wakes up threads waiting for warmup.
+		******************************************************************************************************/
+		std::condition_variable m_completedCondition;
+
+		/**************************************************************************************************//**
+		* @brief		Completed flag.
+		* @details	Flag if warmup has been completed (true) or not (false).
+		******************************************************************************************************/
+		bool m_completed;
+	};
+
 protected:
 	/**************************************************************************************************//**
 	* @brief		Thread pool mutex.
-	* @details	Locks this object for thread safety access.
+	* @details	Locks DLL tables of this object for thread safety access.
+	* @note		It is never held while a DLL is being loaded, initialized or unloaded - each DLL is
+	*				loaded by single thread (see @ref m_loadingDlls), so slow DLL does not block other DLLs.
 	******************************************************************************************************/
 	mutable std::recursive_mutex m_lock;
 
@@ -136,7 +936,90 @@ protected:
 	* @details	Stored shared pointers to loaded DLLs (each library is loaded only once).
 	* @see		IMsvDll
 	******************************************************************************************************/
-	std::map<std::string, std::shared_ptr<IMsvDll>> m_loadedDlls;
+	std::map<std::string, std::shared_ptr<IMsvDll>, std::less<>> m_loadedDlls;
+
+	/**************************************************************************************************//**
+	* @brief		Loading DLLs.
+	* @details	DLLs which are being loaded right now (each library is loaded by one thread only, other
+	*				threads wait for its result).
+	* @see		MsvDllSingleFlight
+	******************************************************************************************************/
+	MsvDllSingleFlight<std::shared_ptr<IMsvDll>> m_loadingDlls;
+
+	/**************************************************************************************************//**
+	* @brief		DLL warmups.
+	* @details	Queued and running warmups of loaded DLLs (by DLL path).
+	* @see		WarmupDll
+	******************************************************************************************************/
+	std::map<std::string, std::shared_ptr<MsvDllWarmup>, std::less<>> m_warmups;
+
+	/**************************************************************************************************//**
+	* @brief		DLL pins.
+	* @details	Pins of loaded DLLs which reference counted objects are owned by factory (by DLL).
+	* @see		MsvDllPin
+	******************************************************************************************************/
+	std::map<const IMsvDll*, std::shared_ptr<MsvDllPin>> m_dllPins;
+
+	/**************************************************************************************************//**
+	* @brief		DLL object cache.
+	* @details	Immutable snapshot of already acquired DLL objects. Readers load raw pointer inside read-side
+	*				section of @ref m_reclaimer, writers (holding @ref m_lock) copy it, modify the copy, publish it
+	*				and retire old snapshot to @ref m_reclaimer (it is deleted after grace period).
+	* @see		GetCachedDllObject
+	* @see		CacheDllObject
+	* @see		UncacheDllObjects
+	******************************************************************************************************/
+	std::atomic<const MsvDllCache*> m_pDllCache;
+
+	/**************************************************************************************************//**
+	* @brief		Resolved tokens.
+	* @details	Maps resolved DLL (object) id to token index.
+	* @see		Resolve
+	******************************************************************************************************/
+	std::map<std::string, std::uint32_t, std::less<>> m_tokens;
+
+	/**************************************************************************************************//**
+	* @brief		Token table.
+	* @details	Dense table of token slots split to chunks (chunks are allocated on demand and never moved,
+	*				so lock-free readers can index them while new tokens are being resolved).
+	* @see		MsvDllTokenSlot
+	******************************************************************************************************/
+	std::unique_ptr<MsvDllTokenSlot[]> m_tokenChunks[MSV_DLL_TOKEN_CHUNK_COUNT];
+
+	/**************************************************************************************************//**
+	* @brief		Token count.
+	* @details	Count of resolved tokens - it is stored (release) after token slot has been initialized,
+	*				so token is valid when its index is less then loaded (acquire) count.
+	******************************************************************************************************/
+	std::atomic<std::uint32_t> m_tokenCount;
+
+	/**************************************************************************************************//**
+	* @brief		Factory instance id.
+	* @details	Unique id of this factory (thread cache of other factory is not used even when this
+	*				factory has the same address).
+	******************************************************************************************************/
+	const std::uint64_t m_instanceId;
+
+	/**************************************************************************************************//**
+	* @brief		Factory epoch.
+	* @details	It is changed by each DLL load and release - thread caches cached in other epoch are stale.
+	* @see		MsvDllThreadCache
+	******************************************************************************************************/
+	std::atomic<std::uint64_t> m_epoch;
+
+	/**************************************************************************************************//**
+	* @brief		Thread cache flag.
+	* @details	Flag if thread cache is enabled (true) or disabled (false).
+	* @see		EnableThreadCache
+	******************************************************************************************************/
+	std::atomic<bool> m_threadCacheEnabled;
+
+	/**************************************************************************************************//**
+	* @brief		Shutdown policy.
+	* @details	Policy of DLLs release by destructor (see @ref MsvDllShutdownPolicy).
+	* @see		SetShutdownPolicy
+	******************************************************************************************************/
+	std::atomic<std::uint32_t> m_shutdownPolicy;
 
 	/**************************************************************************************************//**
 	* @brief		DLL list.
@@ -157,6 +1040,72 @@ protected:
 	* @details	Shared pointer to logger for logging.
 	******************************************************************************************************/
 	std::shared_ptr<MsvLogger> m_spLogger;
+
+	/**************************************************************************************************//**
+	* @brief		Loader.
+	* @details	Executor of asynchronous requests (it is stopped first in destructor - its tasks use factory).
+	* @see		GetDllObjectAsync
+	******************************************************************************************************/
+	MsvDllExecutor m_loader;
+
+	/**************************************************************************************************//**
+	* @brief		Warmer.
+	* @details	Low priority executor of DLL warmups (its tasks use factory and loaded DLLs).
+	* @see		WarmupDll
+	******************************************************************************************************/
+	MsvDllExecutor m_warmer;
+
+	/**************************************************************************************************//**
+	* @brief		Reclaimer.
+	* @details	Grace periods of released DLLs (they are unloaded when all readers which might use them
+	*				are gone).
+	* @see		GetDllReclaimer
+	******************************************************************************************************/
+	mutable MsvDllReclaimer m_reclaimer;
+
+	/**************************************************************************************************//**
+	* @brief		Reaper.
+	* @details	Low priority executor of asynchronous DLL unloads (its tasks use factory).
+	* @see		ReleaseDllAsync
+	******************************************************************************************************/
+	MsvDllExecutor m_reaper;
+
+	/**************************************************************************************************//**
+	* @brief		Unload lock.
+	* @details	Locks pending unload count and unload metrics.
+	******************************************************************************************************/
+	mutable std::mutex m_unloadLock;
+
+	/**************************************************************************************************//**
+	* @brief		Unload condition.
+	* @details	Notified when pending unload is finished.
+	* @see		WaitForDllUnloads
+	******************************************************************************************************/
+	std::condition_variable m_unloadCondition;
+
+	/**************************************************************************************************//**
+	* @brief		Pending unload count.
+	* @details	Count of DLLs released asynchronously which have not been unloaded yet.
+	******************************************************************************************************/
+	std::uint32_t m_pendingUnloadCount;
+
+	/**************************************************************************************************//**
+	* @brief		Unloaded count.
+	* @details	Count of unloaded DLLs.
+	******************************************************************************************************/
+	std::uint64_t m_unloadedCount;
+
+	/**************************************************************************************************//**
+	* @brief		Unload time.
+	* @details	Total time of DLL unloads.
+	******************************************************************************************************/
+	std::chrono::microseconds m_unloadTime;
+
+	/**************************************************************************************************//**
+	* @brief		Max unload time.
+	* @details	Longest DLL unload.
+	******************************************************************************************************/
+	std::chrono::microseconds m_maxUnloadTime;
 };
 
 
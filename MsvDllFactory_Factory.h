@@ -39,6 +39,7 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 #include "mdi/MdiFactory.h"
 
 #include "MsvDll.h"
+#include "MsvDllAdapter.h"
 
 
 /**************************************************************************************************//**
@@ -48,6 +49,7 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************************************/
 MSV_FACTORY_START(MsvDllFactory_Factory)
 MSV_FACTORY_GET_1(IMsvDll, MsvDll, std::shared_ptr<MsvLogger>);
+MSV_FACTORY_GET_1(IMsvDllAdapter, MsvDllAdapter, std::shared_ptr<MsvLogger>);
 MSV_FACTORY_END
 
 
@@ -0,0 +1,285 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Id
+* @details		Contains definition of @ref MsvDllId.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLID_H
+#define MARSTECH_DLLID_H
+
+
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_ID_STRING_SIZE
+* @brief			DLL id string size.
+* @details		Size of buffer for braced GUID string (including terminating null character).
+******************************************************************************************************/
+#define MSV_DLL_ID_STRING_SIZE 39
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Id.
+* @details	Binary (128-bit) representation of braced GUID DLL id (for example
+*				"{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"). GUID string is parsed only once, then the id
+*				is compared and hashed in a couple of instructions.
+* @note		Hex digits are case insensitive. Ids which are not braced GUIDs are invalid (nil GUID is
+*				reserved as invalid id too) - such ids are still supported by const char* methods.
+* @note		It is constexpr, so ids known at compile time are parsed by compiler.
+******************************************************************************************************/
+class MsvDllId
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates invalid (nil) id.
+	******************************************************************************************************/
+	constexpr MsvDllId():
+		m_high(0),
+		m_low(0)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates id from its binary representation.
+	* @param[in]	high				High 64 bits of GUID.
+	* @param[in]	low				Low 64 bits of GUID.
+	******************************************************************************************************/
+	constexpr MsvDllId(std::uint64_t high, std::uint64_t low):
+		m_high(high),
+		m_low(low)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Parses braced GUID string. Creates invalid (nil) id when id is not braced GUID.
+	* @param[in]	id					Braced GUID string.
+	******************************************************************************************************/
+	constexpr explicit MsvDllId(const char* id):
+		m_high(0),
+		m_low(0)
+	{
+		if (!Parse(id, m_high, m_low))
+		{
+			m_high = 0;
+			m_low = 0;
+		}
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Valid check.
+	* @details		Returns flag if id is valid GUID (true) or not (false).
+	* @retval		true		When valid.
+	* @retval		false		When invalid (nil).
+	******************************************************************************************************/
+	constexpr bool Valid() const
+	{
+		return m_high != 0 || m_low != 0;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get hash.
+	* @details		Returns hash of id (GUIDs are random, so it just mixes both halves).
+	* @returns		std::size_t		Hash of id.
+	******************************************************************************************************/
+	constexpr std::size_t Hash() const
+	{
+		return static_cast<std::size_t>(m_high ^ (m_low * 0x9E3779B97F4A7C15ull));
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Convert to string.
+	* @details		Formats id as canonical (upper case) braced GUID string.
+	* @param[out]	id					Buffer for braced GUID string.
+	* @returns		const char*		Pointer to buffer.
+	******************************************************************************************************/
+	const char* ToString(char (&id)[MSV_DLL_ID_STRING_SIZE]) const
+	{
+		const char* hexDigits = "0123456789ABCDEF";
+		std::size_t digit = 0;
+
+		id[0] = '{';
+		for (std::size_t i = 1; i < MSV_DLL_ID_STRING_SIZE - 2; ++i)
+		{
+			if (i == 9 || i == 14 || i == 19 || i == 24)
+			{
+				id[i] = '-';
+				continue;
+			}
+
+			std::uint64_t half = digit < 16 ? m_high : m_low;
+			id[i] = hexDigits[(half >> ((15 - (digit % 16)) * 4)) & 0xF];
+			++digit;
+		}
+		id[MSV_DLL_ID_STRING_SIZE - 2] = '}';
+		id[MSV_DLL_ID_STRING_SIZE - 1] = '\0';
+
+		return id;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Equal operator.
+	* @param[in]	other				Compared id.
+	* @retval		true				When ids are equal.
+	* @retval		false				When ids are not equal.
+	******************************************************************************************************/
+	constexpr bool operator== (const MsvDllId& other) const
+	{
+		return m_high == other.m_high && m_low == other.m_low;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Not equal operator.
+	* @param[in]	other				Compared id.
+	* @retval		true				When ids are not equal.
+	* @retval		false				When ids are equal.
+	******************************************************************************************************/
+	constexpr bool operator!= (const MsvDllId& other) const
+	{
+		return !(*this == other);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Less operator.
+	* @param[in]	other				Compared id.
+	* @retval		true				When this id is less then other id.
+	* @retval		false				Otherwise.
+	******************************************************************************************************/
+	constexpr bool operator< (const MsvDllId& other) const
+	{
+		return m_high < other.m_high || (m_high == other.m_high && m_low < other.m_low);
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief			Parse GUID.
+	* @details		Parses braced GUID string "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}".
+	* @param[in]	id					Braced GUID string.
+	* @param[out]	high				High 64 bits of GUID.
+	* @param[out]	low				Low 64 bits of GUID.
+	* @retval		true				When id is braced GUID.
+	* @retval		false				When id is not braced GUID.
+	******************************************************************************************************/
+	static constexpr bool Parse(const char* id, std::uint64_t& high, std::uint64_t& low)
+	{
+		//check it in order - first mismatch stops it, so shorter strings are not read out of bounds (terminating null character is not hex digit)
+		std::uint64_t part1 = 0, part2 = 0, part3 = 0, part4 = 0, part5 = 0;
+		if (!id || id[0] != '{' || !ParseHex(id + 1, 8, part1) || id[9] != '-' || !ParseHex(id + 10, 4, part2) || id[14] != '-' || !ParseHex(id + 15, 4, part3) ||
+			id[19] != '-' || !ParseHex(id + 20, 4, part4) || id[24] != '-' || !ParseHex(id + 25, 12, part5) || id[37] != '}' || id[38] != '\0')
+		{
+			return false;
+		}
+
+		high = (part1 << 32) | (part2 << 16) | part3;
+		low = (part4 << 48) | part5;
+
+		return high != 0 || low != 0;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Parse hex number.
+	* @param[in]	hex				Hex digits (case insensitive).
+	* @param[in]	count				Count of hex digits.
+	* @param[out]	value				Parsed number.
+	* @retval		true				When all chars are hex digits.
+	* @retval		false				When any char is not hex digit.
+	******************************************************************************************************/
+	static constexpr bool ParseHex(const char* hex, std::size_t count, std::uint64_t& value)
+	{
+		std::uint64_t result = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			std::uint32_t digit = static_cast<std::uint32_t>(static_cast<unsigned char>(hex[i])) - '0';
+			if (digit > 9)
+			{
+				//lower case letter (0x20 bit) maps to upper case, then 'A' - 'F' maps to 10 - 15
+				digit = (static_cast<std::uint32_t>(static_cast<unsigned char>(hex[i])) | 0x20) - 'a' + 10;
+				if (digit < 10 || digit > 15)
+				{
+					return false;
+				}
+			}
+
+			result = (result << 4) | digit;
+		}
+
+		value = result;
+
+		return true;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		High part.
+	* @details	High 64 bits of GUID.
+	******************************************************************************************************/
+	std::uint64_t m_high;
+
+	/**************************************************************************************************//**
+	* @brief		Low part.
+	* @details	Low 64 bits of GUID.
+	******************************************************************************************************/
+	std::uint64_t m_low;
+};
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Id hash.
+* @details	Specialization of std::hash for @ref MsvDllId (it can be used as key of unordered containers).
+******************************************************************************************************/
+namespace std
+{
+	template<>
+	struct hash<MsvDllId>
+	{
+		std::size_t operator()(const MsvDllId& dllId) const
+		{
+			return dllId.Hash();
+		}
+	};
+}
+
+
+#endif // MARSTECH_DLLID_H
+
+/** @} */	//End of group MDLLFACTORY.
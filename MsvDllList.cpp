@@ -35,23 +35,218 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 #include "merror/MsvErrorCodes.h"
 
+MSV_DISABLE_ALL_WARNINGS
+
+#include <algorithm>
+#include <cstring>
+
+MSV_ENABLE_WARNINGS
+
 
 /********************************************************************************************************************************
 *															IMsvDllList::MsvDllData implementation
 ********************************************************************************************************************************/
 
 
-MsvDllList::MsvDllData::MsvDllData(const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator):
+MsvDllList::MsvDllData::MsvDllData(const std::string& dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator, MsvDllLoadOptions loadOptions):
 	m_dllPath(dllPath),
-	m_spDllDecorator(spDllDecorator)
+	m_spDllDecorator(spDllDecorator),
+	m_loadOptions(loadOptions)
 {
 
 }
 
-void MsvDllList::MsvDllData::GetDllData(std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const
+void MsvDllList::MsvDllData::GetDllData(std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
 {
 	dllPath.assign(m_dllPath);
 	spDllDecorator = m_spDllDecorator;
+	loadOptions = m_loadOptions;
+}
+
+const std::string& MsvDllList::MsvDllData::GetDllPath() const
+{
+	return m_dllPath;
+}
+
+const std::shared_ptr<IMsvDllDecorator>& MsvDllList::MsvDllData::GetDllDecorator() const
+{
+	return m_spDllDecorator;
+}
+
+MsvDllLoadOptions MsvDllList::MsvDllData::GetLoadOptions() const
+{
+	return m_loadOptions;
+}
+
+
+/********************************************************************************************************************************
+*															IMsvDllList::MsvDllSealedData implementation
+********************************************************************************************************************************/
+
+
+MsvDllList::MsvDllSealedData::MsvDllSealedData(std::uint32_t dllPathOffset, std::uint32_t decoratorIndex, MsvDllLoadOptions loadOptions):
+	m_dllPathOffset(dllPathOffset),
+	m_decoratorIndex(decoratorIndex),
+	m_loadOptions(loadOptions)
+{
+
+}
+
+std::uint32_t MsvDllList::MsvDllSealedData::GetDllPathOffset() const
+{
+	return m_dllPathOffset;
+}
+
+std::uint32_t MsvDllList::MsvDllSealedData::GetDecoratorIndex() const
+{
+	return m_decoratorIndex;
+}
+
+MsvDllLoadOptions MsvDllList::MsvDllSealedData::GetLoadOptions() const
+{
+	return m_loadOptions;
+}
+
+
+/********************************************************************************************************************************
+*															IMsvDllList::MsvDllSnapshot implementation
+********************************************************************************************************************************/
+
+
+MsvDllList::MsvDllSnapshot::MsvDllSnapshot()
+{
+
+}
+
+std::size_t MsvDllList::MsvDllSnapshot::Build(const std::unordered_map<MsvDllId, std::shared_ptr<MsvDllData>>& dllIds, const std::map<std::string, std::shared_ptr<MsvDllData>, std::less<>>& dlls)
+{
+	std::map<const std::string*, std::uint32_t> pathOffsets;
+	std::map<const IMsvDllDecorator*, std::uint32_t> decoratorIndexes;
+
+	//store each interned path and each decorator only once
+	auto sealData = [&](const MsvDllData& dllData)
+	{
+		std::map<const std::string*, std::uint32_t>::const_iterator pathIt = pathOffsets.find(&dllData.GetDllPath());
+		if (pathIt == pathOffsets.end())
+		{
+			pathIt = pathOffsets.insert(std::make_pair(&dllData.GetDllPath(), static_cast<std::uint32_t>(m_pool.size()))).first;
+			m_pool.append(dllData.GetDllPath().c_str(), dllData.GetDllPath().size() + 1);
+		}
+
+		std::uint32_t decoratorIndex = MSV_DLL_LIST_NO_DECORATOR;
+		if (dllData.GetDllDecorator())
+		{
+			std::map<const IMsvDllDecorator*, std::uint32_t>::const_iterator decoratorIt = decoratorIndexes.find(dllData.GetDllDecorator().get());
+			if (decoratorIt == decoratorIndexes.end())
+			{
+				decoratorIt = decoratorIndexes.insert(std::make_pair(dllData.GetDllDecorator().get(), static_cast<std::uint32_t>(m_decorators.size()))).first;
+				m_decorators.push_back(dllData.GetDllDecorator());
+			}
+
+			decoratorIndex = decoratorIt->second;
+		}
+
+		return MsvDllSealedData(pathIt->second, decoratorIndex, dllData.GetLoadOptions());
+	};
+
+	//binary GUID ids - hash table is at most half full (its size is power of two)
+	std::size_t idsSize = dllIds.empty() ? 0 : 2;
+	while (idsSize < dllIds.size() * 2)
+	{
+		idsSize *= 2;
+	}
+
+	m_ids.assign(idsSize, MsvDllId());
+	m_idData.assign(idsSize, MsvDllSealedData(0, MSV_DLL_LIST_NO_DECORATOR, MSV_DLL_LOAD_DEFAULT));
+	for (std::unordered_map<MsvDllId, std::shared_ptr<MsvDllData>>::const_iterator it = dllIds.begin(); it != dllIds.end(); ++it)
+	{
+		std::size_t index = it->first.Hash() & (idsSize - 1);
+		while (m_ids[index].Valid())
+		{
+			index = (index + 1) & (idsSize - 1);
+		}
+
+		m_ids[index] = it->first;
+		m_idData[index] = sealData(*it->second);
+	}
+
+	//other ids - map is already sorted, ids are stored to pool too
+	m_names.reserve(dlls.size());
+	m_nameData.reserve(dlls.size());
+	for (std::map<std::string, std::shared_ptr<MsvDllData>, std::less<>>::const_iterator it = dlls.begin(); it != dlls.end(); ++it)
+	{
+		m_nameData.push_back(sealData(*it->second));
+		m_names.push_back(static_cast<std::uint32_t>(m_pool.size()));
+		m_pool.append(it->first.c_str(), it->first.size() + 1);
+	}
+
+	m_pool.shrink_to_fit();
+
+	return pathOffsets.size();
+}
+
+bool MsvDllList::MsvDllSnapshot::GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+{
+	//binary search in sorted id offsets
+	std::vector<std::uint32_t>::const_iterator it = std::lower_bound(m_names.begin(), m_names.end(), id, [this](std::uint32_t nameOffset, const char* name) { return std::strcmp(m_pool.c_str() + nameOffset, name) < 0; });
+	if (it != m_names.end() && std::strcmp(m_pool.c_str() + *it, id) == 0)
+	{
+		GetDllData(m_nameData[it - m_names.begin()], dllPath, spDllDecorator, loadOptions);
+		return true;
+	}
+
+	return false;
+}
+
+bool MsvDllList::MsvDllSnapshot::GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+{
+	//linear probing in hash table (it is never full, so it always ends in empty slot)
+	std::size_t mask = m_ids.size() - 1;
+	for (std::size_t index = id.Hash() & mask; !m_ids.empty() && m_ids[index].Valid(); index = (index + 1) & mask)
+	{
+		if (m_ids[index] == id)
+		{
+			GetDllData(m_idData[index], dllPath, spDllDecorator, loadOptions);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void MsvDllList::MsvDllSnapshot::GetDllIds(std::vector<std::string>& ids) const
+{
+	ids.clear();
+	ids.reserve(m_names.size() + m_ids.size() / 2);
+
+	char idString[MSV_DLL_ID_STRING_SIZE];
+	for (std::vector<MsvDllId>::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it)
+	{
+		if (it->Valid())
+		{
+			ids.push_back(it->ToString(idString));
+		}
+	}
+
+	for (std::vector<std::uint32_t>::const_iterator it = m_names.begin(); it != m_names.end(); ++it)
+	{
+		ids.push_back(m_pool.c_str() + *it);
+	}
+}
+
+void MsvDllList::MsvDllSnapshot::GetDllData(const MsvDllSealedData& sealedData, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+{
+	dllPath.assign(m_pool.c_str() + sealedData.GetDllPathOffset());
+	loadOptions = sealedData.GetLoadOptions();
+
+	if (sealedData.GetDecoratorIndex() != MSV_DLL_LIST_NO_DECORATOR)
+	{
+		spDllDecorator = m_decorators[sealedData.GetDecoratorIndex()];
+	}
+	else
+	{
+		spDllDecorator.reset();
+	}
 }
 
 
@@ -61,23 +256,31 @@ void MsvDllList::MsvDllData::GetDllData(std::string& dllPath, std::shared_ptr<IM
 
 
 MsvDllList::MsvDllList(std::shared_ptr<MsvLogger> spLogger):
+	m_updateDepth(0),
+	m_updated(false),
+	m_sealed(false),
+	m_pSnapshot(nullptr),
 	m_spLogger(spLogger)
 {
 	/*
 	//It might be usefull to create whole DLL table in child constructor or in some initialize method (better for check error codes):
 
+	MSV_RETURN_FAILED(BeginUpdate());
 	MSV_RETURN_FAILED(AddDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "<path_to_dll>"));
 	MSV_RETURN_FAILED(AddDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}", "<path_to_dll>", nullptr));
 	std::shared_ptr<IMsvDllDecorator> spDllDecorator(new (std::nothrow) MsvDllDecorator());
 	if (!spDllDecorator) { return MSV_ALLOCATION_ERROR; }
 	MSV_RETURN_FAILED(AddDll("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", "<path_to_dll>", spDllDecorator));
+	MSV_RETURN_FAILED(AddDll("{5D6C29B1-4E0A-4F43-9A4C-2B8F6E1D7A30}", "<path_to_dll>", nullptr, MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_NODELETE));
+	MSV_RETURN_FAILED(EndUpdate());
 
 	*/
 }
 
 MsvDllList::~MsvDllList()
 {
-
+	//there are no readers anymore (replaced snapshots are deleted by reclaimer)
+	delete m_pSnapshot.load();
 }
 
 
@@ -88,48 +291,304 @@ MsvDllList::~MsvDllList()
 
 MsvErrorCode MsvDllList::GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const
 {
+	MsvDllLoadOptions loadOptions;
+	return GetDll(id, dllPath, spDllDecorator, loadOptions);
+}
+
+MsvErrorCode MsvDllList::GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const
+{
+	MsvDllLoadOptions loadOptions;
+	return GetDll(id, dllPath, spDllDecorator, loadOptions);
+}
+
+MsvErrorCode MsvDllList::GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+{
+	MsvDllId dllId(id);
+	if (dllId.Valid())
+	{
+		//braced GUID -> it is in GUID table
+		return GetDll(dllId, dllPath, spDllDecorator, loadOptions);
+	}
+
 	MSV_LOG_INFO(m_spLogger, "Getting DLL library \"{}\" data from list.", id);
 
-	std::map<std::string, std::shared_ptr<MsvDllData>>::const_iterator it = m_dlls.find(id);
-	if (it != m_dlls.end())
 	{
-		//it is in map -> return DLL data
-		it->second->GetDllData(dllPath, spDllDecorator);
-		return MSV_SUCCESS;
+		//lock-free read - snapshot is immutable and it is not deleted until read-side section is left
+		MsvDllReadSection readSection(m_reclaimer);
+
+		const MsvDllSnapshot* pSnapshot = m_pSnapshot.load();
+		if (pSnapshot && pSnapshot->GetDll(id, dllPath, spDllDecorator, loadOptions))
+		{
+			return MSV_SUCCESS;
+		}
 	}
 
 	MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" is not in the list.", id);
 
-	//not in map -> not found error
+	//not in list -> not found error
 	return MSV_NOT_FOUND_ERROR;
 }
 
+MsvErrorCode MsvDllList::GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+{
+	char idString[MSV_DLL_ID_STRING_SIZE];
+	id.ToString(idString);
+
+	MSV_LOG_INFO(m_spLogger, "Getting DLL library \"{}\" data from list.", idString);
+
+	{
+		//lock-free read - snapshot is immutable and it is not deleted until read-side section is left
+		MsvDllReadSection readSection(m_reclaimer);
+
+		const MsvDllSnapshot* pSnapshot = m_pSnapshot.load();
+		if (pSnapshot && pSnapshot->GetDll(id, dllPath, spDllDecorator, loadOptions))
+		{
+			return MSV_SUCCESS;
+		}
+	}
+
+	MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" is not in the list.", idString);
+
+	//not in list -> not found error
+	return MSV_NOT_FOUND_ERROR;
+}
+
+
+MsvErrorCode MsvDllList::GetDllIds(std::vector<std::string>& ids) const
+{
+	//lock-free read - all ids are from one consistent version
+	MsvDllReadSection readSection(m_reclaimer);
+
+	const MsvDllSnapshot* pSnapshot = m_pSnapshot.load();
+	if (pSnapshot)
+	{
+		pSnapshot->GetDllIds(ids);
+	}
+	else
+	{
+		ids.clear();
+	}
+
+	return MSV_SUCCESS;
+}
+
 
 /********************************************************************************************************************************
 *															MsvDllList public methods
 ********************************************************************************************************************************/
 
 
-MsvErrorCode MsvDllList::AddDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator)
+MsvErrorCode MsvDllList::AddDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator, MsvDllLoadOptions loadOptions)
 {
 	MSV_LOG_INFO(m_spLogger, "Adding DLL library \"{}\" to DLL list.", id);
 
-	std::map<std::string, std::shared_ptr<MsvDllData>>::iterator it = m_dlls.find(id);
-	if (it != m_dlls.end())
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_sealed)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL list has been sealed - DLL library \"{}\" can't be added.", id);
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	if (HasDll(id))
 	{
 		//dll already exists -> return error (probably called twice for one DLL, but it might be copy paste error, when id is used more times for more DLLs)
 		MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" already in the list.", id);
 		return MSV_ALREADY_EXISTS_ERROR;
 	}
 
-	std::shared_ptr<MsvDllData> spDllData(new (std::nothrow) MsvDllData(dllPath, spDllDecorator));
+	return SetDll(id, dllPath, spDllDecorator, loadOptions);
+}
+
+MsvErrorCode MsvDllList::ReplaceDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator, MsvDllLoadOptions loadOptions)
+{
+	MSV_LOG_INFO(m_spLogger, "Replacing DLL library \"{}\" in DLL list.", id);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_sealed)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL list has been sealed - DLL library \"{}\" can't be replaced.", id);
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	if (!HasDll(id))
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" is not in the list.", id);
+		return MSV_NOT_FOUND_ERROR;
+	}
+
+	return SetDll(id, dllPath, spDllDecorator, loadOptions);
+}
+
+MsvErrorCode MsvDllList::RemoveDll(const char* id)
+{
+	MSV_LOG_INFO(m_spLogger, "Removing DLL library \"{}\" from DLL list.", id);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_sealed)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL list has been sealed - DLL library \"{}\" can't be removed.", id);
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	MsvDllId dllId(id);
+	if (dllId.Valid() ? m_dllIds.erase(dllId) == 0 : m_dlls.erase(id) == 0)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL library \"{}\" is not in the list.", id);
+		return MSV_NOT_FOUND_ERROR;
+	}
+
+	return Publish();
+}
+
+MsvErrorCode MsvDllList::BeginUpdate()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_sealed)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL list has been sealed - it can't be updated.");
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	++m_updateDepth;
+
+	return MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllList::EndUpdate()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_updateDepth == 0)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL list update has not been begun.");
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	//the outermost batch publishes all its changes at once
+	return --m_updateDepth == 0 && m_updated ? Publish() : MSV_SUCCESS;
+}
+
+MsvErrorCode MsvDllList::Seal()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_sealed)
+	{
+		MSV_LOG_INFO(m_spLogger, "DLL list has already been sealed.");
+		return MSV_ALREADY_INITIALIZED_INFO;
+	}
+
+	if (m_updateDepth > 0)
+	{
+		MSV_LOG_ERROR(m_spLogger, "DLL list update has not been ended - it can't be sealed.");
+		return MSV_NOT_ALLOWED_ERROR;
+	}
+
+	MSV_LOG_INFO(m_spLogger, "Sealing DLL list with {} DLL libraries.", m_dllIds.size() + m_dlls.size());
+
+	//publish even empty list (or list which failed to publish)
+	if (m_updated || !m_pSnapshot.load())
+	{
+		MSV_RETURN_FAILED(Publish());
+	}
+
+	//release writer copy (DLL data reference interned paths, so they are released first)
+	m_dllIds.clear();
+	m_dlls.clear();
+	m_dllPaths.clear();
+	m_sealed = true;
+
+	return MSV_SUCCESS;
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllList protected methods
+********************************************************************************************************************************/
+
+
+MsvErrorCode MsvDllList::SetDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator, MsvDllLoadOptions loadOptions)
+{
+	//intern DLL path (DLL ids with same path share it)
+	std::set<std::string, std::less<>>::const_iterator pathIt = m_dllPaths.find(dllPath);
+	if (pathIt == m_dllPaths.end())
+	{
+		pathIt = m_dllPaths.insert(dllPath).first;
+	}
+
+	std::shared_ptr<MsvDllData> spDllData(new (std::nothrow) MsvDllData(*pathIt, spDllDecorator, loadOptions));
 	if (!spDllData)
 	{
 		MSV_LOG_ERROR(m_spLogger, "Create MsvDllData for DLL library \"{}\" failed.", id);
 		return MSV_ALLOCATION_ERROR;
 	}
 
-	m_dlls[id] = spDllData;
+	//braced GUIDs are stored by binary id, other ids by string
+	MsvDllId dllId(id);
+	if (dllId.Valid())
+	{
+		m_dllIds[dllId] = spDllData;
+	}
+	else
+	{
+		m_dlls[id] = spDllData;
+	}
+
+	return Publish();
+}
+
+bool MsvDllList::HasDll(const char* id) const
+{
+	MsvDllId dllId(id);
+
+	return dllId.Valid() ? m_dllIds.find(dllId) != m_dllIds.end() : m_dlls.find(id) != m_dlls.end();
+}
+
+MsvErrorCode MsvDllList::Publish()
+{
+	m_updated = true;
+	if (m_updateDepth > 0)
+	{
+		//batch -> it is published when batch ends
+		return MSV_SUCCESS;
+	}
+
+	std::unique_ptr<MsvDllSnapshot> spSnapshot(new (std::nothrow) MsvDllSnapshot());
+	if (!spSnapshot)
+	{
+		MSV_LOG_ERROR(m_spLogger, "Create DLL list snapshot failed.");
+		return MSV_ALLOCATION_ERROR;
+	}
+
+	std::size_t dllPathCount = spSnapshot->Build(m_dllIds, m_dlls);
+
+	//readers of old snapshot keep reading it - it is deleted when all of them are gone (writer does not wait for them)
+	m_reclaimer.Retire(m_pSnapshot.exchange(spSnapshot.release()));
+	m_updated = false;
+
+	if (dllPathCount == m_dllPaths.size())
+	{
+		return MSV_SUCCESS;
+	}
+
+	//release interned paths which are not used anymore (replaced or removed DLLs)
+	std::set<const std::string*> usedPaths;
+	for (std::unordered_map<MsvDllId, std::shared_ptr<MsvDllData>>::const_iterator it = m_dllIds.begin(); it != m_dllIds.end(); ++it)
+	{
+		usedPaths.insert(&it->second->GetDllPath());
+	}
+	for (std::map<std::string, std::shared_ptr<MsvDllData>, std::less<>>::const_iterator it = m_dlls.begin(); it != m_dlls.end(); ++it)
+	{
+		usedPaths.insert(&it->second->GetDllPath());
+	}
+	for (std::set<std::string, std::less<>>::iterator it = m_dllPaths.begin(); it != m_dllPaths.end();)
+	{
+		it = usedPaths.find(&*it) == usedPaths.end() ? m_dllPaths.erase(it) : ++it;
+	}
 
 	return MSV_SUCCESS;
 }
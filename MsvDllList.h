@@ -36,19 +36,40 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "IMsvDllList.h"
+#include "MsvDllReclaimer.h"
 
 #include "mlogging/mlogging.h"
 
 MSV_DISABLE_ALL_WARNINGS
 
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 MSV_ENABLE_WARNINGS
 
 
+/**************************************************************************************************//**
+* @def			MSV_DLL_LIST_NO_DECORATOR
+* @brief			No decorator index.
+* @details		Decorator index of DLL which does not need decorator (in published DLL list).
+******************************************************************************************************/
+#define MSV_DLL_LIST_NO_DECORATOR 0xFFFFFFFF
+
+
 /**************************************************************************************************//**
 * @brief		MarsTech DLL List Implementation.
 * @details	Implementation for MarsTech DLL list. Converts DLL id to path to DLL and decorator.
+*				DLLs might be added, replaced and removed at any time - changes are made in writer copy of
+*				DLL list (under lock), then immutable compact snapshot is built and published (copy on
+*				write). Readers never lock - they just load current snapshot pointer inside read-side
+*				section (replaced snapshots are deleted after grace period), so they always see consistent
+*				version of DLL list.
 * @see		IMsvDllList
 ******************************************************************************************************/
 class MsvDllList:
@@ -64,10 +85,12 @@ protected:
 	public:
 		/**************************************************************************************************//**
 		* @brief			Constructor.
-		* @param[in]	dllPath				Path to dynamic/shared library.
+		* @param[in]	dllPath				Interned path to dynamic/shared library (it must outlive this object).
 		* @param[in]	spDllDecorator		Shared pointer to decorator (it might be nullptr if decorator is not needed).
+		* @param[in]	loadOptions			DLL load options (see @ref MsvDllLoadOption).
+		* @see			m_dllPaths
 		******************************************************************************************************/
-		MsvDllData(const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator = nullptr);
+		MsvDllData(const std::string& dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator = nullptr, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT);
 
 		/**************************************************************************************************//**
 		* @brief			Deleted copy constructor.
@@ -90,15 +113,34 @@ protected:
 		* @details		Returns stored data for dynamic/shared library.
 		* @param[out]	dllPath				Path to dynamic/shared library.
 		* @param[out]	spDllDecorator		Shared pointer to decorator (it might be nullptr if decorator is not needed).
+		* @param[out]	loadOptions			DLL load options (see @ref MsvDllLoadOption).
+		******************************************************************************************************/
+		void GetDllData(std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL path.
+		* @returns		const std::string&				Interned path to dynamic/shared library.
+		******************************************************************************************************/
+		const std::string& GetDllPath() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL decorator.
+		* @returns		const std::shared_ptr<IMsvDllDecorator>&		Shared pointer to decorator (it might be nullptr).
+		******************************************************************************************************/
+		const std::shared_ptr<IMsvDllDecorator>& GetDllDecorator() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL load options.
+		* @returns		MsvDllLoadOptions				DLL load options (see @ref MsvDllLoadOption).
 		******************************************************************************************************/
-		void GetDllData(std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const;
+		MsvDllLoadOptions GetLoadOptions() const;
 
 	protected:
 		/**************************************************************************************************//**
 		* @brief		Path to DLL.
-		* @details	Stores real path to dynamic/shared library.
+		* @details	Reference to interned real path to dynamic/shared library (DLLs with same path share it).
 		******************************************************************************************************/
-		std::string m_dllPath;
+		const std::string& m_dllPath;
 
 		/**************************************************************************************************//**
 		* @brief		DLL decorator.
@@ -106,6 +148,191 @@ protected:
 		* @note		It might be nullptr when decorator is not needed.
 		******************************************************************************************************/
 		std::shared_ptr<IMsvDllDecorator> m_spDllDecorator;
+
+		/**************************************************************************************************//**
+		* @brief		DLL load options.
+		* @details	Flags which control how DLL is loaded (see @ref MsvDllLoadOption).
+		******************************************************************************************************/
+		MsvDllLoadOptions m_loadOptions;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech Sealed DLL Data.
+	* @details	Compact DLL data of published DLL list (offset to path pool, index to decorator table and
+	*				load options).
+	* @see		MsvDllSnapshot
+	******************************************************************************************************/
+	class MsvDllSealedData
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @param[in]	dllPathOffset		Offset of null terminated DLL path in path pool.
+		* @param[in]	decoratorIndex		Index to decorator table (MSV_DLL_LIST_NO_DECORATOR when decorator is not needed).
+		* @param[in]	loadOptions			DLL load options (see @ref MsvDllLoadOption).
+		******************************************************************************************************/
+		MsvDllSealedData(std::uint32_t dllPathOffset, std::uint32_t decoratorIndex, MsvDllLoadOptions loadOptions);
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL path offset.
+		* @returns		std::uint32_t		Offset of null terminated DLL path in path pool.
+		******************************************************************************************************/
+		std::uint32_t GetDllPathOffset() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get decorator index.
+		* @returns		std::uint32_t		Index to decorator table (MSV_DLL_LIST_NO_DECORATOR when decorator is not needed).
+		******************************************************************************************************/
+		std::uint32_t GetDecoratorIndex() const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL load options.
+		* @returns		MsvDllLoadOptions	DLL load options (see @ref MsvDllLoadOption).
+		******************************************************************************************************/
+		MsvDllLoadOptions GetLoadOptions() const;
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		DLL path offset.
+		* @details	Offset of null terminated DLL path in path pool.
+		******************************************************************************************************/
+		std::uint32_t m_dllPathOffset;
+
+		/**************************************************************************************************//**
+		* @brief		Decorator index.
+		* @details	Index to decorator table (MSV_DLL_LIST_NO_DECORATOR when decorator is not needed).
+		******************************************************************************************************/
+		std::uint32_t m_decoratorIndex;
+
+		/**************************************************************************************************//**
+		* @brief		DLL load options.
+		* @details	Flags which control how DLL is loaded (see @ref MsvDllLoadOption).
+		******************************************************************************************************/
+		MsvDllLoadOptions m_loadOptions;
+	};
+
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL List Snapshot.
+	* @details	Immutable (once built) compact version of DLL list. Binary GUID ids are stored in open
+	*				addressing hash table, ids which are not braced GUIDs are sorted, paths are stored once in
+	*				path pool and decorators in decorator table. Lookup is hash probe (or binary search) in
+	*				contiguous array (no pointer chasing) and it takes only a few bytes per DLL.
+	******************************************************************************************************/
+	class MsvDllSnapshot
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @details		Creates empty snapshot.
+		******************************************************************************************************/
+		MsvDllSnapshot();
+
+		/**************************************************************************************************//**
+		* @brief			Deleted copy constructor.
+		* @details		Copy constructor deleted -> copying is not allowed.
+		* @param[in]	origin			Reference to copyied object.
+		* @warning		Do not copy this object.
+		******************************************************************************************************/
+		MsvDllSnapshot(const MsvDllSnapshot& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Deleted assign operator.
+		* @details		Assign operator deleted -> assign is not allowed.
+		* @param[in]	origin			Reference to assigned object.
+		* @warning		Do not assign this object.
+		******************************************************************************************************/
+		MsvDllSnapshot& operator= (const MsvDllSnapshot& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Build snapshot.
+		* @details		Copies DLL data to compact arrays.
+		* @param[in]	dllIds				DLL data of braced GUID DLL ids.
+		* @param[in]	dlls					DLL data of other DLL ids.
+		* @returns		std::size_t			Count of (different) stored DLL paths.
+		* @warning		It must be called only once - before snapshot is published.
+		******************************************************************************************************/
+		std::size_t Build(const std::unordered_map<MsvDllId, std::shared_ptr<MsvDllData>>& dllIds, const std::map<std::string, std::shared_ptr<MsvDllData>, std::less<>>& dlls);
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL data.
+		* @param[in]	id						DLL id (which is not braced GUID).
+		* @param[out]	dllPath				Path to DLL.
+		* @param[out]	spDllDecorator		Shared pointer to DLL/object decorator.
+		* @param[out]	loadOptions			DLL load options.
+		* @retval		true					When DLL has been found.
+		* @retval		false					When DLL is not in snapshot.
+		******************************************************************************************************/
+		bool GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL data.
+		* @param[in]	id						Binary DLL id.
+		* @param[out]	dllPath				Path to DLL.
+		* @param[out]	spDllDecorator		Shared pointer to DLL/object decorator.
+		* @param[out]	loadOptions			DLL load options.
+		* @retval		true					When DLL has been found.
+		* @retval		false					When DLL is not in snapshot.
+		******************************************************************************************************/
+		bool GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const;
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL ids.
+		* @param[out]	ids					DLL ids (braced GUID ids are in canonical upper case form).
+		******************************************************************************************************/
+		void GetDllIds(std::vector<std::string>& ids) const;
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief			Get sealed DLL data.
+		* @details		Returns DLL data stored in snapshot.
+		* @param[in]	sealedData			Sealed DLL data.
+		* @param[out]	dllPath				Path to DLL.
+		* @param[out]	spDllDecorator		Shared pointer to DLL/object decorator.
+		* @param[out]	loadOptions			DLL load options.
+		******************************************************************************************************/
+		void GetDllData(const MsvDllSealedData& sealedData, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const;
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		DLL ids.
+		* @details	Open addressing (linear probing) hash table of binary GUID DLL ids. Its size is power of
+		*				two and empty slots hold invalid (nil) id. Keys are separated from data, so probing
+		*				touches keys only.
+		* @see		m_idData
+		******************************************************************************************************/
+		std::vector<MsvDllId> m_ids;
+
+		/**************************************************************************************************//**
+		* @brief		DLL id data.
+		* @details	DLL data - it has the same index as its id in @ref m_ids.
+		******************************************************************************************************/
+		std::vector<MsvDllSealedData> m_idData;
+
+		/**************************************************************************************************//**
+		* @brief		DLL names.
+		* @details	Offsets of DLL ids which are not braced GUIDs in path pool (sorted by id).
+		* @see		m_nameData
+		******************************************************************************************************/
+		std::vector<std::uint32_t> m_names;
+
+		/**************************************************************************************************//**
+		* @brief		DLL name data.
+		* @details	DLL data - it has the same index as its id in @ref m_names.
+		******************************************************************************************************/
+		std::vector<MsvDllSealedData> m_nameData;
+
+		/**************************************************************************************************//**
+		* @brief		Path pool.
+		* @details	Null terminated DLL paths (each path is stored only once) and DLL ids which are not braced
+		*				GUIDs.
+		******************************************************************************************************/
+		std::string m_pool;
+
+		/**************************************************************************************************//**
+		* @brief		Decorator table.
+		* @details	Decorators of DLLs (each decorator is stored only once).
+		******************************************************************************************************/
+		std::vector<std::shared_ptr<IMsvDllDecorator>> m_decorators;
 	};
 
 public:
@@ -128,29 +355,203 @@ public:
 	******************************************************************************************************/
 	virtual MsvErrorCode GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const override;
 
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllList::GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator) const override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllList::GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const char* id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllList::GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDll(const MsvDllId& id, std::string& dllPath, std::shared_ptr<IMsvDllDecorator>& spDllDecorator, MsvDllLoadOptions& loadOptions) const override;
+
+	/**************************************************************************************************//**
+	* @copydoc IMsvDllList::GetDllIds(std::vector<std::string>& ids) const
+	******************************************************************************************************/
+	virtual MsvErrorCode GetDllIds(std::vector<std::string>& ids) const override;
+
 	/*-----------------------------------------------------------------------------------------------------
 	**											MsvDllList public methods
 	**---------------------------------------------------------------------------------------------------*/
 public:
 	/**************************************************************************************************//**
 	* @brief			Add DLL data.
-	* @details		Add DLL data definition (path, decorarator) for DLL id.
+	* @details		Add DLL data definition (path, decorarator, load options) for DLL id.
 	* @param[in]	id										DLL id.
 	* @param[in]	dllPath								Path to DLL.
 	* @param[in]	spDllDecorator						Shared pointer to DLL/object decorator (it might be nullptr if decorator is not needed).
+	* @param[in]	loadOptions							DLL load options (see @ref MsvDllLoadOption).
 	* @retval		MSV_ALREADY_EXISTS_ERROR		When DLL id is already in DLL list.
 	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
 	* @retval		MSV_SUCCESS							On success.
+	* @note			DLL is loaded only once for all its ids - load options of id which loads it are used (ids
+	*					with same path should have same load options).
 	******************************************************************************************************/
-	virtual MsvErrorCode AddDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator = nullptr);
+	virtual MsvErrorCode AddDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator = nullptr, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT);
+
+	/**************************************************************************************************//**
+	* @brief			Replace DLL data.
+	* @details		Replaces DLL data definition (path, decorarator, load options) of DLL id which is already in DLL list.
+	* @param[in]	id										DLL id.
+	* @param[in]	dllPath								Path to DLL.
+	* @param[in]	spDllDecorator						Shared pointer to DLL/object decorator (it might be nullptr if decorator is not needed).
+	* @param[in]	loadOptions							DLL load options (see @ref MsvDllLoadOption).
+	* @retval		MSV_NOT_FOUND_ERROR				When DLL id is not in DLL list.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @note			DLL factory finds loaded DLL by its path from DLL list - release DLL (IMsvDllFactory::ReleaseDll)
+	*					before its data are replaced.
+	******************************************************************************************************/
+	virtual MsvErrorCode ReplaceDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator = nullptr, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT);
+
+	/**************************************************************************************************//**
+	* @brief			Remove DLL data.
+	* @details		Removes DLL data definition of DLL id.
+	* @param[in]	id										DLL id.
+	* @retval		MSV_NOT_FOUND_ERROR				When DLL id is not in DLL list.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @note			DLL factory finds loaded DLL by its path from DLL list - release DLL (IMsvDllFactory::ReleaseDll)
+	*					before its data are removed.
+	******************************************************************************************************/
+	virtual MsvErrorCode RemoveDll(const char* id);
+
+	/**************************************************************************************************//**
+	* @brief			Begin update.
+	* @details		Begins batch of changes (@ref AddDll, @ref ReplaceDll, @ref RemoveDll) - changes are not
+	*					visible to readers until batch ends, then they are published at once (DLL list is
+	*					copied only once). Batches might be nested.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When DLL list has been sealed.
+	* @retval		MSV_SUCCESS							On success.
+	* @see			EndUpdate
+	******************************************************************************************************/
+	virtual MsvErrorCode BeginUpdate();
+
+	/**************************************************************************************************//**
+	* @brief			End update.
+	* @details		Ends batch of changes - when it is the outermost batch, all changes are published.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When there is no batch to end.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed (changes are published by next successful publish).
+	* @retval		MSV_SUCCESS							On success.
+	* @see			BeginUpdate
+	******************************************************************************************************/
+	virtual MsvErrorCode EndUpdate();
+
+	/**************************************************************************************************//**
+	* @brief			Seal DLL list.
+	* @details		Freezes DLL list when all DLLs has been added - writer copy of DLL list is released and
+	*					only compact published snapshot is kept.
+	* @retval		MSV_ALREADY_INITIALIZED_INFO	When DLL list has already been sealed (this is info, not error).
+	* @retval		MSV_NOT_ALLOWED_ERROR			When batch of changes has not been ended.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		DLL list can't be changed when it is sealed (@ref AddDll, @ref ReplaceDll and @ref RemoveDll
+	*					fail with MSV_NOT_ALLOWED_ERROR).
+	******************************************************************************************************/
+	virtual MsvErrorCode Seal();
 
 protected:
+	/**************************************************************************************************//**
+	* @brief			Set DLL data.
+	* @details		Stores DLL data to writer copy of DLL list and publishes it (when there is no batch).
+	* @param[in]	id										DLL id.
+	* @param[in]	dllPath								Path to DLL.
+	* @param[in]	spDllDecorator						Shared pointer to DLL/object decorator (it might be nullptr if decorator is not needed).
+	* @param[in]	loadOptions							DLL load options (see @ref MsvDllLoadOption).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	MsvErrorCode SetDll(const char* id, const char* dllPath, std::shared_ptr<IMsvDllDecorator> spDllDecorator, MsvDllLoadOptions loadOptions);
+
+	/**************************************************************************************************//**
+	* @brief			Check DLL id.
+	* @details		Returns flag if DLL id is in writer copy of DLL list (true) or not (false).
+	* @param[in]	id						DLL id.
+	* @retval		true					When DLL id is in DLL list.
+	* @retval		false					Otherwise.
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	bool HasDll(const char* id) const;
+
+	/**************************************************************************************************//**
+	* @brief			Publish DLL list.
+	* @details		Marks DLL list as changed, then builds and publishes new snapshot (when there is no batch).
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_SUCCESS							On success.
+	* @warning		Must be called with locked @ref m_lock.
+	******************************************************************************************************/
+	MsvErrorCode Publish();
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		DLL paths.
+	* @details	Interned paths to DLLs (writer copy) - each path is stored only once, even when there are
+	*				many DLL ids with the same path.
+	* @see		MsvDllData
+	******************************************************************************************************/
+	std::set<std::string, std::less<>> m_dllPaths;
+
 	/**************************************************************************************************//**
 	* @brief		DLL map.
-	* @details	Contains data for each DLL id.
+	* @details	Contains data for each DLL id which is not braced GUID (writer copy).
+	* @see		MsvDllData
+	* @see		m_dllIds
+	******************************************************************************************************/
+	std::map<std::string, std::shared_ptr<MsvDllData>, std::less<>> m_dlls;
+
+	/**************************************************************************************************//**
+	* @brief		DLL GUID map.
+	* @details	Contains data for each braced GUID DLL id (writer copy).
 	* @see		MsvDllData
+	* @see		MsvDllId
+	******************************************************************************************************/
+	std::unordered_map<MsvDllId, std::shared_ptr<MsvDllData>> m_dllIds;
+
+	/**************************************************************************************************//**
+	* @brief		Writer lock.
+	* @details	Locks writer copy of DLL list (readers never lock it).
+	******************************************************************************************************/
+	std::mutex m_lock;
+
+	/**************************************************************************************************//**
+	* @brief		Update depth.
+	* @details	Count of not ended batches of changes.
+	* @see		BeginUpdate
+	******************************************************************************************************/
+	std::uint32_t m_updateDepth;
+
+	/**************************************************************************************************//**
+	* @brief		Updated flag.
+	* @details	Flag if writer copy of DLL list has changes which have not been published (true) or not (false).
+	******************************************************************************************************/
+	bool m_updated;
+
+	/**************************************************************************************************//**
+	* @brief		Sealed flag.
+	* @details	Flag if DLL list has been sealed (true) or not (false).
+	* @see		Seal
+	******************************************************************************************************/
+	bool m_sealed;
+
+	/**************************************************************************************************//**
+	* @brief		Published DLL list.
+	* @details	Current snapshot of DLL list (raw atomic pointer). Readers load it inside read-side section
+	*				of @ref m_reclaimer, writer retires replaced snapshot to @ref m_reclaimer, so snapshot which
+	*				is being read is never deleted.
+	******************************************************************************************************/
+	std::atomic<const MsvDllSnapshot*> m_pSnapshot;
+
+	/**************************************************************************************************//**
+	* @brief		Reclaimer.
+	* @details	Read-side sections of snapshot readers and retired snapshots.
 	******************************************************************************************************/
-	std::map<std::string, std::shared_ptr<MsvDllData>> m_dlls;
+	mutable MsvDllReclaimer m_reclaimer;
 
 	/**************************************************************************************************//**
 	* @brief		Logger.
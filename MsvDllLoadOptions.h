@@ -0,0 +1,75 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Load Options
+* @details		Contains definition of @ref MsvDllLoadOption flags.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLLOADOPTIONS_H
+#define MARSTECH_DLLLOADOPTIONS_H
+
+
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <cstdint>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Load Option.
+* @details	Flags which control how dynamic/shared library is loaded (they can be combined). Dynamic
+*				linker flags are used on Linux only (Windows binds imports at load time always).
+* @see		MsvDllLoadOptions
+******************************************************************************************************/
+enum MsvDllLoadOption: std::uint32_t
+{
+	MSV_DLL_LOAD_DEFAULT = 0x00,		///< Lazy binding (functions are bound by first call), symbols are not available to other libraries (RTLD_LAZY | RTLD_LOCAL).
+	MSV_DLL_LOAD_NOW = 0x01,			///< Bind all functions at load time, so first calls do not stall in dynamic linker (RTLD_NOW).
+	MSV_DLL_LOAD_GLOBAL = 0x02,		///< Symbols are available to libraries loaded later (RTLD_GLOBAL).
+	MSV_DLL_LOAD_DEEPBIND = 0x04,		///< Library prefers its own symbols to global ones (RTLD_DEEPBIND).
+	MSV_DLL_LOAD_NODELETE = 0x08,		///< Library is never unmapped - it stays in memory after it is unloaded (RTLD_NODELETE, pinned module on Windows).
+	MSV_DLL_LOAD_WARMUP = 0x10,		///< Library is warmed up by low priority thread of DLL factory after it is loaded (hot addresses are resolved and code pages are faulted in).
+	MSV_DLL_LOAD_PREFAULT = 0x20,		///< Code and read-only data of library are faulted in by load itself (load is slower, but first requests take no page faults).
+	MSV_DLL_LOAD_HUGE_PAGES = 0x40	///< Code of library is remapped onto transparent huge pages at same addresses (less iTLB misses of big libraries, Linux only).
+};
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Load Options.
+* @details	Combination of @ref MsvDllLoadOption flags.
+******************************************************************************************************/
+typedef std::uint32_t MsvDllLoadOptions;
+
+
+#endif // MARSTECH_DLLLOADOPTIONS_H
+
+/** @} */	//End of group MDLLFACTORY.
@@ -35,6 +35,44 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 #define MARSTECH_DLLMAINHELPER_H
 
 
+#include "MsvDllId.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <string>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief			Check requested DLL object.
+* @details		Checks if requested DLL object id is the same as id of object.
+* @param[in]	requestedId			Requested object ID.
+* @param[in]	id						ID of object.
+* @retval		true					When ids are the same.
+* @retval		false					When ids are not the same.
+******************************************************************************************************/
+inline bool MsvIsRequestedDllObject(const std::string& requestedId, const char* id)
+{
+	return requestedId.compare(id) == 0;
+}
+
+/**************************************************************************************************//**
+* @brief			Check requested DLL object.
+* @details		Checks if requested DLL object id is the same as id of object. Binary GUIDs are compared
+*					(no string comparison) - parse requested id once (MsvDllId requestedDllId(id)) and
+*					define object ids as constexpr MsvDllId.
+* @param[in]	requestedId			Requested object ID.
+* @param[in]	id						ID of object.
+* @retval		true					When ids are the same.
+* @retval		false					When ids are not the same.
+******************************************************************************************************/
+inline bool MsvIsRequestedDllObject(const MsvDllId& requestedId, const MsvDllId& id)
+{
+	return requestedId.Valid() && requestedId == id;
+}
+
+
 /**************************************************************************************************//**
 * @def			MSV_GET_DLLOBJECT_WITH_ID
 * @brief			Get DLL object.
@@ -45,7 +83,7 @@ along with Foobar. If not, see <https://www.gnu.org/licenses/>.
 * @param[out]	spOut					Created object.
 ******************************************************************************************************/
 #define MSV_GET_DLLOBJECT_WITH_ID(requestedId, id, objectToCreate, spOut) \
-if (requestedId.compare(id) == 0) \
+if (MsvIsRequestedDllObject(requestedId, id)) \
 { \
 	spOut.reset(new (std::nothrow) objectToCreate); \
 	if (!spOut) \
@@ -66,7 +104,7 @@ if (requestedId.compare(id) == 0) \
 * @param[out]	spOut					Shared object.
 ******************************************************************************************************/
 #define MSV_GETSHARED_DLLOBJECT_WITH_ID(requestedId, id, objectToCreate, spShared, spOut) \
-if (requestedId.compare(id) == 0) \
+if (MsvIsRequestedDllObject(requestedId, id)) \
 { \
 	if (!spShared) \
 	{ \
@@ -91,7 +129,7 @@ if (requestedId.compare(id) == 0) \
 * @param[out]	spOut					Shared object.
 ******************************************************************************************************/
 #define MSV_GETWEAKSHARED_DLLOBJECT_WITH_ID(requestedId, id, objectToCreate, spShared, spOut) \
-if (requestedId.compare(id) == 0) \
+if (MsvIsRequestedDllObject(requestedId, id)) \
 { \
 	if (!(spOut = spShared.lock())) \
 	{ \
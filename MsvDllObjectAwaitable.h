@@ -0,0 +1,271 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Object Awaitable
+* @details		Contains definition of @ref MsvDllObjectAwaitable (C++20 coroutines only).
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLOBJECTAWAITABLE_H
+#define MARSTECH_DLLOBJECTAWAITABLE_H
+
+
+#include "MsvDllObjectResult.h"
+
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_COROUTINES
+* @brief			Coroutines support.
+* @details		Defined when compiler supports C++20 coroutines (IMsvDllFactory::AwaitDllObject is
+*					available).
+******************************************************************************************************/
+#define MSV_DLL_COROUTINES
+
+#endif // __has_include(<coroutine>)
+#endif // defined(__cpp_impl_coroutine) && defined(__has_include)
+
+
+#ifdef MSV_DLL_COROUTINES
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+
+MSV_ENABLE_WARNINGS
+
+
+class IMsvDllFactory;
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Inline Executor.
+* @details	Default executor of @ref MsvDllObjectAwaitable - suspended coroutine is resumed by thread
+*				which has completed request (loader or timer thread of DLL factory).
+******************************************************************************************************/
+class MsvDllInlineExecutor
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Resume coroutine.
+	* @param[in]	handle				Handle of suspended coroutine.
+	******************************************************************************************************/
+	void operator()(std::coroutine_handle<> handle) const
+	{
+		handle.resume();
+	}
+};
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Object Awaitable.
+* @details	Awaitable result of IMsvDllFactory::AwaitDllObject. Coroutine is not suspended at all when
+*				DLL object has already been acquired (request is completed inline), otherwise it is
+*				suspended until DLL object is acquired by loader thread of DLL factory and then it is
+*				resumed by executor (it is called with coroutine handle and it must resume it exactly once).
+*				Error code of request is result of co_await.
+* @tparam		T						DLL object type.
+* @tparam		Executor				Executor of resumed coroutine (callable with std::coroutine_handle<>).
+* @tparam		Factory				DLL factory type (it is template parameter, so this header can be included
+*										before @ref IMsvDllFactory is defined).
+* @note		It must be awaited once and immediately (it is not copyable).
+* @note		Factory must be valid until coroutine is suspended. Destroyed factory finishes its pending
+*				requests, so suspended coroutine is resumed by its destructor at the latest. Coroutine should
+*				not own factory (its frame is destroyed by thread which has resumed it).
+******************************************************************************************************/
+template<class T, class Executor = MsvDllInlineExecutor, class Factory = IMsvDllFactory>
+class MsvDllObjectAwaitable
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @param[in]	factory				DLL factory.
+	* @param[in]	id						DLL (object) id (it must be valid until co_await is finished).
+	* @param[out]	spDllObject			Shared pointer to acquired DLL object (it must be valid until co_await is finished).
+	* @param[in]	executor				Executor of resumed coroutine.
+	* @param[in]	deadline				Deadline of request (result is MSV_TIMEOUT_ERROR when DLL object is not acquired in time).
+	******************************************************************************************************/
+	MsvDllObjectAwaitable(Factory& factory, const char* id, std::shared_ptr<T>& spDllObject, const Executor& executor, std::chrono::steady_clock::time_point deadline):
+		m_factory(factory),
+		m_id(id),
+		m_spDllObject(spDllObject),
+		m_executor(executor),
+		m_deadline(deadline),
+		m_errorCode(MSV_NOT_INITIALIZED_ERROR),
+		m_state(MSV_AWAITABLE_STATE_PENDING)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Deleted copy constructor.
+	* @details		Copy constructor deleted -> copying is not allowed.
+	* @param[in]	origin			Reference to copyied object.
+	* @warning		Do not copy this object.
+	******************************************************************************************************/
+	MsvDllObjectAwaitable(const MsvDllObjectAwaitable& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Deleted assign operator.
+	* @details		Assign operator deleted -> assign is not allowed.
+	* @param[in]	origin			Reference to assigned object.
+	* @warning		Do not assign this object.
+	******************************************************************************************************/
+	MsvDllObjectAwaitable& operator= (const MsvDllObjectAwaitable& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Ready check.
+	* @details		Request is started by @ref await_suspend (it knows if it has been completed inline).
+	* @retval		false					Always.
+	******************************************************************************************************/
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Start request.
+	* @details		Starts asynchronous request. Coroutine is resumed immediately (without any thread
+	*					switch) when request has been completed inline or when it has not been started.
+	* @param[in]	handle				Handle of awaiting coroutine.
+	* @retval		true					When coroutine is suspended (it is resumed by executor).
+	* @retval		false					When request has already been completed (coroutine is resumed immediately).
+	******************************************************************************************************/
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		m_handle = handle;
+
+		MsvErrorCode errorCode = m_factory.GetDllObjectAsync(m_id, [this](MsvErrorCode requestErrorCode, const std::shared_ptr<IMsvDllObject>& spDllObject)
+		{
+			m_errorCode = requestErrorCode;
+			m_spDllObject = std::static_pointer_cast<T, IMsvDllObject>(spDllObject);
+
+			//second one (completion or suspension) resumes coroutine
+			if (m_state.exchange(MSV_AWAITABLE_STATE_COMPLETED, std::memory_order_acq_rel) == MSV_AWAITABLE_STATE_SUSPENDED)
+			{
+				m_executor(m_handle);
+			}
+		}, m_deadline);
+
+		if (MSV_FAILED(errorCode))
+		{
+			//callback is not called when request has not been started
+			m_errorCode = errorCode;
+			return false;
+		}
+
+		//this object must not be touched when coroutine has been suspended (it might have already been resumed and destroyed)
+		return m_state.exchange(MSV_AWAITABLE_STATE_SUSPENDED, std::memory_order_acq_rel) != MSV_AWAITABLE_STATE_COMPLETED;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get result.
+	* @retval		MSV_ALLOCATION_ERROR				When memory allocation failed.
+	* @retval		MSV_NOT_ALLOWED_ERROR			When factory is being destroyed.
+	* @retval		MSV_TIMEOUT_ERROR					When DLL object has not been acquired before deadline.
+	* @retval		MSV_OPEN_ERROR						When load DLL library failed.
+	* @retval		MSV_SUCCESS							On success.
+	******************************************************************************************************/
+	MsvErrorCode await_resume() const noexcept
+	{
+		return m_errorCode;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Awaitable state.
+	* @details	States of request (completion and suspension are raced by different threads).
+	******************************************************************************************************/
+	enum MsvAwaitableState: std::uint32_t
+	{
+		MSV_AWAITABLE_STATE_PENDING = 0,
+		MSV_AWAITABLE_STATE_SUSPENDED,
+		MSV_AWAITABLE_STATE_COMPLETED
+	};
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		DLL factory.
+	* @details	DLL factory which acquires DLL object.
+	******************************************************************************************************/
+	Factory& m_factory;
+
+	/**************************************************************************************************//**
+	* @brief		DLL (object) id.
+	* @details	Id of requested DLL object.
+	******************************************************************************************************/
+	const char* m_id;
+
+	/**************************************************************************************************//**
+	* @brief		DLL object.
+	* @details	Reference to caller's shared pointer to acquired DLL object.
+	******************************************************************************************************/
+	std::shared_ptr<T>& m_spDllObject;
+
+	/**************************************************************************************************//**
+	* @brief		Executor.
+	* @details	Executor of resumed coroutine.
+	******************************************************************************************************/
+	Executor m_executor;
+
+	/**************************************************************************************************//**
+	* @brief		Deadline.
+	* @details	Deadline of request.
+	******************************************************************************************************/
+	std::chrono::steady_clock::time_point m_deadline;
+
+	/**************************************************************************************************//**
+	* @brief		Error code.
+	* @details	Error code of request.
+	******************************************************************************************************/
+	MsvErrorCode m_errorCode;
+
+	/**************************************************************************************************//**
+	* @brief		Coroutine handle.
+	* @details	Handle of awaiting coroutine.
+	******************************************************************************************************/
+	std::coroutine_handle<> m_handle;
+
+	/**************************************************************************************************//**
+	* @brief		State.
+	* @details	State of request (see @ref MsvAwaitableState).
+	******************************************************************************************************/
+	std::atomic<std::uint32_t> m_state;
+};
+
+#endif // MSV_DLL_COROUTINES
+
+
+#endif // MARSTECH_DLLOBJECTAWAITABLE_H
+
+/** @} */	//End of group MDLLFACTORY.
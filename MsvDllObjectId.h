@@ -0,0 +1,75 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Object Id
+* @details		Contains definition of @ref MsvDllObjectId trait and @ref MSV_DLLOBJECT_ID macro.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLOBJECTID_H
+#define MARSTECH_DLLOBJECTID_H
+
+
+#include "MsvDllId.h"
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Object Id.
+* @details	Binds DLL object id to DLL object (interface) type. It is not defined for types without id
+*				(compilation fails when id is requested for them) - use @ref MSV_DLLOBJECT_ID to define it.
+* @see		MSV_DLLOBJECT_ID
+******************************************************************************************************/
+template<class T>
+struct MsvDllObjectId;
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLLOBJECT_ID
+* @brief			Define DLL object id.
+* @details		Binds braced GUID DLL object id to DLL object (interface) type, so
+*					IMsvDllFactory::GetDllObject<T>(std::shared_ptr<T>& spDllObject) can be called without id.
+*					Id is parsed by compiler (compilation fails when it is not braced GUID).
+* @param[in]	objectType			DLL object (interface) type.
+* @param[in]	id						Braced GUID DLL object id.
+* @note			It must be used in global namespace (it specializes @ref MsvDllObjectId).
+******************************************************************************************************/
+#define MSV_DLLOBJECT_ID(objectType, id) \
+template<> \
+struct MsvDllObjectId<objectType> \
+{ \
+	static_assert(MsvDllId(id).Valid(), "DLL object id of " #objectType " must be braced GUID."); \
+	static constexpr MsvDllId Get() \
+	{ \
+		return MsvDllId(id); \
+	} \
+};
+
+
+#endif // MARSTECH_DLLOBJECTID_H
+
+/** @} */	//End of group MDLLFACTORY.
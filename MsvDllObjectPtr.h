@@ -0,0 +1,360 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Object Pointer
+* @details		Contains definition of @ref MsvDllObjectPtr.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLOBJECTPTR_H
+#define MARSTECH_DLLOBJECTPTR_H
+
+
+#include "MsvDllRefCountedObject.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+MSV_ENABLE_WARNINGS
+
+
+//forward declaration of MarsTech DLL Object Pointer
+template<class T> class MsvDllObjectPtr;
+
+//forward declaration of static cast of MarsTech DLL Object Pointer
+template<class T, class U> MsvDllObjectPtr<T> MsvStaticDllObjectCast(MsvDllObjectPtr<U>&& dllObject) noexcept;
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Object Pointer.
+* @details	Smart pointer to @ref MsvDllRefCountedObject (intrusive reference counting). Copy and release
+*				of pointer changes one counter only (there is no control block). It can be converted to
+*				std::shared_ptr (see @ref ToSharedPtr), so reference counted objects can be returned by
+*				GetDllObject function of DLL too.
+* @tparam		T						DLL object type (it must inherit from @ref MsvDllRefCountedObject).
+* @note		Pointer created by DLL (or executable) counts references of object. Pointer returned by DLL
+*				factory counts pin of object's DLL instead (pin count is kept by factory, factory owns object
+*				until its DLL is released) - see IMsvDllFactory::GetRefCountedDllObject.
+******************************************************************************************************/
+template<class T>
+class MsvDllObjectPtr
+{
+	//pointers to other types share pin of DLL
+	template<class U> friend class MsvDllObjectPtr;
+
+	//static cast takes pointer and its pin
+	template<class V, class U> friend MsvDllObjectPtr<V> MsvStaticDllObjectCast(MsvDllObjectPtr<U>&& dllObject) noexcept;
+
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates empty pointer.
+	******************************************************************************************************/
+	MsvDllObjectPtr() noexcept:
+		m_pDllObject(nullptr),
+		m_pDllPinCount(nullptr)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates empty pointer.
+	******************************************************************************************************/
+	MsvDllObjectPtr(std::nullptr_t) noexcept:
+		m_pDllObject(nullptr),
+		m_pDllPinCount(nullptr)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates pointer to DLL object.
+	* @param[in]	pDllObject			Pointer to DLL object (it might be nullptr).
+	* @param[in]	addReference		Flag if new reference should be added (true) or if reference of caller is
+	*										adopted (false - e.g. reference of just created object).
+	******************************************************************************************************/
+	explicit MsvDllObjectPtr(T* pDllObject, bool addReference = true) noexcept:
+		m_pDllObject(pDllObject),
+		m_pDllPinCount(nullptr)
+	{
+		if (m_pDllObject && addReference)
+		{
+			m_pDllObject->AddDllReference();
+		}
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates pointer to DLL object which is owned by DLL factory - pointer counts pin of its DLL.
+	* @param[in]	pDllObject			Pointer to DLL object (it is kept alive by DLL factory).
+	* @param[in]	pDllPinCount		Pin count of DLL (pin of caller is adopted).
+	* @warning		It is used by DLL factory only (see IMsvDllFactory::GetRefCountedDllObject).
+	******************************************************************************************************/
+	MsvDllObjectPtr(T* pDllObject, std::atomic<std::int64_t>* pDllPinCount) noexcept:
+		m_pDllObject(pDllObject),
+		m_pDllPinCount(pDllPinCount)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Copy constructor.
+	* @param[in]	origin				Copied pointer (reference or pin is added).
+	******************************************************************************************************/
+	MsvDllObjectPtr(const MsvDllObjectPtr& origin) noexcept:
+		m_pDllObject(origin.m_pDllObject),
+		m_pDllPinCount(origin.m_pDllPinCount)
+	{
+		AddReference();
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Copy constructor.
+	* @param[in]	origin				Copied pointer to derived type (reference or pin is added).
+	******************************************************************************************************/
+	template<class U>
+	MsvDllObjectPtr(const MsvDllObjectPtr<U>& origin) noexcept:
+		m_pDllObject(origin.m_pDllObject),
+		m_pDllPinCount(origin.m_pDllPinCount)
+	{
+		AddReference();
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Move constructor.
+	* @param[in]	origin				Moved pointer (its reference is taken, it is empty then).
+	******************************************************************************************************/
+	MsvDllObjectPtr(MsvDllObjectPtr&& origin) noexcept:
+		m_pDllObject(origin.m_pDllObject),
+		m_pDllPinCount(origin.m_pDllPinCount)
+	{
+		origin.m_pDllObject = nullptr;
+		origin.m_pDllPinCount = nullptr;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Destructor.
+	* @details		Releases reference of DLL object (or pin of its DLL).
+	******************************************************************************************************/
+	~MsvDllObjectPtr()
+	{
+		ReleaseReference();
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Assign operator.
+	* @param[in]	origin				Assigned pointer.
+	* @returns		MsvDllObjectPtr&	This pointer.
+	******************************************************************************************************/
+	MsvDllObjectPtr& operator= (MsvDllObjectPtr origin) noexcept
+	{
+		Swap(origin);
+		return *this;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Reset pointer.
+	* @details		Releases reference of DLL object and makes pointer empty.
+	******************************************************************************************************/
+	void Reset() noexcept
+	{
+		MsvDllObjectPtr().Swap(*this);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Swap pointers.
+	* @param[in]	other					Swapped pointer.
+	******************************************************************************************************/
+	void Swap(MsvDllObjectPtr& other) noexcept
+	{
+		std::swap(m_pDllObject, other.m_pDllObject);
+		std::swap(m_pDllPinCount, other.m_pDllPinCount);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object.
+	* @returns		T*						Pointer to DLL object (reference is not added).
+	******************************************************************************************************/
+	T* Get() const noexcept
+	{
+		return m_pDllObject;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Member access operator.
+	* @returns		T*						Pointer to DLL object.
+	******************************************************************************************************/
+	T* operator-> () const noexcept
+	{
+		return m_pDllObject;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Dereference operator.
+	* @returns		T&						Reference to DLL object.
+	******************************************************************************************************/
+	T& operator* () const noexcept
+	{
+		return *m_pDllObject;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Bool operator.
+	* @retval		true					When pointer is not empty.
+	* @retval		false					When pointer is empty.
+	******************************************************************************************************/
+	explicit operator bool() const noexcept
+	{
+		return m_pDllObject != nullptr;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Convert to shared pointer.
+	* @details		Returns shared pointer which holds copy of this pointer (one reference of DLL object or one
+	*					pin of its DLL) - it is released when all shared pointers are released.
+	* @returns		std::shared_ptr<T>	Shared pointer to DLL object (nullptr when this pointer is empty).
+	******************************************************************************************************/
+	std::shared_ptr<T> ToSharedPtr() const
+	{
+		if (!m_pDllObject)
+		{
+			return nullptr;
+		}
+
+		MsvDllObjectPtr dllObject(*this);
+		return std::shared_ptr<T>(m_pDllObject, [dllObject](T*) mutable
+		{
+			dllObject.Reset();
+		});
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief			Add reference.
+	* @details		Adds pin of DLL (pointer returned by DLL factory) or reference of DLL object.
+	******************************************************************************************************/
+	void AddReference() const noexcept
+	{
+		if (m_pDllPinCount)
+		{
+			m_pDllPinCount->fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (m_pDllObject)
+		{
+			m_pDllObject->AddDllReference();
+		}
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Release reference.
+	* @details		Releases pin of DLL (pointer returned by DLL factory) or reference of DLL object.
+	******************************************************************************************************/
+	void ReleaseReference() const noexcept
+	{
+		if (m_pDllPinCount)
+		{
+			m_pDllPinCount->fetch_sub(1, std::memory_order_release);
+		}
+		else if (m_pDllObject)
+		{
+			m_pDllObject->ReleaseDllReference();
+		}
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		DLL object.
+	* @details	Pointer to referenced DLL object.
+	******************************************************************************************************/
+	T* m_pDllObject;
+
+	/**************************************************************************************************//**
+	* @brief		DLL pin count.
+	* @details	Pin count of DLL kept by DLL factory (nullptr when pointer counts references of object).
+	******************************************************************************************************/
+	std::atomic<std::int64_t>* m_pDllPinCount;
+};
+
+
+/**************************************************************************************************//**
+* @brief			Static cast.
+* @details		Casts pointer to other type - reference (or pin) of origin is taken, so no counter is
+*					changed.
+* @param[in]	dllObject				Casted pointer (it is empty then).
+* @returns		MsvDllObjectPtr<T>	Casted pointer.
+******************************************************************************************************/
+template<class T, class U>
+inline MsvDllObjectPtr<T> MsvStaticDllObjectCast(MsvDllObjectPtr<U>&& dllObject) noexcept
+{
+	MsvDllObjectPtr<T> castedDllObject;
+	castedDllObject.m_pDllObject = static_cast<T*>(dllObject.m_pDllObject);
+	castedDllObject.m_pDllPinCount = dllObject.m_pDllPinCount;
+	dllObject.m_pDllObject = nullptr;
+	dllObject.m_pDllPinCount = nullptr;
+
+	return castedDllObject;
+}
+
+
+/**************************************************************************************************//**
+* @brief			Equal operator.
+* @param[in]	left						Left pointer.
+* @param[in]	right						Right pointer.
+* @retval		true						When both pointers point to same DLL object.
+* @retval		false						When pointers point to different DLL objects.
+******************************************************************************************************/
+template<class T, class U>
+inline bool operator== (const MsvDllObjectPtr<T>& left, const MsvDllObjectPtr<U>& right) noexcept
+{
+	return left.Get() == right.Get();
+}
+
+/**************************************************************************************************//**
+* @brief			Not equal operator.
+* @param[in]	left						Left pointer.
+* @param[in]	right						Right pointer.
+* @retval		true						When pointers point to different DLL objects.
+* @retval		false						When both pointers point to same DLL object.
+******************************************************************************************************/
+template<class T, class U>
+inline bool operator!= (const MsvDllObjectPtr<T>& left, const MsvDllObjectPtr<U>& right) noexcept
+{
+	return left.Get() != right.Get();
+}
+
+
+#endif // MARSTECH_DLLOBJECTPTR_H
+
+/** @} */	//End of group MDLLFACTORY.
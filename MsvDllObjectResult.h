@@ -0,0 +1,136 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Object Result
+* @details		Contains definition of @ref MsvDllObjectResult and @ref MsvDllObjectCallback.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef MARSTECH_DLLOBJECTRESULT_H
+#define MARSTECH_DLLOBJECTRESULT_H
+
+
+#include "IMsvDllObject.h"
+
+#include "mheaders/MsvCompiler.h"
+#include "merror/MsvErrorCodes.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <functional>
+#include <memory>
+
+MSV_ENABLE_WARNINGS
+
+
+#ifndef MSV_TIMEOUT_ERROR
+/**************************************************************************************************//**
+* @def			MSV_TIMEOUT_ERROR
+* @brief			Timeout error.
+* @details		Asynchronous request has not been completed before its deadline (it is defined here
+*					only when error codes library does not define it).
+******************************************************************************************************/
+#define MSV_TIMEOUT_ERROR -0x7FFF0001
+#endif // MSV_TIMEOUT_ERROR
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Object Callback.
+* @details	Completion callback of asynchronous DLL object request (error code and acquired DLL object).
+* @see		IMsvDllFactory::GetDllObjectAsync
+******************************************************************************************************/
+typedef std::function<void(MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>& spDllObject)> MsvDllObjectCallback;
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Object Result.
+* @details	Result of asynchronous DLL object request (value of its future).
+* @see		IMsvDllFactory::GetDllObjectAsync
+******************************************************************************************************/
+class MsvDllObjectResult
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates empty result.
+	******************************************************************************************************/
+	MsvDllObjectResult():
+		m_errorCode(MSV_NOT_INITIALIZED_ERROR)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @param[in]	errorCode			Request error code.
+	* @param[in]	spDllObject			Shared pointer to acquired DLL object (nullptr when request failed).
+	******************************************************************************************************/
+	MsvDllObjectResult(MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>& spDllObject):
+		m_errorCode(errorCode),
+		m_spDllObject(spDllObject)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get error code.
+	* @returns		MsvErrorCode								Request error code.
+	******************************************************************************************************/
+	MsvErrorCode GetErrorCode() const
+	{
+		return m_errorCode;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object.
+	* @returns		const std::shared_ptr<IMsvDllObject>&	Shared pointer to acquired DLL object (nullptr when request failed).
+	******************************************************************************************************/
+	const std::shared_ptr<IMsvDllObject>& GetDllObject() const
+	{
+		return m_spDllObject;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Error code.
+	* @details	Request error code.
+	******************************************************************************************************/
+	MsvErrorCode m_errorCode;
+
+	/**************************************************************************************************//**
+	* @brief		DLL object.
+	* @details	Shared pointer to acquired DLL object (nullptr when request failed).
+	******************************************************************************************************/
+	std::shared_ptr<IMsvDllObject> m_spDllObject;
+};
+
+
+#endif // MARSTECH_DLLOBJECTRESULT_H
+
+/** @} */	//End of group MDLLFACTORY.
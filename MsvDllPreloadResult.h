@@ -0,0 +1,187 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Preload Result
+* @details		Contains definition of @ref MsvDllPreloadResult.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef MARSTECH_DLLPRELOADRESULT_H
+#define MARSTECH_DLLPRELOADRESULT_H
+
+
+#include "mheaders/MsvCompiler.h"
+#include "merror/MsvErrorCodes.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Preload Result.
+* @details	Result of preloading one DLL (see IMsvDllFactory::Preload).
+******************************************************************************************************/
+class MsvDllPreloadResult
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates empty result.
+	******************************************************************************************************/
+	MsvDllPreloadResult():
+		m_errorCode(MSV_SUCCESS),
+		m_loadTime(0),
+		m_objectCount(0),
+		m_prefaultedPages(0),
+		m_prefaultTime(0)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @param[in]	dllPath				Path to DLL.
+	* @param[in]	errorCode			Preload error code (load error or first failed instantiation error).
+	* @param[in]	loadTime				Time of DLL load (and instantiation of its objects).
+	* @param[in]	objectCount			Count of instantiated DLL objects.
+	* @param[in]	prefaultedPages	Count of pages prefaulted by DLL load (see MSV_DLL_LOAD_PREFAULT).
+	* @param[in]	prefaultTime		Time of prefault (it is part of load time).
+	******************************************************************************************************/
+	MsvDllPreloadResult(const std::string& dllPath, MsvErrorCode errorCode, std::chrono::microseconds loadTime, std::uint32_t objectCount, std::uint64_t prefaultedPages, std::chrono::microseconds prefaultTime):
+		m_dllPath(dllPath),
+		m_errorCode(errorCode),
+		m_loadTime(loadTime),
+		m_objectCount(objectCount),
+		m_prefaultedPages(prefaultedPages),
+		m_prefaultTime(prefaultTime)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL path.
+	* @returns		const std::string&				Path to DLL.
+	******************************************************************************************************/
+	const std::string& GetDllPath() const
+	{
+		return m_dllPath;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get error code.
+	* @returns		MsvErrorCode						Preload error code (load error or first failed instantiation error).
+	******************************************************************************************************/
+	MsvErrorCode GetErrorCode() const
+	{
+		return m_errorCode;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get load time.
+	* @returns		std::chrono::microseconds		Time of DLL load (and instantiation of its objects).
+	******************************************************************************************************/
+	std::chrono::microseconds GetLoadTime() const
+	{
+		return m_loadTime;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get object count.
+	* @returns		std::uint32_t						Count of instantiated DLL objects.
+	******************************************************************************************************/
+	std::uint32_t GetObjectCount() const
+	{
+		return m_objectCount;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get prefaulted pages.
+	* @returns		std::uint64_t						Count of pages prefaulted by DLL load (0 when DLL has not been loaded with MSV_DLL_LOAD_PREFAULT option).
+	******************************************************************************************************/
+	std::uint64_t GetPrefaultedPages() const
+	{
+		return m_prefaultedPages;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get prefault time.
+	* @returns		std::chrono::microseconds		Time of prefault (it is part of load time).
+	******************************************************************************************************/
+	std::chrono::microseconds GetPrefaultTime() const
+	{
+		return m_prefaultTime;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		DLL path.
+	* @details	Path to preloaded DLL.
+	******************************************************************************************************/
+	std::string m_dllPath;
+
+	/**************************************************************************************************//**
+	* @brief		Error code.
+	* @details	Preload error code (load error or first failed instantiation error).
+	******************************************************************************************************/
+	MsvErrorCode m_errorCode;
+
+	/**************************************************************************************************//**
+	* @brief		Load time.
+	* @details	Time of DLL load (and instantiation of its objects).
+	******************************************************************************************************/
+	std::chrono::microseconds m_loadTime;
+
+	/**************************************************************************************************//**
+	* @brief		Object count.
+	* @details	Count of instantiated DLL objects.
+	******************************************************************************************************/
+	std::uint32_t m_objectCount;
+
+	/**************************************************************************************************//**
+	* @brief		Prefaulted pages.
+	* @details	Count of pages prefaulted by DLL load.
+	******************************************************************************************************/
+	std::uint64_t m_prefaultedPages;
+
+	/**************************************************************************************************//**
+	* @brief		Prefault time.
+	* @details	Time of prefault (it is part of load time).
+	******************************************************************************************************/
+	std::chrono::microseconds m_prefaultTime;
+};
+
+
+#endif // MARSTECH_DLLPRELOADRESULT_H
+
+/** @} */	//End of group MDLLFACTORY.
@@ -0,0 +1,267 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Reclaimer
+* @details		Contains implementation of @ref MsvDllReclaimer.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "MsvDllReclaimer.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_RECLAIMER_SPIN_COUNT
+* @brief			Count of yields.
+* @details		Grace period yields this count of times before it starts to sleep (most of read-side
+*					sections are short).
+******************************************************************************************************/
+#define MSV_DLL_RECLAIMER_SPIN_COUNT 64
+
+
+/**************************************************************************************************//**
+* @brief		Reader thread count.
+* @details	Source of reader slots (threads are assigned to slots round-robin).
+******************************************************************************************************/
+static std::atomic<std::uint32_t> g_readerThreadCount(0);
+
+
+/********************************************************************************************************************************
+*															Constructors and destructors
+********************************************************************************************************************************/
+
+
+MsvDllReclaimer::MsvDllReclaimer():
+	m_epoch(0),
+	m_gracePeriodCount(0),
+	m_gracePeriodPending(false),
+	m_pendingEpochIndex(0)
+{
+	for (std::uint32_t slot = 0; slot < MSV_DLL_RECLAIMER_SLOT_COUNT; ++slot)
+	{
+		m_slots[slot].readers[0].store(0, std::memory_order_relaxed);
+		m_slots[slot].readers[1].store(0, std::memory_order_relaxed);
+	}
+}
+
+MsvDllReclaimer::~MsvDllReclaimer()
+{
+	//there are no readers anymore - all retired objects can be deleted
+	for (std::vector<MsvRetiredObject>::iterator it = m_retired.begin(); it != m_retired.end(); ++it)
+	{
+		it->deleter(it->pObject);
+	}
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllReclaimer public methods
+********************************************************************************************************************************/
+
+
+void MsvDllReclaimer::Enter(std::uint32_t& slot, std::uint32_t& epochIndex)
+{
+	//slot is assigned once per thread (it is shared by all reclaimers)
+	static thread_local std::uint32_t threadSlot = g_readerThreadCount.fetch_add(1, std::memory_order_relaxed) % MSV_DLL_RECLAIMER_SLOT_COUNT;
+
+	slot = threadSlot;
+	epochIndex = static_cast<std::uint32_t>(m_epoch.load() & 1);
+
+	for (;;)
+	{
+		m_slots[slot].readers[epochIndex].fetch_add(1);
+
+		//epoch is checked again after reader is counted - writer which has flipped it meanwhile might not see reader
+		std::uint32_t currentIndex = static_cast<std::uint32_t>(m_epoch.load() & 1);
+		if (currentIndex == epochIndex)
+		{
+			return;
+		}
+
+		m_slots[slot].readers[epochIndex].fetch_sub(1, std::memory_order_release);
+		epochIndex = currentIndex;
+	}
+}
+
+void MsvDllReclaimer::Leave(std::uint32_t slot, std::uint32_t epochIndex)
+{
+	m_slots[slot].readers[epochIndex].fetch_sub(1, std::memory_order_release);
+}
+
+void MsvDllReclaimer::Synchronize()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_writerLock);
+
+		//grace period started by reclaim is finished first (readers of both epoch indexes can't be waited for at once)
+		if (m_gracePeriodPending)
+		{
+			WaitForReaders(m_pendingEpochIndex);
+			m_gracePeriodPending = false;
+			m_gracePeriodCount.fetch_add(1);
+		}
+
+		//flip epoch - new readers are counted in other epoch index, so only readers of previous epoch are waited for
+		std::uint32_t epochIndex = static_cast<std::uint32_t>(m_epoch.fetch_add(1) & 1);
+		WaitForReaders(epochIndex);
+
+		m_gracePeriodCount.fetch_add(1);
+	}
+
+	//objects retired before this call can be deleted now
+	Reclaim();
+}
+
+void MsvDllReclaimer::Retire(void* pObject, void (*deleter)(void*))
+{
+	{
+		std::lock_guard<std::mutex> lock(m_retiredLock);
+
+		//object has been unpublished before epoch is read - readers of later epochs can't see it
+		m_retired.push_back(MsvRetiredObject{ pObject, deleter, m_epoch.load() });
+	}
+
+	Reclaim();
+}
+
+void MsvDllReclaimer::Reclaim()
+{
+	std::vector<MsvRetiredObject> reclaimed;
+
+	{
+		//grace period is advanced by one writer only (others do not wait for it - they reclaim what is reclaimable now)
+		std::unique_lock<std::mutex> writerLock(m_writerLock, std::try_to_lock);
+		if (writerLock.owns_lock())
+		{
+			AdvanceGracePeriod();
+		}
+
+		std::lock_guard<std::mutex> lock(m_retiredLock);
+
+		//object is reclaimable when grace period which has flipped epoch of its retirement is finished
+		std::uint64_t gracePeriodCount = m_gracePeriodCount.load();
+		std::vector<MsvRetiredObject>::iterator it = std::find_if(m_retired.begin(), m_retired.end(), [gracePeriodCount](const MsvRetiredObject& retired) { return retired.epoch >= gracePeriodCount; });
+		reclaimed.assign(m_retired.begin(), it);
+		m_retired.erase(m_retired.begin(), it);
+	}
+
+	//deleters are called without locks (they may retire other objects)
+	for (std::vector<MsvRetiredObject>::iterator it = reclaimed.begin(); it != reclaimed.end(); ++it)
+	{
+		it->deleter(it->pObject);
+	}
+}
+
+std::size_t MsvDllReclaimer::GetRetiredCount() const
+{
+	std::lock_guard<std::mutex> lock(m_retiredLock);
+
+	return m_retired.size();
+}
+
+std::uint64_t MsvDllReclaimer::GetGracePeriodCount() const
+{
+	return m_gracePeriodCount.load(std::memory_order_relaxed);
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllReclaimer protected methods
+********************************************************************************************************************************/
+
+
+std::int64_t MsvDllReclaimer::CountReaders(std::uint32_t epochIndex) const
+{
+	std::int64_t readerCount = 0;
+
+	for (std::uint32_t slot = 0; slot < MSV_DLL_RECLAIMER_SLOT_COUNT; ++slot)
+	{
+		readerCount += m_slots[slot].readers[epochIndex].load();
+	}
+
+	return readerCount;
+}
+
+void MsvDllReclaimer::WaitForReaders(std::uint32_t epochIndex) const
+{
+	for (std::uint32_t spinCount = 0; CountReaders(epochIndex) != 0; ++spinCount)
+	{
+		if (spinCount < MSV_DLL_RECLAIMER_SPIN_COUNT)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+	}
+}
+
+void MsvDllReclaimer::AdvanceGracePeriod()
+{
+	//pending grace period is finished when its readers are gone
+	if (m_gracePeriodPending)
+	{
+		if (CountReaders(m_pendingEpochIndex) != 0)
+		{
+			return;
+		}
+
+		m_gracePeriodPending = false;
+		m_gracePeriodCount.fetch_add(1);
+	}
+
+	{
+		//new grace period is started only when some retired object waits for it
+		std::lock_guard<std::mutex> lock(m_retiredLock);
+		if (m_retired.empty() || m_retired.back().epoch < m_gracePeriodCount.load())
+		{
+			return;
+		}
+	}
+
+	m_pendingEpochIndex = static_cast<std::uint32_t>(m_epoch.fetch_add(1) & 1);
+	m_gracePeriodPending = true;
+
+	//readers which have entered before flip are usually gone already (read-side sections are short)
+	if (CountReaders(m_pendingEpochIndex) == 0)
+	{
+		m_gracePeriodPending = false;
+		m_gracePeriodCount.fetch_add(1);
+	}
+}
+
+
+/** @} */	//End of group MDLLFACTORY.
@@ -0,0 +1,359 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Reclaimer
+* @details		Contains definition of @ref MsvDllReclaimer and @ref MsvDllReadSection.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLRECLAIMER_H
+#define MARSTECH_DLLRECLAIMER_H
+
+
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_RECLAIMER_SLOT_COUNT
+* @brief			Count of reader slots.
+* @details		Readers are spread over slots by theirs threads (round-robin), so readers of different
+*					threads do not write the same cache line.
+******************************************************************************************************/
+#define MSV_DLL_RECLAIMER_SLOT_COUNT 64
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Reclaimer.
+* @details	Epoch-based reclamation of unloaded dynamic/shared libraries. Readers enter read-side
+*				section while they call into DLL objects - it costs one atomic increment and one atomic
+*				read (no lock). Writer (DLL factory) detaches DLL first and then waits for grace period
+*				(all read-side sections which might have seen detached DLL are left) before it unloads
+*				DLL. Readers count themselves in current epoch - epoch is flipped by writer and writer
+*				waits until readers of previous epoch are gone (new readers are not waited for). Unpublished
+*				shared data (snapshots read inside sections) are retired - they are deleted after grace period
+*				without waiting for it.
+* @note		Read-side sections can be nested (each @ref Enter must be paired with @ref Leave).
+* @warning		Grace period must not be waited for inside read-side section of the same thread (it
+*					would wait forever).
+******************************************************************************************************/
+class MsvDllReclaimer
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	******************************************************************************************************/
+	MsvDllReclaimer();
+
+	/**************************************************************************************************//**
+	* @brief			Virtual destructor.
+	******************************************************************************************************/
+	virtual ~MsvDllReclaimer();
+
+	/**************************************************************************************************//**
+	* @brief			Deleted copy constructor.
+	* @details		Copy constructor deleted -> copying is not allowed.
+	* @param[in]	origin			Reference to copyied object.
+	* @warning		Do not copy this object.
+	******************************************************************************************************/
+	MsvDllReclaimer(const MsvDllReclaimer& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Deleted assign operator.
+	* @details		Assign operator deleted -> assign is not allowed.
+	* @param[in]	origin			Reference to assigned object.
+	* @warning		Do not assign this object.
+	******************************************************************************************************/
+	MsvDllReclaimer& operator= (const MsvDllReclaimer& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Enter read-side section.
+	* @details		Counts reader in current epoch (lock-free). DLLs which have not been detached before
+	*					this call are not unloaded until @ref Leave is called.
+	* @param[out]	slot					Slot of reader (it must be passed to @ref Leave).
+	* @param[out]	epochIndex			Epoch index of reader (it must be passed to @ref Leave).
+	* @see			MsvDllReadSection
+	******************************************************************************************************/
+	void Enter(std::uint32_t& slot, std::uint32_t& epochIndex);
+
+	/**************************************************************************************************//**
+	* @brief			Leave read-side section.
+	* @details		Uncounts reader (lock-free) - waiting writer is released by last reader of its epoch.
+	* @param[in]	slot					Slot of reader (from @ref Enter).
+	* @param[in]	epochIndex			Epoch index of reader (from @ref Enter).
+	******************************************************************************************************/
+	void Leave(std::uint32_t slot, std::uint32_t epochIndex);
+
+	/**************************************************************************************************//**
+	* @brief			Wait for grace period.
+	* @details		Waits until all read-side sections entered before this call are left. Writers are
+	*					serialized (each of them flips epoch and waits for its readers).
+	* @warning		It must not be called inside read-side section.
+	******************************************************************************************************/
+	void Synchronize();
+
+	/**************************************************************************************************//**
+	* @brief			Retire object.
+	* @details		Object is deleted by deleter after grace period (when all read-side sections which might
+	*					have seen it are left). It never waits - retired objects are deleted by later
+	*					@ref Retire, @ref Reclaim and @ref Synchronize calls (or by destructor), so it can be called
+	*					inside read-side section and under locks which readers wait for.
+	* @param[in]	pObject				Pointer to retired object (it must be unpublished before this call).
+	* @param[in]	deleter				Deleter of retired object.
+	******************************************************************************************************/
+	void Retire(void* pObject, void (*deleter)(void*));
+
+	/**************************************************************************************************//**
+	* @brief			Retire object.
+	* @details		Retires object which is deleted by delete operator (see @ref Retire).
+	* @param[in]	pObject				Pointer to retired object (nullptr is ignored).
+	******************************************************************************************************/
+	template<class T>
+	void Retire(const T* pObject)
+	{
+		if (pObject)
+		{
+			Retire(const_cast<T*>(pObject), &MsvDllReclaimer::DeleteRetired<T>);
+		}
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Reclaim retired objects.
+	* @details		Deletes retired objects whose grace period has passed. It does not wait for readers - it
+	*					only starts (or finishes) grace period when readers of previous epoch are gone.
+	******************************************************************************************************/
+	void Reclaim();
+
+	/**************************************************************************************************//**
+	* @brief			Get retired count.
+	* @details		Returns count of retired objects which have not been deleted yet (for diagnostics).
+	* @returns		std::size_t				Count of retired objects.
+	******************************************************************************************************/
+	std::size_t GetRetiredCount() const;
+
+	/**************************************************************************************************//**
+	* @brief			Get grace period count.
+	* @details		Returns count of finished grace periods (for diagnostics).
+	* @returns		std::uint64_t			Count of finished grace periods.
+	******************************************************************************************************/
+	std::uint64_t GetGracePeriodCount() const;
+
+protected:
+	/**************************************************************************************************//**
+	* @brief			Count readers.
+	* @details		Sums readers of epoch index over all slots.
+	* @param[in]	epochIndex			Epoch index.
+	* @returns		std::int64_t			Count of readers in epoch index.
+	******************************************************************************************************/
+	std::int64_t CountReaders(std::uint32_t epochIndex) const;
+
+	/**************************************************************************************************//**
+	* @brief			Wait for readers.
+	* @details		Waits until readers of epoch index are gone (it yields first and then it sleeps).
+	* @param[in]	epochIndex			Epoch index.
+	******************************************************************************************************/
+	void WaitForReaders(std::uint32_t epochIndex) const;
+
+	/**************************************************************************************************//**
+	* @brief			Advance grace period.
+	* @details		Finishes pending grace period and starts new one (when some retired object waits for it)
+	*					if readers of its epoch are gone - it never waits for them.
+	* @warning		Writer lock must be held.
+	******************************************************************************************************/
+	void AdvanceGracePeriod();
+
+	/**************************************************************************************************//**
+	* @brief			Delete retired object.
+	* @details		Deleter of objects retired by typed @ref Retire.
+	* @param[in]	pObject				Pointer to retired object.
+	******************************************************************************************************/
+	template<class T>
+	static void DeleteRetired(void* pObject)
+	{
+		delete static_cast<T*>(pObject);
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Reader slot.
+	* @details	Reader counters of both epoch indexes (padded to cache line, so slots of different
+	*				threads do not share it).
+	******************************************************************************************************/
+	struct MsvReaderSlot
+	{
+		std::atomic<std::int64_t> readers[2];			///< Reader counters of even and odd epoch.
+		char padding[64 - 2 * sizeof(std::atomic<std::int64_t>)];	///< Padding to cache line.
+	};
+
+	/**************************************************************************************************//**
+	* @brief		Retired object.
+	* @details	Object which is deleted after grace period of its epoch.
+	******************************************************************************************************/
+	struct MsvRetiredObject
+	{
+		void* pObject;						///< Pointer to retired object.
+		void (*deleter)(void*);			///< Deleter of retired object.
+		std::uint64_t epoch;				///< Epoch of retirement (grace period which flips it must be finished).
+	};
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Epoch.
+	* @details	Current epoch (its lowest bit is epoch index of new readers).
+	******************************************************************************************************/
+	std::atomic<std::uint64_t> m_epoch;
+
+	/**************************************************************************************************//**
+	* @brief		Reader slots.
+	* @details	Counters of readers (see @ref MsvReaderSlot).
+	******************************************************************************************************/
+	MsvReaderSlot m_slots[MSV_DLL_RECLAIMER_SLOT_COUNT];
+
+	/**************************************************************************************************//**
+	* @brief		Writer lock.
+	* @details	Serializes writers (grace periods).
+	******************************************************************************************************/
+	std::mutex m_writerLock;
+
+	/**************************************************************************************************//**
+	* @brief		Grace period count.
+	* @details	Count of finished grace periods.
+	******************************************************************************************************/
+	std::atomic<std::uint64_t> m_gracePeriodCount;
+
+	/**************************************************************************************************//**
+	* @brief		Grace period pending flag.
+	* @details	True when epoch has been flipped by @ref Reclaim and readers of previous epoch have not been
+	*				gone yet (it is guarded by @ref m_writerLock).
+	******************************************************************************************************/
+	bool m_gracePeriodPending;
+
+	/**************************************************************************************************//**
+	* @brief		Pending epoch index.
+	* @details	Epoch index whose readers are waited for by pending grace period (it is guarded by
+	*				@ref m_writerLock).
+	******************************************************************************************************/
+	std::uint32_t m_pendingEpochIndex;
+
+	/**************************************************************************************************//**
+	* @brief		Retired objects.
+	* @details	Objects waiting for grace period (ordered by epoch of retirement).
+	******************************************************************************************************/
+	std::vector<MsvRetiredObject> m_retired;
+
+	/**************************************************************************************************//**
+	* @brief		Retired lock.
+	* @details	Guards @ref m_retired (it is locked after @ref m_writerLock when both are needed).
+	******************************************************************************************************/
+	mutable std::mutex m_retiredLock;
+};
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Read Section.
+* @details	Read-side section of @ref MsvDllReclaimer (RAII) - DLL objects (and theirs code) acquired
+*				before or inside section stay valid until section is left, even when theirs DLL is being
+*				released by other thread.
+* @code
+*	{
+*		MsvDllReadSection readSection(spDllFactory->GetDllReclaimer());
+*		spDllObject->DoWork();
+*	}
+* @endcode
+******************************************************************************************************/
+class MsvDllReadSection
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Enters read-side section.
+	* @param[in]	reclaimer			DLL reclaimer (it must outlive section).
+	******************************************************************************************************/
+	explicit MsvDllReadSection(MsvDllReclaimer& reclaimer):
+		m_reclaimer(reclaimer)
+	{
+		m_reclaimer.Enter(m_slot, m_epochIndex);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Destructor.
+	* @details		Leaves read-side section.
+	******************************************************************************************************/
+	~MsvDllReadSection()
+	{
+		m_reclaimer.Leave(m_slot, m_epochIndex);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Deleted copy constructor.
+	* @details		Copy constructor deleted -> copying is not allowed.
+	* @param[in]	origin			Reference to copyied object.
+	* @warning		Do not copy this object.
+	******************************************************************************************************/
+	MsvDllReadSection(const MsvDllReadSection& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Deleted assign operator.
+	* @details		Assign operator deleted -> assign is not allowed.
+	* @param[in]	origin			Reference to assigned object.
+	* @warning		Do not assign this object.
+	******************************************************************************************************/
+	MsvDllReadSection& operator= (const MsvDllReadSection& origin) = delete;
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		DLL reclaimer.
+	* @details	Reclaimer of entered section.
+	******************************************************************************************************/
+	MsvDllReclaimer& m_reclaimer;
+
+	/**************************************************************************************************//**
+	* @brief		Slot.
+	* @details	Slot of reader.
+	******************************************************************************************************/
+	std::uint32_t m_slot;
+
+	/**************************************************************************************************//**
+	* @brief		Epoch index.
+	* @details	Epoch index of reader.
+	******************************************************************************************************/
+	std::uint32_t m_epochIndex;
+};
+
+
+#endif // MARSTECH_DLLRECLAIMER_H
+
+/** @} */	//End of group MDLLFACTORY.
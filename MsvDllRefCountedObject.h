@@ -0,0 +1,156 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Reference Counted Object
+* @details		Contains definition of @ref MsvDllRefCountedObject.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLREFCOUNTEDOBJECT_H
+#define MARSTECH_DLLREFCOUNTEDOBJECT_H
+
+
+#include "IMsvDllObject.h"
+
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <atomic>
+#include <cstdint>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Reference Counted Object.
+* @details	Optional base of DLL objects with intrusive reference count. Count is member of object (it is
+*				next to virtual table pointer, so it is in same cache line as object itself) - references
+*				held by @ref MsvDllObjectPtr do not allocate any control block and object does not hold any
+*				lock nor shared pointer.
+* @see		MsvDllObjectPtr
+* @note		Object is created with one reference (it is owned by its creator). It is deleted by
+*				@ref DestroyDllObject (virtual method) when last reference is released, so it is deleted by
+*				code of DLL which has created it.
+* @note		Object acquired by DLL factory is owned by factory (one reference) until its DLL is released.
+*				Pointers returned by factory count pin of the DLL (it is kept by factory), not references of
+*				object - see IMsvDllFactory::GetRefCountedDllObject.
+******************************************************************************************************/
+class MsvDllRefCountedObject:
+	public IMsvDllObject
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates object with one reference (it is owned by its creator).
+	******************************************************************************************************/
+	MsvDllRefCountedObject():
+		m_referenceCount(1)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief		Virtual destructor.
+	******************************************************************************************************/
+	virtual ~MsvDllRefCountedObject() {}
+
+	/**************************************************************************************************//**
+	* @brief			Deleted copy constructor.
+	* @details		Copy constructor deleted -> copying is not allowed.
+	* @param[in]	origin			Reference to copyied object.
+	* @warning		Do not copy this object.
+	******************************************************************************************************/
+	MsvDllRefCountedObject(const MsvDllRefCountedObject& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Deleted assign operator.
+	* @details		Assign operator deleted -> assign is not allowed.
+	* @param[in]	origin			Reference to assigned object.
+	* @warning		Do not assign this object.
+	******************************************************************************************************/
+	MsvDllRefCountedObject& operator= (const MsvDllRefCountedObject& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Add reference.
+	* @details		Increments reference count of object.
+	******************************************************************************************************/
+	void AddDllReference() const noexcept
+	{
+		m_referenceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Release reference.
+	* @details		Decrements reference count of object and destroys object when it was last reference.
+	******************************************************************************************************/
+	void ReleaseDllReference() const noexcept
+	{
+		if (m_referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			DestroyDllObject();
+		}
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get reference count.
+	* @details		Returns exact count of references of this object (it might be changed by other threads
+	*					right after it is returned). Pointers returned by DLL factory are not counted here (they
+	*					count pin of DLL, factory holds one reference of object instead).
+	* @returns		std::int64_t		Reference count.
+	******************************************************************************************************/
+	std::int64_t GetDllReferenceCount() const noexcept
+	{
+		return m_referenceCount.load(std::memory_order_acquire);
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief			Destroy object.
+	* @details		Deletes object when its last reference is released. It is virtual method, so object is
+	*					deleted by code (and heap) of DLL which has created it.
+	* @note			Override it when object is not allocated by new (e.g. it is pooled).
+	******************************************************************************************************/
+	virtual void DestroyDllObject() const noexcept
+	{
+		delete this;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Reference count.
+	* @details	Count of references of this object.
+	******************************************************************************************************/
+	mutable std::atomic<std::int64_t> m_referenceCount;
+
+};
+
+
+#endif // MARSTECH_DLLREFCOUNTEDOBJECT_H
+
+/** @} */	//End of group MDLLFACTORY.
@@ -0,0 +1,62 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Shutdown Policy
+* @details		Contains definition of @ref MsvDllShutdownPolicy.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLSHUTDOWNPOLICY_H
+#define MARSTECH_DLLSHUTDOWNPOLICY_H
+
+
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <cstdint>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Shutdown Policy.
+* @details	Controls how DLLs which are still loaded are released by DLL factory destructor.
+* @see		MsvDllFactory::SetShutdownPolicy
+******************************************************************************************************/
+enum MsvDllShutdownPolicy: std::uint32_t
+{
+	MSV_DLL_SHUTDOWN_ORDERED = 0,		///< DLLs are uninitialized and unloaded one after another (default).
+	MSV_DLL_SHUTDOWN_PARALLEL,			///< DLLs are uninitialized by more threads at once (static destructors and unmapping are still serialized by loader lock of dynamic linker).
+	MSV_DLL_SHUTDOWN_LEAK				///< DLLs are detached without unloading - they stay in memory until process exits (like RTLD_NODELETE).
+};
+
+
+#endif // MARSTECH_DLLSHUTDOWNPOLICY_H
+
+/** @} */	//End of group MDLLFACTORY.
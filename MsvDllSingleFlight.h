@@ -0,0 +1,212 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Single Flight
+* @details		Contains implementation of @ref MsvDllSingleFlight.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLSINGLEFLIGHT_H
+#define MARSTECH_DLLSINGLEFLIGHT_H
+
+
+#include "merror/MsvError.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Single Flight.
+* @details	Coalesces concurrent operations with the same key (DLL load, DLL object creation, etc.).
+*				The first thread (leader) runs the operation, all other threads (waiters) wait for its
+*				result and get the same error code and result - there is no retry when it fails.
+* @note		It is not thread safe itself - @ref Join and @ref Leave must be called with locked owner
+*				lock (the same lock which guards owner's cache, so cache check and join are atomic).
+*				@ref MsvFlight methods are thread safe and must be called without owner lock.
+******************************************************************************************************/
+template<class T>
+class MsvDllSingleFlight
+{
+public:
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Flight.
+	* @details	One in-flight operation - holds its result when completed.
+	******************************************************************************************************/
+	class MsvFlight
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		******************************************************************************************************/
+		MsvFlight():
+			m_future(m_promise.get_future().share())
+		{
+
+		}
+
+		/**************************************************************************************************//**
+		* @brief			Deleted copy constructor.
+		* @details		Copy constructor deleted -> copying is not allowed.
+		* @param[in]	origin			Reference to copyied object.
+		* @warning		Do not copy this object.
+		******************************************************************************************************/
+		MsvFlight(const MsvFlight& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Deleted assign operator.
+		* @details		Assign operator deleted -> assign is not allowed.
+		* @param[in]	origin			Reference to assigned object.
+		* @warning		Do not assign this object.
+		******************************************************************************************************/
+		MsvFlight& operator= (const MsvFlight& origin) = delete;
+
+		/**************************************************************************************************//**
+		* @brief			Complete flight.
+		* @details		Stores result of operation and wakes up all waiters. Must be called exactly once by leader.
+		* @param[in]	errorCode			Error code of operation.
+		* @param[in]	result				Result of operation.
+		******************************************************************************************************/
+		void Complete(MsvErrorCode errorCode, const T& result)
+		{
+			m_promise.set_value(std::make_pair(errorCode, result));
+		}
+
+		/**************************************************************************************************//**
+		* @brief			Wait for flight.
+		* @details		Waits until leader completes the operation and returns its result.
+		* @param[out]	result				Result of operation.
+		* @returns		MsvErrorCode		Error code of operation.
+		******************************************************************************************************/
+		MsvErrorCode Wait(T& result) const
+		{
+			const std::pair<MsvErrorCode, T>& flightResult = m_future.get();
+			result = flightResult.second;
+
+			return flightResult.first;
+		}
+
+		/**************************************************************************************************//**
+		* @brief			Wait for flight.
+		* @details		Waits until leader completes the operation.
+		* @returns		MsvErrorCode		Error code of operation.
+		******************************************************************************************************/
+		MsvErrorCode Wait() const
+		{
+			return m_future.get().first;
+		}
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		Flight promise.
+		* @details	Set by leader when the operation is completed.
+		******************************************************************************************************/
+		std::promise<std::pair<MsvErrorCode, T>> m_promise;
+
+		/**************************************************************************************************//**
+		* @brief		Flight future.
+		* @details	Shared by all waiters.
+		******************************************************************************************************/
+		std::shared_future<std::pair<MsvErrorCode, T>> m_future;
+	};
+
+public:
+	/**************************************************************************************************//**
+	* @brief			Join flight.
+	* @details		Returns in-flight operation with the key. Starts new flight when there is no in-flight
+	*					operation with the key - caller is leader then and must run the operation, call
+	*					@ref Leave and @ref MsvFlight::Complete.
+	* @param[in]	key					Operation key.
+	* @param[out]	leader				Flag if caller is leader (true) or waiter (false).
+	* @returns		std::shared_ptr<MsvFlight>		Shared pointer to flight (nullptr when allocation failed).
+	* @warning		Must be called with locked owner lock.
+	******************************************************************************************************/
+	std::shared_ptr<MsvFlight> Join(const char* key, bool& leader)
+	{
+		typename std::map<std::string, std::shared_ptr<MsvFlight>, std::less<>>::iterator it = m_flights.find(key);
+		if (it != m_flights.end())
+		{
+			leader = false;
+			return it->second;
+		}
+
+		std::shared_ptr<MsvFlight> spFlight(new (std::nothrow) MsvFlight());
+		if (spFlight)
+		{
+			m_flights[key] = spFlight;
+		}
+
+		leader = true;
+		return spFlight;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Leave flight.
+	* @details		Removes flight with the key (new callers start new flight then).
+	* @param[in]	key					Operation key.
+	* @warning		Must be called with locked owner lock.
+	******************************************************************************************************/
+	void Leave(const char* key)
+	{
+		typename std::map<std::string, std::shared_ptr<MsvFlight>, std::less<>>::iterator it = m_flights.find(key);
+		if (it != m_flights.end())
+		{
+			m_flights.erase(it);
+		}
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get any flight.
+	* @details		Returns any in-flight operation.
+	* @returns		std::shared_ptr<MsvFlight>		Shared pointer to flight (nullptr when there is no flight).
+	* @warning		Must be called with locked owner lock.
+	******************************************************************************************************/
+	std::shared_ptr<MsvFlight> GetAnyFlight() const
+	{
+		return m_flights.empty() ? nullptr : m_flights.begin()->second;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		In-flight operations.
+	* @details	Maps operation key to in-flight operation.
+	******************************************************************************************************/
+	std::map<std::string, std::shared_ptr<MsvFlight>, std::less<>> m_flights;
+};
+
+
+#endif // MARSTECH_DLLSINGLEFLIGHT_H
+
+/** @} */	//End of group MDLLFACTORY.
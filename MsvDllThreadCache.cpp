@@ -0,0 +1,142 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Thread Cache
+* @details		Contains implementation of @ref MsvDllThreadCache.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "MsvDllThreadCache.h"
+
+
+/********************************************************************************************************************************
+*															MsvDllThreadCache::MsvDllThreadCacheEntry implementation
+********************************************************************************************************************************/
+
+
+MsvDllThreadCache::MsvDllThreadCacheEntry::MsvDllThreadCacheEntry(const std::shared_ptr<IMsvDllObject>& spDllObject):
+	m_wpDllObject(spDllObject)
+{
+
+}
+
+bool MsvDllThreadCache::MsvDllThreadCacheEntry::GetDllObject(std::shared_ptr<IMsvDllObject>& spDllObject) const
+{
+	//caller already holds cached object (weak pointer keeps control block, so no other object can share its address) -> nothing to do
+	if (spDllObject && !spDllObject.owner_before(m_wpDllObject) && !m_wpDllObject.owner_before(spDllObject))
+	{
+		return true;
+	}
+
+	return (spDllObject = m_wpDllObject.lock()) ? true : false;
+}
+
+
+/********************************************************************************************************************************
+*															Constructors and destructors
+********************************************************************************************************************************/
+
+
+MsvDllThreadCache::MsvDllThreadCache():
+	m_epoch(0)
+{
+
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllThreadCache public methods
+********************************************************************************************************************************/
+
+
+bool MsvDllThreadCache::GetDllObject(const char* id, std::uint64_t epoch, std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	CheckEpoch(epoch);
+
+	std::map<std::string, MsvDllThreadCacheEntry, std::less<>>::const_iterator it = m_dllObjectsByName.find(id);
+
+	return it != m_dllObjectsByName.end() && it->second.GetDllObject(spDllObject);
+}
+
+bool MsvDllThreadCache::GetDllObject(const MsvDllId& id, std::uint64_t epoch, std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	CheckEpoch(epoch);
+
+	std::unordered_map<MsvDllId, MsvDllThreadCacheEntry>::const_iterator it = m_dllObjectsById.find(id);
+
+	return it != m_dllObjectsById.end() && it->second.GetDllObject(spDllObject);
+}
+
+void MsvDllThreadCache::CacheDllObject(const char* id, const MsvDllId& dllId, std::uint64_t epoch, const std::shared_ptr<IMsvDllObject>& spDllObject)
+{
+	//when DLL has been released since object was acquired, next lookup sees newer epoch and clears it
+	CheckEpoch(epoch);
+
+	std::map<std::string, MsvDllThreadCacheEntry, std::less<>>::iterator it = m_dllObjectsByName.find(id);
+	if (it != m_dllObjectsByName.end())
+	{
+		it->second = MsvDllThreadCacheEntry(spDllObject);
+	}
+	else
+	{
+		m_dllObjectsByName.emplace(id, MsvDllThreadCacheEntry(spDllObject));
+	}
+
+	if (dllId.Valid())
+	{
+		std::unordered_map<MsvDllId, MsvDllThreadCacheEntry>::iterator idIt = m_dllObjectsById.find(dllId);
+		if (idIt != m_dllObjectsById.end())
+		{
+			idIt->second = MsvDllThreadCacheEntry(spDllObject);
+		}
+		else
+		{
+			m_dllObjectsById.emplace(dllId, MsvDllThreadCacheEntry(spDllObject));
+		}
+	}
+}
+
+
+/********************************************************************************************************************************
+*															MsvDllThreadCache protected methods
+********************************************************************************************************************************/
+
+
+void MsvDllThreadCache::CheckEpoch(std::uint64_t epoch)
+{
+	if (m_epoch != epoch)
+	{
+		//factory has changed (DLL has been released or loaded) -> all cached objects are stale
+		m_dllObjectsByName.clear();
+		m_dllObjectsById.clear();
+		m_epoch = epoch;
+	}
+}
+
+
+/** @} */	//End of group MDLLFACTORY.
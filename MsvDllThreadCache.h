@@ -0,0 +1,186 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Thread Cache
+* @details		Contains definition of @ref MsvDllThreadCache.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLTHREADCACHE_H
+#define MARSTECH_DLLTHREADCACHE_H
+
+
+#include "IMsvDllObject.h"
+#include "MsvDllId.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Thread Cache.
+* @details	Per thread cache of already acquired DLL objects (owned by one thread, used by one DLL
+*				factory). It is invalidated by factory epoch - whole cache is cleared by owner thread when
+*				factory epoch has changed since objects were cached (each DLL release changes it).
+* @note		It holds weak pointers only, so it does not hold DLL objects alive (cached object does not
+*				block release of its DLL). Control blocks of DLL objects are allocated by executable (see
+*				IMsvDll::GetDllObject), so stale weak pointers might outlive unloaded DLL.
+* @note		It is used by owner thread only - it has no lock and it does not touch memory shared by
+*				more threads when caller already holds cached object.
+******************************************************************************************************/
+class MsvDllThreadCache
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	******************************************************************************************************/
+	MsvDllThreadCache();
+
+	/**************************************************************************************************//**
+	* @brief			Deleted copy constructor.
+	* @details		Copy constructor deleted -> copying is not allowed.
+	* @param[in]	origin			Reference to copyied object.
+	* @warning		Do not copy this object.
+	******************************************************************************************************/
+	MsvDllThreadCache(const MsvDllThreadCache& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Deleted assign operator.
+	* @details		Assign operator deleted -> assign is not allowed.
+	* @param[in]	origin			Reference to assigned object.
+	* @warning		Do not assign this object.
+	******************************************************************************************************/
+	MsvDllThreadCache& operator= (const MsvDllThreadCache& origin) = delete;
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object.
+	* @details		Returns cached DLL object. When spDllObject already holds the cached object, it is
+	*					not touched at all (no reference count change).
+	* @param[in]	id					DLL (object) id.
+	* @param[in]	epoch				Current factory epoch (cache is cleared when it is different).
+	* @param[in,out]	spDllObject	Shared pointer to DLL object.
+	* @retval		true				When DLL object has been found and it is alive.
+	* @retval		false				Otherwise.
+	******************************************************************************************************/
+	bool GetDllObject(const char* id, std::uint64_t epoch, std::shared_ptr<IMsvDllObject>& spDllObject);
+
+	/**************************************************************************************************//**
+	* @brief			Get DLL object.
+	* @details		Same as @ref GetDllObject(const char* id, std::uint64_t epoch, std::shared_ptr<IMsvDllObject>& spDllObject),
+	*					but DLL (object) id is binary GUID.
+	* @param[in]	id					Binary DLL (object) id.
+	* @param[in]	epoch				Current factory epoch (cache is cleared when it is different).
+	* @param[in,out]	spDllObject	Shared pointer to DLL object.
+	* @retval		true				When DLL object has been found and it is alive.
+	* @retval		false				Otherwise.
+	******************************************************************************************************/
+	bool GetDllObject(const MsvDllId& id, std::uint64_t epoch, std::shared_ptr<IMsvDllObject>& spDllObject);
+
+	/**************************************************************************************************//**
+	* @brief			Cache DLL object.
+	* @details		Caches DLL object by string id and by binary id (when it is valid). DLL object is cached
+	*					in epoch loaded before it was acquired - it is removed by next lookup when factory epoch
+	*					has changed meanwhile.
+	* @param[in]	id					DLL (object) id.
+	* @param[in]	dllId				Binary DLL (object) id (it is invalid when id is not braced GUID).
+	* @param[in]	epoch				Factory epoch loaded before DLL object was acquired.
+	* @param[in]	spDllObject		Shared pointer to DLL object.
+	******************************************************************************************************/
+	void CacheDllObject(const char* id, const MsvDllId& dllId, std::uint64_t epoch, const std::shared_ptr<IMsvDllObject>& spDllObject);
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		MarsTech DLL Thread Cache Entry.
+	* @details	Cached DLL object.
+	******************************************************************************************************/
+	class MsvDllThreadCacheEntry
+	{
+	public:
+		/**************************************************************************************************//**
+		* @brief			Constructor.
+		* @param[in]	spDllObject			Shared pointer to DLL object.
+		******************************************************************************************************/
+		MsvDllThreadCacheEntry(const std::shared_ptr<IMsvDllObject>& spDllObject);
+
+		/**************************************************************************************************//**
+		* @brief			Get DLL object.
+		* @details		Returns DLL object when it is still alive. When spDllObject shares control block with
+		*					cached weak pointer, only control block addresses are compared (reference counts are
+		*					not touched).
+		* @param[in,out]	spDllObject		Shared pointer to DLL object (it is not touched when it already holds the object).
+		* @retval		true					When DLL object is alive.
+		* @retval		false					When DLL object has already expired.
+		******************************************************************************************************/
+		bool GetDllObject(std::shared_ptr<IMsvDllObject>& spDllObject) const;
+
+	protected:
+		/**************************************************************************************************//**
+		* @brief		DLL object.
+		* @details	Weak pointer to DLL object.
+		******************************************************************************************************/
+		std::weak_ptr<IMsvDllObject> m_wpDllObject;
+	};
+
+	/**************************************************************************************************//**
+	* @brief			Check epoch.
+	* @details		Clears cache when factory epoch has changed.
+	* @param[in]	epoch				Current factory epoch.
+	******************************************************************************************************/
+	void CheckEpoch(std::uint64_t epoch);
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Cache epoch.
+	* @details	Factory epoch of cached objects.
+	******************************************************************************************************/
+	std::uint64_t m_epoch;
+
+	/**************************************************************************************************//**
+	* @brief		DLL objects by name.
+	* @details	Cached DLL objects by string id.
+	******************************************************************************************************/
+	std::map<std::string, MsvDllThreadCacheEntry, std::less<>> m_dllObjectsByName;
+
+	/**************************************************************************************************//**
+	* @brief		DLL objects by id.
+	* @details	Cached DLL objects by binary id.
+	******************************************************************************************************/
+	std::unordered_map<MsvDllId, MsvDllThreadCacheEntry> m_dllObjectsById;
+};
+
+
+#endif // MARSTECH_DLLTHREADCACHE_H
+
+/** @} */	//End of group MDLLFACTORY.
@@ -0,0 +1,138 @@
+/**************************************************************************************************//**
+* @addtogroup	MDLLFACTORY
+* @{
+******************************************************************************************************/
+
+/**************************************************************************************************//**
+* @file
+* @brief			MarsTech Dll Token
+* @details		Contains definition of @ref MsvDllToken.
+* @author		Martin Svoboda
+* @date			16.10.2026
+* @copyright	GNU General Public License (GPLv3).
+******************************************************************************************************/
+
+
+/*
+This file is part of MarsTech Dll Factory.
+
+MarsTech Dependency Injection is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+MarsTech Promise Like Syntax is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MARSTECH_DLLTOKEN_H
+#define MARSTECH_DLLTOKEN_H
+
+
+#include "mheaders/MsvCompiler.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <cstdint>
+
+MSV_ENABLE_WARNINGS
+
+
+/**************************************************************************************************//**
+* @def			MSV_DLL_TOKEN_INVALID_INDEX
+* @brief			Invalid token index.
+* @details		Index of token which has not been resolved.
+******************************************************************************************************/
+#define MSV_DLL_TOKEN_INVALID_INDEX 0xFFFFFFFF
+
+
+/**************************************************************************************************//**
+* @brief		MarsTech DLL Token.
+* @details	Pre-resolved DLL (object) id - it is index to dense token table of DLL factory which
+*				created it (see IMsvDllFactory::Resolve). Token is valid for whole life of DLL factory
+*				(even when DLL is released and loaded again), but it must not be used with other factory.
+******************************************************************************************************/
+class MsvDllToken
+{
+public:
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @details		Creates invalid token.
+	******************************************************************************************************/
+	constexpr MsvDllToken():
+		m_index(MSV_DLL_TOKEN_INVALID_INDEX)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Constructor.
+	* @param[in]	index				Index to token table.
+	******************************************************************************************************/
+	constexpr explicit MsvDllToken(std::uint32_t index):
+		m_index(index)
+	{
+
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Valid check.
+	* @details		Returns flag if token has been resolved (true) or not (false).
+	* @retval		true		When valid.
+	* @retval		false		When invalid.
+	******************************************************************************************************/
+	constexpr bool Valid() const
+	{
+		return m_index != MSV_DLL_TOKEN_INVALID_INDEX;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Get index.
+	* @details		Returns index to token table.
+	* @returns		std::uint32_t		Index to token table.
+	******************************************************************************************************/
+	constexpr std::uint32_t GetIndex() const
+	{
+		return m_index;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Equal operator.
+	* @param[in]	other				Compared token.
+	* @retval		true				When tokens are equal.
+	* @retval		false				When tokens are not equal.
+	******************************************************************************************************/
+	constexpr bool operator== (const MsvDllToken& other) const
+	{
+		return m_index == other.m_index;
+	}
+
+	/**************************************************************************************************//**
+	* @brief			Not equal operator.
+	* @param[in]	other				Compared token.
+	* @retval		true				When tokens are not equal.
+	* @retval		false				When tokens are equal.
+	******************************************************************************************************/
+	constexpr bool operator!= (const MsvDllToken& other) const
+	{
+		return m_index != other.m_index;
+	}
+
+protected:
+	/**************************************************************************************************//**
+	* @brief		Token index.
+	* @details	Index to token table.
+	******************************************************************************************************/
+	std::uint32_t m_index;
+};
+
+
+#endif // MARSTECH_DLLTOKEN_H
+
+/** @} */	//End of group MDLLFACTORY.
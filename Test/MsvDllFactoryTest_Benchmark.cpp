@@ -0,0 +1,785 @@
+#include "pch.h"
+
+
+#include "mdllfactory/MsvDllAdapter.h"
+#include "mdllfactory/MsvDllFactory.h"
+#include "mdllfactory/MsvDllFactory_Factory.h"
+#include "mdllfactory/MsvDllList.h"
+
+#include "merror/MsvErrorCodes.h"
+
+MSV_DISABLE_ALL_WARNINGS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif // __linux__
+
+MSV_ENABLE_WARNINGS
+
+
+//benchmarks are disabled (they do not check anything and they take seconds) - run them by:
+//mdllfactoryTest --gtest_also_run_disabled_tests --gtest_filter=MsvDllFactory_Benchmark.*
+
+
+//live heap bytes of all threads (counted by replaced global new and delete of integration tests)
+extern std::atomic<int64_t> g_allocatedSize;
+
+//runs benchmark by 1, 2, 4, ... maxThreadCount threads at once and prints throughput of each thread count
+template<class Operation>
+void RunBenchmark(const char* name, std::uint32_t maxThreadCount, std::int64_t iterationCount, Operation operation)
+{
+	for (std::uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+	{
+		//all threads start at once (thread creation is not measured)
+		std::atomic<std::uint32_t> readyCount(0);
+		std::atomic<bool> start(false);
+		std::vector<std::thread> threads;
+		for (std::uint32_t i = 0; i < threadCount; ++i)
+		{
+			threads.push_back(std::thread([&readyCount, &start, &operation, iterationCount]()
+			{
+				++readyCount;
+				while (!start.load())
+				{
+					std::this_thread::yield();
+				}
+
+				operation(iterationCount);
+			}));
+		}
+
+		while (readyCount.load() < threadCount)
+		{
+			std::this_thread::yield();
+		}
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		start.store(true);
+		for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+		{
+			it->join();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		std::printf("[ BENCH    ] %s: %2u threads: %8.2f Mops/s (%6.1f ns/op per thread)\n", name, threadCount, threadCount * iterationCount / seconds / 1e6, seconds * 1e9 / iterationCount);
+	}
+}
+
+//copies test DLL 1 to count files (each copy is loaded separately) and adds them to DLL list
+bool CopyTestDll(const char* name, std::uint32_t count, MsvDllList& dllList, std::vector<std::string>& dllPaths)
+{
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		char dllPath[64];
+		std::snprintf(dllPath, sizeof(dllPath), "./%s_%02u.dll", name, i);
+		dllPaths.push_back(dllPath);
+
+		std::ifstream source("testdll_1.dll", std::ios::binary);
+		std::ofstream destination(dllPath, std::ios::binary | std::ios::trunc);
+		destination << source.rdbuf();
+
+		char id[64];
+		std::snprintf(id, sizeof(id), "{%08X-0000-4000-8000-000000000000}", i);
+		if (!source || !destination || MSV_FAILED(dllList.AddDll(id, dllPath)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//removes copies of test DLL
+void RemoveTestDll(const std::vector<std::string>& dllPaths)
+{
+	for (std::vector<std::string>::const_iterator it = dllPaths.begin(); it != dllPaths.end(); ++it)
+	{
+		std::remove(it->c_str());
+	}
+}
+
+class MsvDllFactory_Benchmark:
+	public::testing::Test
+{
+public:
+	MsvDllFactory_Benchmark()
+	{
+
+	}
+
+	virtual void SetUp()
+	{
+		m_spDllList.reset(new (std::nothrow) MsvDllList());
+		EXPECT_NE(m_spDllList, nullptr);
+		EXPECT_EQ(m_spDllList->AddDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll"), MSV_SUCCESS);
+		EXPECT_EQ(m_spDllList->AddDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", "testdll_1.dll"), MSV_SUCCESS);
+
+		m_spDllFactory.reset(new (std::nothrow) MsvDllFactory(m_spDllList));
+		EXPECT_NE(m_spDllFactory, nullptr);
+	}
+
+	virtual void TearDown()
+	{
+		m_spDllFactory.reset();
+		m_spDllList.reset();
+	}
+
+	//thread counts up to twice the count of cores (contention shows when threads share cores too)
+	std::uint32_t GetMaxThreadCount() const
+	{
+		return std::max(std::thread::hardware_concurrency(), 1u) * 2;
+	}
+
+	std::shared_ptr<MsvDllList> m_spDllList;
+	std::shared_ptr<MsvDllFactory> m_spDllFactory;
+};
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_CachedGetDllObjectThroughput)
+{
+	//object stays alive - all calls take cached (hit) path
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	ASSERT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+
+	RunBenchmark("GetDllObject (cached, raw snapshot pointer)", GetMaxThreadCount(), 1000000, [this](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spCachedDllObject);
+		}
+	});
+
+	//reference - same lookup in snapshot published by std::atomic_load/std::atomic_store of shared pointer
+	std::shared_ptr<const std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>>> spSnapshot(new (std::nothrow) std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>>{ { "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject } });
+	RunBenchmark("atomic_load of shared_ptr snapshot", GetMaxThreadCount(), 1000000, [&spSnapshot](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			std::shared_ptr<const std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>>> spCurrentSnapshot = std::atomic_load(&spSnapshot);
+			spCachedDllObject = spCurrentSnapshot->find("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}")->second.lock();
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_TokenGetDllObjectThroughput)
+{
+	MsvDllToken token;
+	ASSERT_EQ(m_spDllFactory->Resolve("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", token), MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	ASSERT_EQ(m_spDllFactory->GetDllObject(token, spDllObject), MSV_SUCCESS);
+
+	RunBenchmark("GetDllObject (token, raw entry pointer)", GetMaxThreadCount(), 1000000, [this, &token](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllFactory->GetDllObject(token, spCachedDllObject);
+		}
+	});
+
+	//reference - entry published by std::atomic_load/std::atomic_store of shared pointer
+	std::shared_ptr<const std::weak_ptr<IMsvDllObject>> spEntry(new (std::nothrow) std::weak_ptr<IMsvDllObject>(spDllObject));
+	RunBenchmark("atomic_load of shared_ptr entry", GetMaxThreadCount(), 1000000, [&spEntry](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			std::shared_ptr<const std::weak_ptr<IMsvDllObject>> spCurrentEntry = std::atomic_load(&spEntry);
+			spCachedDllObject = spCurrentEntry->lock();
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_DllListGetDllThroughput)
+{
+	RunBenchmark("MsvDllList::GetDll (raw snapshot pointer)", GetMaxThreadCount(), 1000000, [this](std::int64_t iterationCount)
+	{
+		std::string dllPath;
+		std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllList->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", dllPath, spDllDecorator);
+		}
+	});
+
+	//reference - same lookup in snapshot published by std::atomic_load/std::atomic_store of shared pointer
+	std::shared_ptr<const std::map<std::string, std::string, std::less<>>> spSnapshot(new (std::nothrow) std::map<std::string, std::string, std::less<>>{ { "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll" } });
+	RunBenchmark("atomic_load of shared_ptr snapshot", GetMaxThreadCount(), 1000000, [&spSnapshot](std::int64_t iterationCount)
+	{
+		std::string dllPath;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			std::shared_ptr<const std::map<std::string, std::string, std::less<>>> spCurrentSnapshot = std::atomic_load(&spSnapshot);
+			dllPath = spCurrentSnapshot->find("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}")->second;
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_RefCountedCopyThroughput)
+{
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObject);
+	ASSERT_EQ(errorCode, MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	ASSERT_EQ(m_spDllFactory->GetDllObject("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spDllObject), MSV_SUCCESS);
+
+	//copy and release of pointer returned by factory (pin count of DLL only)
+	RunBenchmark("MsvDllObjectPtr copy", GetMaxThreadCount(), 10000000, [&dllObject](std::int64_t iterationCount)
+	{
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectCopy(dllObject);
+		}
+	});
+
+	//reference - copy and release of shared pointer to the same object
+	RunBenchmark("std::shared_ptr copy", GetMaxThreadCount(), 10000000, [&spDllObject](std::int64_t iterationCount)
+	{
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			std::shared_ptr<IMsvDllObject> spDllObjectCopy(spDllObject);
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_RefCountedGetDllObjectThroughput)
+{
+	//object stays alive - all calls take cached (hit) path
+	std::shared_ptr<IMsvDllFactory> spDllFactory = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory);
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+	MsvErrorCode errorCode = spDllFactory->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObject);
+	ASSERT_EQ(errorCode, MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	ASSERT_EQ(m_spDllFactory->GetDllObject("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spDllObject), MSV_SUCCESS);
+
+	RunBenchmark("GetDllObject (MsvDllObjectPtr)", GetMaxThreadCount(), 1000000, [&spDllFactory](std::int64_t iterationCount)
+	{
+		MsvDllObjectPtr<MsvDllRefCountedObject> cachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			spDllFactory->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", cachedDllObject);
+		}
+	});
+
+	//reference - the same object acquired by shared pointer
+	RunBenchmark("GetDllObject (std::shared_ptr)", GetMaxThreadCount(), 1000000, [this](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllFactory->GetDllObject("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spCachedDllObject);
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_ThreadCacheGetDllObjectThroughput)
+{
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	ASSERT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+
+	//1 to 64 threads - lock free thread cache must not degrade with thread count
+	m_spDllFactory->EnableThreadCache(true);
+	RunBenchmark("GetDllObject (thread cache)", 64, 1000000, [this](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spCachedDllObject);
+		}
+	});
+
+	m_spDllFactory->EnableThreadCache(false);
+	RunBenchmark("GetDllObject (no thread cache)", 64, 1000000, [this](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spCachedDllObject);
+		}
+	});
+
+	//reference - per thread cache with mutex which checks expired and locks weak pointer for each hit
+	RunBenchmark("mutex and weak_ptr::lock per hit", 64, 1000000, [&spDllObject](std::int64_t iterationCount)
+	{
+		std::mutex lock;
+		std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>> threadCache{ { "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject } };
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			std::map<std::string, std::weak_ptr<IMsvDllObject>, std::less<>>::const_iterator it = threadCache.find("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}");
+			if (!it->second.expired())
+			{
+				spCachedDllObject = it->second.lock();
+			}
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_SealedDllListLookup)
+{
+	//more ids share one path (each path is stored once by DLL list)
+	std::vector<std::string> dllPaths;
+	for (std::uint32_t i = 0; i < 16; ++i)
+	{
+		char dllPath[64];
+		std::snprintf(dllPath, sizeof(dllPath), "/opt/plugins/lib/benchmark_plugin_%02u.so", i);
+		dllPaths.push_back(dllPath);
+	}
+
+	for (std::uint32_t entryCount : { 10u, 1000u, 100000u })
+	{
+		std::vector<std::string> ids;
+		for (std::uint32_t i = 0; i < entryCount; ++i)
+		{
+			char id[64];
+			std::snprintf(id, sizeof(id), "{%08X-0000-4000-8000-%012X}", i, i);
+			ids.push_back(id);
+		}
+
+		//ids are looked up in scattered order (not in insertion order)
+		std::vector<std::string> lookupIds;
+		std::vector<MsvDllId> lookupDllIds;
+		for (std::uint32_t i = 0; i < entryCount; ++i)
+		{
+			lookupIds.push_back(ids[(static_cast<std::uint64_t>(i) * 7919) % entryCount]);
+			lookupDllIds.push_back(MsvDllId(lookupIds.back().c_str()));
+		}
+
+		int64_t allocatedSize = g_allocatedSize.load();
+		std::shared_ptr<MsvDllList> spDllList(new (std::nothrow) MsvDllList());
+		ASSERT_NE(spDllList, nullptr);
+		ASSERT_EQ(spDllList->BeginUpdate(), MSV_SUCCESS);
+		for (std::uint32_t i = 0; i < entryCount; ++i)
+		{
+			ASSERT_EQ(spDllList->AddDll(ids[i].c_str(), dllPaths[i % dllPaths.size()].c_str()), MSV_SUCCESS);
+		}
+		ASSERT_EQ(spDllList->EndUpdate(), MSV_SUCCESS);
+		int64_t unsealedSize = g_allocatedSize.load() - allocatedSize;
+		ASSERT_EQ(spDllList->Seal(), MSV_SUCCESS);
+		int64_t sealedSize = g_allocatedSize.load() - allocatedSize;
+
+		//reference - map of ids to separately allocated DLL data (each with its own copy of path)
+		allocatedSize = g_allocatedSize.load();
+		std::map<std::string, std::shared_ptr<std::pair<std::string, std::shared_ptr<IMsvDllDecorator>>>, std::less<>> referenceDllList;
+		for (std::uint32_t i = 0; i < entryCount; ++i)
+		{
+			referenceDllList.emplace(ids[i], std::make_shared<std::pair<std::string, std::shared_ptr<IMsvDllDecorator>>>(dllPaths[i % dllPaths.size()], nullptr));
+		}
+		int64_t referenceSize = g_allocatedSize.load() - allocatedSize;
+
+		std::printf("[ BENCH    ] DLL list memory: %6u entries: %7.1f B/entry (sealed), %7.1f B/entry (not sealed), %7.1f B/entry (std::map of shared DLL data)\n", entryCount, static_cast<double>(sealedSize) / entryCount, static_cast<double>(unsealedSize) / entryCount, static_cast<double>(referenceSize) / entryCount);
+
+		std::string name = "MsvDllList::GetDll (sealed, MsvDllId), " + std::to_string(entryCount) + " entries";
+		RunBenchmark(name.c_str(), 1, 1000000, [&spDllList, &lookupDllIds, entryCount](std::int64_t iterationCount)
+		{
+			std::string dllPath;
+			std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+			for (std::int64_t i = 0; i < iterationCount; ++i)
+			{
+				spDllList->GetDll(lookupDllIds[i % entryCount], dllPath, spDllDecorator);
+			}
+		});
+
+		name = "MsvDllList::GetDll (sealed, const char*), " + std::to_string(entryCount) + " entries";
+		RunBenchmark(name.c_str(), 1, 1000000, [&spDllList, &lookupIds, entryCount](std::int64_t iterationCount)
+		{
+			std::string dllPath;
+			std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+			for (std::int64_t i = 0; i < iterationCount; ++i)
+			{
+				spDllList->GetDll(lookupIds[i % entryCount].c_str(), dllPath, spDllDecorator);
+			}
+		});
+
+		name = "std::map of shared DLL data, " + std::to_string(entryCount) + " entries";
+		RunBenchmark(name.c_str(), 1, 1000000, [&referenceDllList, &lookupIds, entryCount](std::int64_t iterationCount)
+		{
+			std::string dllPath;
+			std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+			for (std::int64_t i = 0; i < iterationCount; ++i)
+			{
+				std::map<std::string, std::shared_ptr<std::pair<std::string, std::shared_ptr<IMsvDllDecorator>>>, std::less<>>::const_iterator it = referenceDllList.find(lookupIds[i % entryCount].c_str());
+				dllPath = it->second->first;
+				spDllDecorator = it->second->second;
+			}
+		});
+	}
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_GetDllAddressesLatency)
+{
+	//300 functions of test DLL (like decorator of big library binds them)
+	std::vector<std::string> names;
+	for (std::uint32_t i = 100; i < 400; ++i)
+	{
+		names.push_back("TestFunction" + std::to_string(i));
+	}
+
+	std::vector<const char*> dllAddressNames;
+	for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+	{
+		dllAddressNames.push_back(it->c_str());
+	}
+
+	//library stays mapped, so each adapter loads it by reference count only (its address cache is empty)
+	MsvDllAdapter dllAdapter;
+	ASSERT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll"), MSV_SUCCESS);
+
+	RunBenchmark("MsvDllAdapter::GetDllAddresses (300 addresses)", 1, 2000, [&dllAddressNames](std::int64_t iterationCount)
+	{
+		std::vector<void*> dllAddresses;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			MsvDllAdapter decoratedDllAdapter;
+			decoratedDllAdapter.LoadDllLibrary("testdll_2.dll");
+			EXPECT_EQ(decoratedDllAdapter.GetDllAddresses(dllAddressNames, dllAddresses), MSV_SUCCESS);
+		}
+	});
+
+	//reference - each address by its own call
+	RunBenchmark("MsvDllAdapter::GetDllAddress (300 calls)", 1, 2000, [&dllAddressNames](std::int64_t iterationCount)
+	{
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			MsvDllAdapter decoratedDllAdapter;
+			decoratedDllAdapter.LoadDllLibrary("testdll_2.dll");
+			for (std::vector<const char*>::const_iterator it = dllAddressNames.begin(); it != dllAddressNames.end(); ++it)
+			{
+				void* pDllAddress = nullptr;
+				EXPECT_EQ(decoratedDllAdapter.GetDllAddress(*it, pDllAddress), MSV_SUCCESS);
+			}
+		}
+	});
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_LoadOptionsFirstCallLatency)
+{
+	//library with NODELETE option is never unmapped (it could not be loaded again), so it is not measured
+	const std::pair<const char*, MsvDllLoadOptions> loadOptions[] = {
+		{ "MSV_DLL_LOAD_DEFAULT", MSV_DLL_LOAD_DEFAULT },
+		{ "MSV_DLL_LOAD_NOW", MSV_DLL_LOAD_NOW },
+		{ "MSV_DLL_LOAD_GLOBAL", MSV_DLL_LOAD_GLOBAL },
+		{ "MSV_DLL_LOAD_DEEPBIND", MSV_DLL_LOAD_DEEPBIND },
+		{ "MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_DEEPBIND", static_cast<MsvDllLoadOptions>(MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_DEEPBIND) } };
+
+	for (const std::pair<const char*, MsvDllLoadOptions>& loadOption : loadOptions)
+	{
+		//library is unmapped after each iteration, so each first call binds its imports again (when binding is lazy)
+		const std::int64_t iterationCount = 200;
+		std::chrono::steady_clock::duration loadTime(0);
+		std::chrono::steady_clock::duration firstCallTime(0);
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			MsvDllAdapter dllAdapter;
+			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			ASSERT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll", loadOption.second), MSV_SUCCESS);
+			std::chrono::steady_clock::time_point loaded = std::chrono::steady_clock::now();
+
+			void* pIncrementFunction = nullptr;
+			ASSERT_EQ(dllAdapter.GetDllAddress("Increment", pIncrementFunction), MSV_SUCCESS);
+			std::chrono::steady_clock::time_point resolved = std::chrono::steady_clock::now();
+			reinterpret_cast<int32_t(*)()>(pIncrementFunction)();
+			std::chrono::steady_clock::time_point called = std::chrono::steady_clock::now();
+
+			loadTime += loaded - begin;
+			firstCallTime += called - resolved;
+		}
+
+		std::printf("[ BENCH    ] %s: load %8.1f us, first call %8.1f us\n", loadOption.first, std::chrono::duration<double, std::micro>(loadTime).count() / iterationCount, std::chrono::duration<double, std::micro>(firstCallTime).count() / iterationCount);
+	}
+}
+
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+//adapter which does not read files ahead (reference preload without readahead)
+class MsvNoReadaheadDllAdapter:
+	public MsvDllAdapter
+{
+public:
+	MsvNoReadaheadDllAdapter(std::shared_ptr<MsvLogger> spLogger):
+		MsvDllAdapter(spLogger)
+	{
+
+	}
+
+	virtual MsvErrorCode ReadaheadDllLibrary(const char* dllPath) const override
+	{
+		(void)dllPath;
+		return MSV_SUCCESS;
+	}
+};
+
+class MsvNoReadaheadDllFactory_Factory:
+	public MsvDllFactory_Factory
+{
+public:
+	virtual std::shared_ptr<IMsvDllAdapter> GetIMsvDllAdapter(std::shared_ptr<MsvLogger> spLogger) override
+	{
+		return std::shared_ptr<IMsvDllAdapter>(new (std::nothrow) MsvNoReadaheadDllAdapter(spLogger));
+	}
+};
+
+//removes file from page cache (it must be written to disk first, dirty pages are not dropped)
+bool DropPageCache(const std::string& path)
+{
+	int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	bool dropped = fsync(fileDescriptor) == 0 && posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(fileDescriptor);
+
+	return dropped;
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_ColdPreloadReadahead)
+{
+	//each copy of test DLL is other file (it is read from disk and loaded separately)
+	std::shared_ptr<MsvDllList> spDllList(new (std::nothrow) MsvDllList());
+	ASSERT_NE(spDllList, nullptr);
+
+	std::vector<std::string> dllPaths;
+	ASSERT_TRUE(CopyTestDll("benchmark_readahead", 32, *spDllList, dllPaths));
+
+	for (std::uint32_t threadCount : { 1u, 4u })
+	{
+		for (bool readahead : { true, false })
+		{
+			const std::int64_t iterationCount = 10;
+			std::chrono::steady_clock::duration preloadTime(0);
+			for (std::int64_t i = 0; i < iterationCount; ++i)
+			{
+				for (std::vector<std::string>::const_iterator it = dllPaths.begin(); it != dllPaths.end(); ++it)
+				{
+					ASSERT_TRUE(DropPageCache(*it));
+				}
+
+				std::shared_ptr<MsvDllFactory> spDllFactory(readahead ? new (std::nothrow) MsvDllFactory(spDllList) : new (std::nothrow) MsvDllFactory(spDllList, nullptr, std::shared_ptr<MsvDllFactory_Factory>(new (std::nothrow) MsvNoReadaheadDllFactory_Factory())));
+				ASSERT_NE(spDllFactory, nullptr);
+
+				std::vector<MsvDllPreloadResult> results;
+				std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+				ASSERT_EQ(spDllFactory->Preload(false, threadCount, results), MSV_SUCCESS);
+				preloadTime += std::chrono::steady_clock::now() - begin;
+			}
+
+			std::printf("[ BENCH    ] Cold preload of %u DLLs %s readahead: %2u threads: %8.1f ms\n", static_cast<std::uint32_t>(dllPaths.size()), readahead ? "with" : "without", threadCount, std::chrono::duration<double, std::milli>(preloadTime).count() / iterationCount);
+		}
+	}
+
+	RemoveTestDll(dllPaths);
+}
+#endif // !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+
+#ifdef __linux__
+//opens counter of iTLB misses of calling thread (returns -1 when perf counters are not available)
+int OpenITlbMissCounter()
+{
+	perf_event_attr attributes = {};
+	attributes.size = sizeof(attributes);
+	attributes.type = PERF_TYPE_HW_CACHE;
+	attributes.config = PERF_COUNT_HW_CACHE_ITLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	return static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+
+//reads counter of iTLB misses (returns -1 when it is not available)
+std::int64_t ReadITlbMissCounter(int counter)
+{
+	std::int64_t value = 0;
+	return counter >= 0 && read(counter, &value, sizeof(value)) == sizeof(value) ? value : -1;
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_HugePagesCallLatency)
+{
+	int counter = OpenITlbMissCounter();
+
+	for (MsvDllLoadOptions loadOptions : { static_cast<MsvDllLoadOptions>(MSV_DLL_LOAD_PREFAULT), static_cast<MsvDllLoadOptions>(MSV_DLL_LOAD_PREFAULT | MSV_DLL_LOAD_HUGE_PAGES) })
+	{
+		//nop sled of test DLL takes 6 MB of code (it exists on x86-64 only)
+		MsvDllAdapter dllAdapter;
+		ASSERT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll", loadOptions), MSV_SUCCESS);
+		void* pNopSled = nullptr;
+		if (MSV_FAILED(dllAdapter.GetDllAddress("TestNopSled", pNopSled)))
+		{
+			std::printf("[ BENCH    ] Test DLL has no nop sled on this platform.\n");
+			break;
+		}
+
+		reinterpret_cast<void(*)()>(pNopSled)();
+
+		const std::int64_t iterationCount = 100;
+		std::int64_t misses = ReadITlbMissCounter(counter);
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			reinterpret_cast<void(*)()>(pNopSled)();
+		}
+		double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+		misses = misses >= 0 ? ReadITlbMissCounter(counter) - misses : -1;
+
+		char missesText[32] = "n/a";
+		if (misses >= 0)
+		{
+			std::snprintf(missesText, sizeof(missesText), "%.1f", static_cast<double>(misses) / iterationCount);
+		}
+
+		std::printf("[ BENCH    ] Call of 6 MB of code (%s): %8.1f us per call, %s iTLB misses per call\n", (loadOptions & MSV_DLL_LOAD_HUGE_PAGES) ? "huge pages" : "normal pages", microseconds / iterationCount, missesText);
+	}
+
+	if (counter >= 0)
+	{
+		close(counter);
+	}
+}
+#endif // __linux__
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_ShutdownPolicyLatency)
+{
+	std::shared_ptr<MsvDllList> spDllList(new (std::nothrow) MsvDllList());
+	ASSERT_NE(spDllList, nullptr);
+
+	std::vector<std::string> dllPaths;
+	ASSERT_TRUE(CopyTestDll("benchmark_shutdown", 32, *spDllList, dllPaths));
+
+	//leaked DLLs stay loaded (next loads of them would be reference count bumps only), so leak is measured last
+	const std::pair<const char*, MsvDllShutdownPolicy> policies[] = {
+		{ "MSV_DLL_SHUTDOWN_ORDERED", MSV_DLL_SHUTDOWN_ORDERED },
+		{ "MSV_DLL_SHUTDOWN_PARALLEL", MSV_DLL_SHUTDOWN_PARALLEL },
+		{ "MSV_DLL_SHUTDOWN_LEAK", MSV_DLL_SHUTDOWN_LEAK } };
+
+	for (const std::pair<const char*, MsvDllShutdownPolicy>& policy : policies)
+	{
+		const std::int64_t iterationCount = 10;
+		std::chrono::steady_clock::duration shutdownTime(0);
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			std::shared_ptr<MsvDllFactory> spDllFactory(new (std::nothrow) MsvDllFactory(spDllList));
+			ASSERT_NE(spDllFactory, nullptr);
+			spDllFactory->SetShutdownPolicy(policy.second);
+
+			std::vector<MsvDllPreloadResult> results;
+			ASSERT_EQ(spDllFactory->Preload(false, 0, results), MSV_SUCCESS);
+
+			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			spDllFactory.reset();
+			shutdownTime += std::chrono::steady_clock::now() - begin;
+		}
+
+		std::printf("[ BENCH    ] Shutdown of factory with %u loaded DLLs (%s): %8.1f ms\n", static_cast<std::uint32_t>(dllPaths.size()), policy.first, std::chrono::duration<double, std::milli>(shutdownTime).count() / iterationCount);
+	}
+
+	RemoveTestDll(dllPaths);
+}
+
+#ifdef MSV_DLL_COROUTINES
+//fire and forget coroutine (it runs until first suspension immediately)
+class MsvBenchmarkCoroutine
+{
+public:
+	class promise_type
+	{
+	public:
+		MsvBenchmarkCoroutine get_return_object() { return MsvBenchmarkCoroutine(); }
+		std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+		std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+//awaits DLL object iterationCount times (coroutine is resumed by loader thread when DLL object is not acquired yet)
+MsvBenchmarkCoroutine AwaitDllObjects(IMsvDllFactory& dllFactory, const char* id, std::int64_t iterationCount, std::promise<MsvErrorCode>& result)
+{
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	MsvErrorCode errorCode = MSV_SUCCESS;
+	for (std::int64_t i = 0; i < iterationCount && MSV_SUCCEEDED(errorCode); ++i)
+	{
+		errorCode = co_await dllFactory.AwaitDllObject(id, spDllObject);
+	}
+
+	//DLL object is released before result is set (waiting thread might release DLL then)
+	spDllObject.reset();
+	result.set_value(errorCode);
+}
+
+TEST_F(MsvDllFactory_Benchmark, DISABLED_AwaitDllObjectLatency)
+{
+	//hot - DLL object is acquired already, co_await is completed inline (no suspension)
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	ASSERT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+
+	RunBenchmark("co_await AwaitDllObject (cached)", 1, 1000000, [this](std::int64_t iterationCount)
+	{
+		std::promise<MsvErrorCode> result;
+		AwaitDllObjects(*m_spDllFactory, "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", iterationCount, result);
+		EXPECT_EQ(result.get_future().get(), MSV_SUCCESS);
+	});
+
+	//reference - synchronous call of the same cache hit
+	RunBenchmark("GetDllObject (cached)", 1, 1000000, [this](std::int64_t iterationCount)
+	{
+		std::shared_ptr<IMsvDllObject> spCachedDllObject;
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spCachedDllObject);
+		}
+	});
+
+	//cold - DLL is released before each request, coroutine is suspended and resumed by loader thread
+	spDllObject.reset();
+	RunBenchmark("co_await AwaitDllObject (cold load)", 1, 200, [this](std::int64_t iterationCount)
+	{
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			//loader thread holds DLL object until its callback (which has resumed coroutine) returns
+			MsvErrorCode errorCode = MSV_NOT_ALLOWED_ERROR;
+			while ((errorCode = m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}")) == MSV_NOT_ALLOWED_ERROR)
+			{
+				std::this_thread::yield();
+			}
+			EXPECT_EQ(errorCode, MSV_SUCCESS);
+
+			std::promise<MsvErrorCode> result;
+			AwaitDllObjects(*m_spDllFactory, "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", 1, result);
+			EXPECT_EQ(result.get_future().get(), MSV_SUCCESS);
+		}
+	});
+
+	//reference - the same cold load on calling thread (difference is cost of suspension, loader thread handoff and resume)
+	RunBenchmark("GetDllObject (cold load)", 1, 200, [this](std::int64_t iterationCount)
+	{
+		for (std::int64_t i = 0; i < iterationCount; ++i)
+		{
+			EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+
+			std::shared_ptr<IMsvDllObject> spLoadedDllObject;
+			EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spLoadedDllObject), MSV_SUCCESS);
+		}
+	});
+}
+#endif // MSV_DLL_COROUTINES
@@ -3,23 +3,146 @@
 
 
 #include "mdllfactory/MsvDllFactory.h"
+#include "mdllfactory/MsvDllFactory_Factory.h"
 #include "mdllfactory/MsvDllList.h"
+#include "mdllfactory/MsvDll_Factory.h"
 
 #include "merror/MsvErrorCodes.h"
 
 #include "mdllfactory/Test/testdll_1/MsvTest1DllObject.h"
 
+MSV_DISABLE_ALL_WARNINGS
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <thread>
+#include <vector>
+
+MSV_ENABLE_WARNINGS
+
 
 #ifndef MSV_TEST_WITH_LOGGING
 #define MSV_TEST_WITH_LOGGING 0
 #endif
 
 
+//heap allocations made by current thread (for zero-allocation checks)
+thread_local int64_t g_allocationCount = 0;
+
+//live heap bytes of all threads (for memory per entry measurements of benchmarks)
+std::atomic<int64_t> g_allocatedSize(0);
+
+//size of each allocation is stored in front of it (header keeps alignment of malloc)
+const std::size_t g_allocationHeaderSize = alignof(std::max_align_t);
+
+//all (not aligned) forms of global new and delete are replaced, so each allocation is counted and freed by same heap
+void* AllocateCounted(std::size_t size) noexcept
+{
+	++g_allocationCount;
+
+	unsigned char* pMemory = static_cast<unsigned char*>(std::malloc(g_allocationHeaderSize + size));
+	if (!pMemory)
+	{
+		return nullptr;
+	}
+
+	*reinterpret_cast<std::size_t*>(pMemory) = size;
+	g_allocatedSize.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+
+	return pMemory + g_allocationHeaderSize;
+}
+
+//it is not inlined to replaced delete (compiler would pair inlined free with operator new)
+#ifdef _MSC_VER
+__declspec(noinline)
+#else
+__attribute__((noinline))
+#endif
+void FreeCounted(void* pMemory) noexcept
+{
+	if (!pMemory)
+	{
+		return;
+	}
+
+	unsigned char* pBlock = static_cast<unsigned char*>(pMemory) - g_allocationHeaderSize;
+	g_allocatedSize.fetch_sub(static_cast<int64_t>(*reinterpret_cast<std::size_t*>(pBlock)), std::memory_order_relaxed);
+	std::free(pBlock);
+}
+
+void* operator new(std::size_t size)
+{
+	void* pMemory = AllocateCounted(size);
+	if (!pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pMemory;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* pMemory = AllocateCounted(size);
+	if (!pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pMemory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocateCounted(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocateCounted(size);
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	FreeCounted(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	FreeCounted(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	FreeCounted(pMemory);
+}
+
+void operator delete[](void* pMemory, std::size_t) noexcept
+{
+	FreeCounted(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	FreeCounted(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	FreeCounted(pMemory);
+}
+
+
 class TestDll2:
 	public IMsvDllDecorator
 {
 public:
 	TestDll2():
+		m_decorateCount(0),
 		m_pIncrementFunction(nullptr),
 		m_pDecrementFunction(nullptr),
 		m_pGetValueFunction(nullptr)
@@ -27,6 +150,11 @@ public:
 
 	}
 
+	int32_t GetDecorateCount()
+	{
+		return m_decorateCount;
+	}
+
 	int32_t Increment()
 	{
 		return m_pIncrementFunction();
@@ -45,6 +173,8 @@ public:
 protected:
 	virtual MsvErrorCode DecorateDllObject(const char* id, std::shared_ptr<IMsvDllAdapter> spMsvDllAdapter) override
 	{
+		++m_decorateCount;
+
 		void* pDllAddress = nullptr;
 		
 		MSV_RETURN_FAILED(spMsvDllAdapter->GetDllAddress("Increment", pDllAddress));
@@ -60,6 +190,7 @@ protected:
 	}
 
 protected:
+	std::atomic<int32_t> m_decorateCount;
 	int32_t(*m_pIncrementFunction)();
 	int32_t(*m_pDecrementFunction)();
 	int32_t(*m_pGetValueFunction)();
@@ -87,9 +218,14 @@ public:
 
 	MsvErrorCode Initialize()
 	{
+		//all DLLs are published at once
+		MSV_RETURN_FAILED(BeginUpdate());
+
 		//two different objects in one DLL
 		MSV_RETURN_FAILED(AddDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll"));
 		MSV_RETURN_FAILED(AddDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}", "testdll_1.dll", nullptr));
+		//reference counted object
+		MSV_RETURN_FAILED(AddDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", "testdll_1.dll"));
 		//this is not in DLL (for check error handling)
 		MSV_RETURN_FAILED(AddDll("{82ABA7A1-5BBC-4F14-B0E6-866BB6BB8136}", "testdll_1.dll"));
 
@@ -100,7 +236,121 @@ public:
 		//this is not in DLL (for check error handling) - will try to load GetDllObject exported function and should failed
 		MSV_RETURN_FAILED(AddDll("{3FB71C99-07EB-48BB-91CD-13EC5F53E49B}", "testdll_2.dll"));
 
-		return MSV_SUCCESS;
+		//DLL which does not exist (for check error handling)
+		MSV_RETURN_FAILED(AddDll("{E5A4CE5B-3C0F-4F4B-9D3A-2C7B1E0D9A61}", "testdll_nonexistent.dll"));
+
+		return EndUpdate();
+	}
+};
+
+std::atomic<int32_t> g_loadDllLibraryCount(0);
+std::atomic<MsvDllLoadOptions> g_lastLoadOptions(MSV_DLL_LOAD_DEFAULT);
+std::atomic<int32_t> g_warmupDllLibraryCount(0);
+std::atomic<bool> g_warmupDllLibraryCancelled(false);
+std::atomic<int32_t> g_unloadDllLibraryDelay(0);
+std::atomic<int32_t> g_unloadDllLibraryCount(0);
+
+//slow loads and unloads wait for each other (and for test) at latch - it proves they run at once without measuring time
+std::atomic<int32_t> g_slowLatchCount(0);
+std::atomic<bool> g_slowLatchTimedOut(false);
+
+bool WaitForSlowLatch(int32_t count)
+{
+	for (int32_t i = 0; i < 1000 && g_slowLatchCount > count; ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return g_slowLatchCount <= count;
+}
+
+void ArriveAtSlowLatch()
+{
+	//latch is not used when its count is 0
+	int32_t count = g_slowLatchCount.load();
+	while (count > 0 && !g_slowLatchCount.compare_exchange_weak(count, count - 1)) {}
+
+	if (count > 0 && !WaitForSlowLatch(0))
+	{
+		g_slowLatchTimedOut = true;
+	}
+}
+
+//adapter which loads testdll_2 very slowly (like DLL with heavy static initializers)
+class MsvSlowDllAdapter:
+	public MsvDllAdapter
+{
+public:
+	MsvSlowDllAdapter(std::shared_ptr<MsvLogger> spLogger = nullptr):
+		MsvDllAdapter(spLogger)
+	{
+
+	}
+
+	virtual MsvErrorCode LoadDllLibrary(const char* dllPath, MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT) override
+	{
+		++g_loadDllLibraryCount;
+		g_lastLoadOptions = loadOptions;
+
+		if (std::string(dllPath).compare("testdll_2.dll") == 0)
+		{
+			ArriveAtSlowLatch();
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		}
+		else if (std::string(dllPath).compare("testdll_nonexistent.dll") == 0)
+		{
+			ArriveAtSlowLatch();
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		}
+
+		return MsvDllAdapter::LoadDllLibrary(dllPath, loadOptions);
+	}
+
+	virtual MsvErrorCode WarmupDllLibrary(const std::vector<const char*>& dllAddressNames, const std::atomic<bool>& cancelled) override
+	{
+		++g_warmupDllLibraryCount;
+
+		//endless warmup (like warmup of huge DLL) - it arrives at latch when it is started and it is finished by cancel only
+		ArriveAtSlowLatch();
+		for (int32_t i = 0; i < 1000 && !cancelled; ++i)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		g_warmupDllLibraryCancelled = cancelled.load();
+
+		return MsvDllAdapter::WarmupDllLibrary(dllAddressNames, cancelled);
+	}
+
+	virtual MsvErrorCode UnloadDllLibrary() override
+	{
+		++g_unloadDllLibraryCount;
+
+		//slow unload (like DLL with heavy static destructors)
+		ArriveAtSlowLatch();
+		std::this_thread::sleep_for(std::chrono::milliseconds(g_unloadDllLibraryDelay.load()));
+
+		return MsvDllAdapter::UnloadDllLibrary();
+	}
+};
+
+class MsvSlowDll_Factory:
+	public MsvDll_Factory
+{
+public:
+	virtual std::shared_ptr<IMsvDllAdapter> GetIMsvDllAdapter(std::shared_ptr<MsvLogger> spLogger) override
+	{
+		return std::shared_ptr<IMsvDllAdapter>(new (std::nothrow) MsvSlowDllAdapter(spLogger));
+	}
+};
+
+class MsvSlowDllFactory_Factory:
+	public MsvDllFactory_Factory
+{
+public:
+	virtual std::shared_ptr<IMsvDll> GetIMsvDll(std::shared_ptr<MsvLogger> spLogger) override
+	{
+		return std::shared_ptr<IMsvDll>(new (std::nothrow) MsvDll(spLogger, std::shared_ptr<MsvDll_Factory>(new (std::nothrow) MsvSlowDll_Factory())));
 	}
 };
 
@@ -136,6 +386,12 @@ public:
 		m_spDllList.reset();
 	}
 
+	//factory which loads DLLs by slow adapter (see MsvSlowDllAdapter)
+	std::shared_ptr<MsvDllFactory> CreateSlowDllFactory()
+	{
+		return std::shared_ptr<MsvDllFactory>(new (std::nothrow) MsvDllFactory(m_spDllList, m_spLogger, std::shared_ptr<MsvDllFactory_Factory>(new (std::nothrow) MsvSlowDllFactory_Factory())));
+	}
+
 	//logger
 	std::shared_ptr<IMsvLoggerProvider> m_spLoggerProvider;
 	std::shared_ptr<MsvLogger> m_spLogger;
@@ -258,8 +514,6 @@ TEST_F(MsvDllFactory_Integration, ItShouldFailedWhenTryingToReleaseDllHoldedByAn
 	EXPECT_EQ(spDll.use_count(), 2);
 }
 
-/*
-//currently it will succeded (we don't know if references is hold in DLL or somewhere else, it unloads DLL anyway)
 TEST_F(MsvDllFactory_Integration, ItShouldFailedWhenTryingToReleaseDllObjectHoldedByAnyoneElse)
 {
 	std::shared_ptr<MsvTest1DllObject> spDllObject;
@@ -268,7 +522,7 @@ TEST_F(MsvDllFactory_Integration, ItShouldFailedWhenTryingToReleaseDllObjectHold
 	EXPECT_NE(spDllObject, nullptr);
 
 	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_NOT_ALLOWED_ERROR);
-}*/
+}
 
 TEST_F(MsvDllFactory_Integration, ItShouldSucceededToUnloadDllHoldedOnlyByFactory)
 {
@@ -288,6 +542,1342 @@ TEST_F(MsvDllFactory_Integration, ItShouldSucceededToUnloadDllHoldedOnlyByFactor
 	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
 }
 
+TEST_F(MsvDllFactory_Integration, ItShouldReturnSameDllObjectToAllThreads)
+{
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+
+	std::vector<std::shared_ptr<IMsvDllObject>> dllObjects(8);
+	std::vector<MsvErrorCode> errorCodes(dllObjects.size(), MSV_SUCCESS);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < dllObjects.size(); ++i)
+	{
+		threads.push_back(std::thread([this, i, &dllObjects, &errorCodes]()
+		{
+			for (int j = 0; j < 10000 && MSV_SUCCEEDED(errorCodes[i]); ++j)
+			{
+				errorCodes[i] = m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", dllObjects[i]);
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+		EXPECT_EQ(errorCodes[i], MSV_SUCCESS);
+		EXPECT_EQ(dllObjects[i], spDllObject);
+	}
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldGetDllObjectAgainAfterReleaseDll)
+{
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	spDllObject.reset();
+
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_TRUE(spDll->Initialized());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldNotBlockOtherDllsWhileSlowDllIsLoading)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+
+	//load slow DLL in other thread (it is held at latch until this thread arrives)
+	g_slowLatchCount = 2;
+	g_slowLatchTimedOut = false;
+	MsvErrorCode slowErrorCode = MSV_SUCCESS;
+	std::atomic<bool> slowLoaded(false);
+	std::thread slowThread([&spDllFactory, &slowErrorCode, &slowLoaded]()
+	{
+		std::shared_ptr<IMsvDllObject> spSlowDllObject;
+		slowErrorCode = spDllFactory->GetDllObject("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spSlowDllObject);
+		slowLoaded = true;
+	});
+
+	//wait until slow DLL is loading
+	EXPECT_TRUE(WaitForSlowLatch(1));
+
+	//cached object, not yet acquired object and DLL from already loaded DLL
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->GetDllObject("{337AB087-1B69-4561-A0E4-771723EFCBFE}", spDllObject), MSV_SUCCESS);
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(spDllFactory->GetDll("{82ABA7A1-5BBC-4F14-B0E6-866BB6BB8136}", spDll), MSV_SUCCESS);
+
+	//slow DLL is still held at latch -> requests above have not waited for it
+	EXPECT_FALSE(slowLoaded);
+	ArriveAtSlowLatch();
+
+	slowThread.join();
+	EXPECT_EQ(slowErrorCode, MSV_SUCCESS);
+	EXPECT_FALSE(g_slowLatchTimedOut);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldLoadDllAndDecorateObjectOnlyOnceForConcurrentRequests)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+	g_loadDllLibraryCount = 0;
+
+	std::vector<std::shared_ptr<TestDll2>> dllObjects(8);
+	std::vector<MsvErrorCode> errorCodes(dllObjects.size(), MSV_SUCCESS);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < dllObjects.size(); ++i)
+	{
+		threads.push_back(std::thread([&spDllFactory, i, &dllObjects, &errorCodes]()
+		{
+			errorCodes[i] = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(spDllFactory)->GetDllObject<TestDll2>("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", dllObjects[i]);
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+		EXPECT_EQ(errorCodes[i], MSV_SUCCESS);
+		EXPECT_NE(dllObjects[i], nullptr);
+		EXPECT_EQ(dllObjects[i], dllObjects[0]);
+	}
+
+	EXPECT_EQ(g_loadDllLibraryCount, 1);
+	EXPECT_EQ(dllObjects[0]->GetDecorateCount(), 1);
+}
+
+//decorator which is not thread safe (it records how many threads decorate objects at once)
+class MsvTestConcurrencyDecorator:
+	public IMsvDllDecorator
+{
+public:
+	MsvTestConcurrencyDecorator():
+		m_activeCount(0),
+		m_maxActiveCount(0)
+	{
+
+	}
+
+	int32_t GetMaxActiveCount()
+	{
+		return m_maxActiveCount;
+	}
+
+protected:
+	virtual MsvErrorCode DecorateDllObject(const char*, std::shared_ptr<IMsvDllAdapter>) override
+	{
+		int32_t activeCount = ++m_activeCount;
+		if (activeCount > m_maxActiveCount)
+		{
+			m_maxActiveCount = activeCount;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		--m_activeCount;
+
+		return MSV_SUCCESS;
+	}
+
+protected:
+	std::atomic<int32_t> m_activeCount;
+	std::atomic<int32_t> m_maxActiveCount;
+};
+
+TEST_F(MsvDllFactory_Integration, ItShouldNotDecorateObjectsOfDifferentIdsConcurrently)
+{
+	std::shared_ptr<IMsvDll> spDll(new (std::nothrow) MsvDll(m_spLogger));
+	EXPECT_NE(spDll, nullptr);
+	EXPECT_EQ(spDll->Initialize("testdll_2.dll"), MSV_SUCCESS);
+
+	//each id is created by its own thread with one (shared) decorator
+	std::shared_ptr<MsvTestConcurrencyDecorator> spDecorator(new (std::nothrow) MsvTestConcurrencyDecorator());
+	EXPECT_NE(spDecorator, nullptr);
+	std::vector<std::string> ids = { "{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", "{6A1C3E2D-4B5F-4C7A-8D9E-0F1A2B3C4D5E}" };
+	std::vector<std::shared_ptr<IMsvDllObject>> dllObjects(ids.size());
+	std::vector<MsvErrorCode> errorCodes(ids.size(), MSV_SUCCESS);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		threads.push_back(std::thread([&spDll, &spDecorator, i, &ids, &dllObjects, &errorCodes]()
+		{
+			errorCodes[i] = spDll->GetDllObject(ids[i].c_str(), dllObjects[i], spDecorator);
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+		EXPECT_EQ(errorCodes[i], MSV_SUCCESS);
+		EXPECT_NE(dllObjects[i], nullptr);
+	}
+
+	EXPECT_EQ(spDecorator->GetMaxActiveCount(), 1);
+
+	dllObjects.clear();
+	EXPECT_EQ(spDll->Uninitialize(), MSV_SUCCESS);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReturnSameErrorToAllConcurrentRequestsWhenLoadFailed)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+	g_loadDllLibraryCount = 0;
+
+	std::vector<MsvErrorCode> errorCodes(8, MSV_SUCCESS);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < errorCodes.size(); ++i)
+	{
+		threads.push_back(std::thread([&spDllFactory, i, &errorCodes]()
+		{
+			std::shared_ptr<IMsvDllObject> spDllObject;
+			errorCodes[i] = spDllFactory->GetDllObject("{E5A4CE5B-3C0F-4F4B-9D3A-2C7B1E0D9A61}", spDllObject);
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+		EXPECT_EQ(errorCodes[i], MSV_OPEN_ERROR);
+	}
+
+	EXPECT_EQ(g_loadDllLibraryCount, 1);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldNotAllocateWhenDllObjectIsCached)
+{
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	std::shared_ptr<MsvTest1DllObject> spTestDllObject;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvTest1DllObject>("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spTestDllObject);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+
+	int64_t allocationCount = g_allocationCount;
+
+	for (int i = 0; i < 1000 && MSV_SUCCEEDED(errorCode); ++i)
+	{
+		if (MSV_SUCCEEDED(errorCode = m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject)))
+		{
+			errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvTest1DllObject>("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spTestDllObject);
+		}
+	}
+
+	EXPECT_EQ(g_allocationCount - allocationCount, 0);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldParseAndFormatDllId)
+{
+	static constexpr MsvDllId dllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}");
+	static_assert(dllId.Valid(), "DLL id must be parsed at compile time.");
+
+	char idString[MSV_DLL_ID_STRING_SIZE];
+	EXPECT_STREQ(dllId.ToString(idString), "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}");
+	EXPECT_TRUE(MsvDllId("{9f31d4a9-cdf5-49fa-90a8-aa109735dc9f}") == dllId);
+	EXPECT_TRUE(MsvDllId("{337AB087-1B69-4561-A0E4-771723EFCBFE}") != dllId);
+
+	EXPECT_FALSE(MsvDllId("9F31D4A9-CDF5-49FA-90A8-AA109735DC9F").Valid());
+	EXPECT_FALSE(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9}").Valid());
+	EXPECT_FALSE(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}x").Valid());
+	EXPECT_FALSE(MsvDllId("{9F31D4A9XCDF5-49FA-90A8-AA109735DC9F}").Valid());
+	EXPECT_FALSE(MsvDllId("{00000000-0000-0000-0000-000000000000}").Valid());
+	EXPECT_FALSE(MsvDllId("testdll").Valid());
+	EXPECT_FALSE(MsvDllId(nullptr).Valid());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReturnSameDllObjectForStringAndBinaryDllId)
+{
+	static constexpr MsvDllId dllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}");
+
+	std::shared_ptr<MsvTest1DllObject> spDllObject1;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvTest1DllObject>(dllId, spDllObject1);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_NE(spDllObject1, nullptr);
+
+	std::shared_ptr<IMsvDllObject> spDllObject2;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject2), MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll(MsvDllId("{7368D519-0F40-40BE-B7FE-EA382279219F}"), spDll), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(m_spDllFactory->GetDllObject(MsvDllId(), spDllObject2), MSV_NOT_FOUND_ERROR);
+
+	spDllObject1.reset();
+	spDllObject2.reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll(dllId), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllFactory->ReleaseDll(dllId), MSV_NOT_FOUND_INFO);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReturnSameDllObjectForTypeBoundDllId)
+{
+	std::shared_ptr<MsvTest1DllObject> spDllObject1;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject(spDllObject1);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_NE(spDllObject1, nullptr);
+
+	std::shared_ptr<MsvTest1DllObject> spDllObject2;
+	errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvTest1DllObject>("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject2);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+
+	int64_t allocationCount = g_allocationCount;
+
+	for (int i = 0; i < 1000 && MSV_SUCCEEDED(errorCode); ++i)
+	{
+		errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject(spDllObject2);
+	}
+
+	EXPECT_EQ(g_allocationCount - allocationCount, 0);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReturnSameDllObjectForToken)
+{
+	MsvDllToken token1;
+	EXPECT_EQ(m_spDllFactory->Resolve("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", token1), MSV_SUCCESS);
+	EXPECT_TRUE(token1.Valid());
+
+	MsvDllToken token2;
+	EXPECT_EQ(m_spDllFactory->Resolve(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), token2), MSV_SUCCESS);
+	EXPECT_TRUE(token1 == token2);
+
+	std::shared_ptr<IMsvDllObject> spDllObject1;
+	EXPECT_EQ(m_spDllFactory->GetDllObject(token1, spDllObject1), MSV_SUCCESS);
+	EXPECT_NE(spDllObject1, nullptr);
+
+	std::shared_ptr<MsvTest1DllObject> spDllObject2;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvTest1DllObject>(token1, spDllObject2);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+
+	std::shared_ptr<IMsvDllObject> spDllObject3;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject3), MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject3);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReloadDllForTokenAfterReleaseDll)
+{
+	MsvDllToken token;
+	EXPECT_EQ(m_spDllFactory->Resolve("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", token), MSV_SUCCESS);
+
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject(token, spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+
+	spDllObject.reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+
+	EXPECT_EQ(m_spDllFactory->GetDllObject(token, spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+
+	//DLL has been loaded again
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_TRUE(spDll->Initialized());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldFailedWhenTokenIsNotValid)
+{
+	MsvDllToken token;
+	EXPECT_EQ(m_spDllFactory->Resolve("{7368D519-0F40-40BE-B7FE-EA382279219F}", token), MSV_NOT_FOUND_ERROR);
+	EXPECT_FALSE(token.Valid());
+
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject(token, spDllObject), MSV_INVALID_DATA_ERROR);
+	EXPECT_EQ(m_spDllFactory->GetDllObject(MsvDllToken(7), spDllObject), MSV_INVALID_DATA_ERROR);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReturnSameDllObjectFromThreadCache)
+{
+	m_spDllFactory->EnableThreadCache(true);
+
+	std::shared_ptr<IMsvDllObject> spDllObject1;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject2;
+	EXPECT_EQ(m_spDllFactory->GetDllObject(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), spDllObject2), MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+
+	int64_t allocationCount = g_allocationCount;
+	MsvErrorCode errorCode = MSV_SUCCESS;
+
+	for (int i = 0; i < 1000 && MSV_SUCCEEDED(errorCode); ++i)
+	{
+		if (MSV_SUCCEEDED(errorCode = m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1)))
+		{
+			errorCode = m_spDllFactory->GetDllObject(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), spDllObject2);
+		}
+	}
+
+	EXPECT_EQ(g_allocationCount - allocationCount, 0);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+
+	//thread cache is cleared when DLL is released - new object is returned from reloaded DLL
+	spDllObject1.reset();
+	spDllObject2.reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	EXPECT_NE(spDllObject1, nullptr);
+
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_TRUE(spDll->Initialized());
+
+	std::thread thread([this, &spDllObject1]()
+		{
+			std::shared_ptr<IMsvDllObject> spThreadDllObject;
+			EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spThreadDllObject), MSV_SUCCESS);
+			EXPECT_EQ(spThreadDllObject, spDllObject1);
+		});
+	thread.join();
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldKeepThreadCachePerFactory)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory(new (std::nothrow) MsvDllFactory(m_spDllList, m_spLogger));
+	ASSERT_NE(spDllFactory, nullptr);
+	m_spDllFactory->EnableThreadCache(true);
+	spDllFactory->EnableThreadCache(true);
+
+	std::shared_ptr<IMsvDllObject> spDllObject1;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject2;
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject2), MSV_SUCCESS);
+
+	//objects cached before DLL load are stale (DLL load changes factory epoch) - cache them again
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject2), MSV_SUCCESS);
+
+	//thread cache of each factory is kept when thread uses factories alternately
+	int64_t allocationCount = g_allocationCount;
+	MsvErrorCode errorCode = MSV_SUCCESS;
+
+	for (int i = 0; i < 1000 && MSV_SUCCEEDED(errorCode); ++i)
+	{
+		if (MSV_SUCCEEDED(errorCode = m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1)))
+		{
+			errorCode = spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject2);
+		}
+	}
+
+	EXPECT_EQ(g_allocationCount - allocationCount, 0);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+
+	//object cached by other (idle) thread does not block DLL release
+	std::atomic<bool> cached(false);
+	std::atomic<bool> released(false);
+	std::thread thread([this, &cached, &released]()
+		{
+			{
+				std::shared_ptr<IMsvDllObject> spThreadDllObject;
+				EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spThreadDllObject), MSV_SUCCESS);
+			}
+
+			cached = true;
+			while (!released)
+			{
+				std::this_thread::yield();
+			}
+		});
+
+	while (!cached)
+	{
+		std::this_thread::yield();
+	}
+
+	spDllObject1.reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+	released = true;
+	thread.join();
+
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	EXPECT_NE(spDllObject1, nullptr);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldGetDllsFromSealedDllList)
+{
+	std::shared_ptr<IMsvDllDecorator> spTestDll2(new (std::nothrow) TestDll2());
+	EXPECT_NE(spTestDll2, nullptr);
+	EXPECT_EQ(m_spDllList->AddDll("testdll_2", "testdll_2.dll", spTestDll2), MSV_SUCCESS);
+
+	EXPECT_EQ(m_spDllList->Seal(), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->Seal(), MSV_ALREADY_INITIALIZED_INFO);
+	EXPECT_EQ(m_spDllList->AddDll("testdll_1", "testdll_1.dll"), MSV_NOT_ALLOWED_ERROR);
+
+	std::string dllPath;
+	std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+	EXPECT_EQ(m_spDllList->GetDll("testdll_2", dllPath, spDllDecorator), MSV_SUCCESS);
+	EXPECT_EQ(dllPath, "testdll_2.dll");
+	EXPECT_EQ(spDllDecorator, spTestDll2);
+	EXPECT_EQ(m_spDllList->GetDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}", dllPath, spDllDecorator), MSV_SUCCESS);
+	EXPECT_EQ(dllPath, "testdll_1.dll");
+	EXPECT_EQ(spDllDecorator, nullptr);
+	EXPECT_EQ(m_spDllList->GetDll("testdll_1", dllPath, spDllDecorator), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(m_spDllList->GetDll("{00000000-0000-0000-0000-000000000001}", dllPath, spDllDecorator), MSV_NOT_FOUND_ERROR);
+
+	std::shared_ptr<IMsvDllObject> spDllObject1;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject2;
+	EXPECT_EQ(m_spDllFactory->GetDllObject(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), spDllObject2), MSV_SUCCESS);
+	EXPECT_NE(spDllObject1, nullptr);
+	EXPECT_EQ(spDllObject1, spDllObject2);
+
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldUpdateDllListWhileDllObjectsAreRead)
+{
+	std::atomic<bool> stop(false);
+	std::atomic<int32_t> failedCount(0);
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		threads.push_back(std::thread([this, &stop, &failedCount]()
+			{
+				std::shared_ptr<IMsvDllObject> spDllObject;
+				std::string dllPath;
+				std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+				while (!stop)
+				{
+					//DLL which is not changed is always in list (readers see consistent versions)
+					if (m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject) != MSV_SUCCESS || !spDllObject)
+					{
+						++failedCount;
+					}
+
+					//updated DLL is in list with one of its paths, or it is not there at all
+					MsvErrorCode errorCode = m_spDllList->GetDll("testdll_updated", dllPath, spDllDecorator);
+					if (errorCode == MSV_SUCCESS ? dllPath != "testdll_1.dll" && dllPath != "testdll_2.dll" : errorCode != MSV_NOT_FOUND_ERROR)
+					{
+						++failedCount;
+					}
+				}
+			}));
+	}
+
+	for (int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(m_spDllList->BeginUpdate(), MSV_SUCCESS);
+		EXPECT_EQ(m_spDllList->AddDll("testdll_updated", "testdll_1.dll"), MSV_SUCCESS);
+		EXPECT_EQ(m_spDllList->ReplaceDll("testdll_updated", "testdll_2.dll"), MSV_SUCCESS);
+		EXPECT_EQ(m_spDllList->EndUpdate(), MSV_SUCCESS);
+
+		EXPECT_EQ(m_spDllList->ReplaceDll("testdll_updated", "testdll_1.dll"), MSV_SUCCESS);
+		EXPECT_EQ(m_spDllList->RemoveDll("testdll_updated"), MSV_SUCCESS);
+	}
+
+	stop = true;
+	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+	{
+		it->join();
+	}
+
+	EXPECT_EQ(failedCount, 0);
+
+	//changes in batch are not visible until batch ends
+	std::string dllPath;
+	std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+	EXPECT_EQ(m_spDllList->BeginUpdate(), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->RemoveDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}"), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->GetDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}", dllPath, spDllDecorator), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->Seal(), MSV_NOT_ALLOWED_ERROR);
+	EXPECT_EQ(m_spDllList->EndUpdate(), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->GetDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}", dllPath, spDllDecorator), MSV_NOT_FOUND_ERROR);
+
+	EXPECT_EQ(m_spDllList->EndUpdate(), MSV_NOT_ALLOWED_ERROR);
+	EXPECT_EQ(m_spDllList->ReplaceDll("testdll_updated", "testdll_1.dll"), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(m_spDllList->RemoveDll("testdll_updated"), MSV_NOT_FOUND_ERROR);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldPreloadAllDllsInParallel)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+
+	//slow DLLs are loaded in parallel (both of them have to be held at latch at once)
+	g_slowLatchCount = 2;
+	g_slowLatchTimedOut = false;
+	std::vector<MsvDllPreloadResult> results;
+	EXPECT_EQ(spDllFactory->Preload(false, 3, results), MSV_OPEN_ERROR);
+	EXPECT_FALSE(g_slowLatchTimedOut);
+
+	EXPECT_EQ(results.size(), 3);
+	for (std::vector<MsvDllPreloadResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+	{
+		EXPECT_EQ(it->GetErrorCode(), it->GetDllPath() == "testdll_nonexistent.dll" ? MSV_OPEN_ERROR : MSV_SUCCESS);
+		EXPECT_EQ(it->GetObjectCount(), 0);
+	}
+
+	//preloaded DLLs are not loaded again
+	int32_t loadDllLibraryCount = g_loadDllLibraryCount;
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDllObject), MSV_SUCCESS);
+	EXPECT_EQ(g_loadDllLibraryCount, loadDllLibraryCount);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldPreloadAndInstantiateRequestedDllObjects)
+{
+	std::vector<MsvDllPreloadResult> results;
+	EXPECT_EQ(m_spDllFactory->Preload({ "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "{337AB087-1B69-4561-A0E4-771723EFCBFE}" }, true, 0, results), MSV_SUCCESS);
+	EXPECT_EQ(results.size(), 1);
+	EXPECT_EQ(results[0].GetDllPath(), "testdll_1.dll");
+	EXPECT_EQ(results[0].GetObjectCount(), 2);
+
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_TRUE(spDll->Initialized());
+
+	//DLL object which is not in DLL is reported
+	EXPECT_EQ(m_spDllFactory->Preload({ "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "{82ABA7A1-5BBC-4F14-B0E6-866BB6BB8136}" }, true, 0, results), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(results.size(), 1);
+	EXPECT_EQ(results[0].GetErrorCode(), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(results[0].GetObjectCount(), 1);
+
+	//DLL id which is not in list
+	EXPECT_EQ(m_spDllFactory->Preload({ "{00000000-0000-0000-0000-000000000001}" }, true, 0, results), MSV_NOT_FOUND_ERROR);
+	EXPECT_TRUE(results.empty());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldCompleteAsyncRequestInlineWhenDllObjectIsCached)
+{
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+
+	bool completed = false;
+	EXPECT_EQ(m_spDllFactory->GetDllObjectAsync("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", [&completed, &spDllObject](MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>& spAsyncDllObject)
+		{
+			EXPECT_EQ(errorCode, MSV_SUCCESS);
+			EXPECT_EQ(spAsyncDllObject, spDllObject);
+			completed = true;
+		}), MSV_SUCCESS);
+	EXPECT_TRUE(completed);
+
+	//errors are returned asynchronously too
+	std::future<MsvDllObjectResult> future;
+	EXPECT_EQ(m_spDllFactory->GetDllObjectAsync("{82ABA7A1-5BBC-4F14-B0E6-866BB6BB8136}", future), MSV_SUCCESS);
+	EXPECT_EQ(future.get().GetErrorCode(), MSV_NOT_FOUND_ERROR);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldTimeoutAsyncRequestAndCacheDllObjectLoadedInBackground)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+
+	int32_t loadDllLibraryCount = g_loadDllLibraryCount;
+
+	//slow DLL is held at latch until this thread arrives (requests would wait for latch if they blocked)
+	g_slowLatchCount = 2;
+	g_slowLatchTimedOut = false;
+	std::future<MsvDllObjectResult> timeoutFuture;
+	EXPECT_EQ(spDllFactory->GetDllObjectAsync("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", timeoutFuture, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)), MSV_SUCCESS);
+	std::future<MsvDllObjectResult> future;
+	EXPECT_EQ(spDllFactory->GetDllObjectAsync("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", future), MSV_SUCCESS);
+
+	//request is timed out while DLL is still being loaded
+	MsvDllObjectResult timeoutResult = timeoutFuture.get();
+	EXPECT_EQ(timeoutResult.GetErrorCode(), MSV_TIMEOUT_ERROR);
+	EXPECT_EQ(timeoutResult.GetDllObject(), nullptr);
+	EXPECT_NE(g_slowLatchCount, 0);
+	ArriveAtSlowLatch();
+	EXPECT_FALSE(g_slowLatchTimedOut);
+
+	MsvDllObjectResult result = future.get();
+	EXPECT_EQ(result.GetErrorCode(), MSV_SUCCESS);
+	EXPECT_NE(result.GetDllObject(), nullptr);
+
+	//load of timed out request has been finished in background and its object is cached
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDllObject), MSV_SUCCESS);
+	EXPECT_EQ(spDllObject, result.GetDllObject());
+	EXPECT_EQ(g_loadDllLibraryCount - loadDllLibraryCount, 1);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReleaseCompletedAsyncRequestBeforeItsDeadline)
+{
+	//captures of callback are released when request is completed (timer does not keep them until deadline)
+	std::promise<void> released;
+	std::future<void> releasedFuture = released.get_future();
+	std::shared_ptr<int32_t> spCapture(new (std::nothrow) int32_t(0), [&released](int32_t* pCapture)
+	{
+		delete pCapture;
+		released.set_value();
+	});
+
+	std::promise<MsvErrorCode> result;
+	EXPECT_EQ(m_spDllFactory->GetDllObjectAsync("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", [spCapture, &result](MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>&)
+		{
+			result.set_value(errorCode);
+		}, std::chrono::steady_clock::now() + std::chrono::hours(1)), MSV_SUCCESS);
+	spCapture.reset();
+
+	EXPECT_EQ(result.get_future().get(), MSV_SUCCESS);
+	EXPECT_EQ(releasedFuture.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldDestroyFactoryReleasedByAsyncCallback)
+{
+	std::shared_ptr<IMsvDllFactory> spDllFactory(new (std::nothrow) MsvDllFactory(m_spDllList, m_spLogger));
+	EXPECT_NE(spDllFactory, nullptr);
+
+	//callback holds the last reference to factory - it is destroyed by loader thread (it can't join itself)
+	std::shared_ptr<std::shared_ptr<IMsvDllFactory>> spCallbackDllFactory(new (std::nothrow) std::shared_ptr<IMsvDllFactory>(spDllFactory));
+	std::promise<void> released;
+	std::shared_future<void> releasedFuture = released.get_future().share();
+	std::promise<MsvErrorCode> result;
+	EXPECT_EQ(spDllFactory->GetDllObjectAsync("{82ABA7A1-5BBC-4F14-B0E6-866BB6BB8136}", [spCallbackDllFactory, releasedFuture, &result](MsvErrorCode errorCode, const std::shared_ptr<IMsvDllObject>&)
+		{
+			releasedFuture.wait();
+			spCallbackDllFactory->reset();
+			result.set_value(errorCode);
+		}), MSV_SUCCESS);
+
+	spDllFactory.reset();
+	released.set_value();
+	EXPECT_EQ(result.get_future().get(), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(*spCallbackDllFactory, nullptr);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldResolveDllAddressOnlyOnceUntilDllIsUnloaded)
+{
+	MsvDllAdapter dllAdapter(m_spLogger);
+	EXPECT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll"), MSV_SUCCESS);
+
+	void* pDllAddress = nullptr;
+	EXPECT_EQ(dllAdapter.GetDllAddress("Increment", pDllAddress), MSV_SUCCESS);
+	EXPECT_NE(pDllAddress, nullptr);
+	EXPECT_EQ(dllAdapter.GetAddressCacheMisses(), 1);
+	EXPECT_EQ(dllAdapter.GetAddressCacheHits(), 0);
+
+	void* pCachedDllAddress = nullptr;
+	EXPECT_EQ(dllAdapter.GetDllAddress("Increment", pCachedDllAddress), MSV_SUCCESS);
+	EXPECT_EQ(pCachedDllAddress, pDllAddress);
+	EXPECT_EQ(dllAdapter.GetAddressCacheMisses(), 1);
+	EXPECT_EQ(dllAdapter.GetAddressCacheHits(), 1);
+
+	//not found addresses are not cached
+	EXPECT_EQ(dllAdapter.GetDllAddress("NotExistingAddress", pDllAddress), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(dllAdapter.GetDllAddress("NotExistingAddress", pDllAddress), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(dllAdapter.GetAddressCacheMisses(), 3);
+
+	//cache is dropped with unloaded library
+	EXPECT_EQ(dllAdapter.UnloadDllLibrary(), MSV_SUCCESS);
+	EXPECT_EQ(dllAdapter.GetDllAddress("Increment", pDllAddress), MSV_NOT_INITIALIZED_ERROR);
+	EXPECT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll"), MSV_SUCCESS);
+	EXPECT_EQ(dllAdapter.GetDllAddress("Increment", pDllAddress), MSV_SUCCESS);
+	EXPECT_NE(pDllAddress, nullptr);
+	EXPECT_EQ(dllAdapter.GetAddressCacheMisses(), 4);
+	EXPECT_EQ(dllAdapter.GetAddressCacheHits(), 1);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldResolveAllDllAddressesAndReportAllNotFoundOnes)
+{
+	MsvDllAdapter dllAdapter(m_spLogger);
+	std::vector<void*> dllAddresses;
+	EXPECT_EQ(dllAdapter.GetDllAddresses({ "Increment" }, dllAddresses), MSV_NOT_INITIALIZED_ERROR);
+	EXPECT_EQ(dllAddresses.size(), 1);
+	EXPECT_EQ(dllAddresses[0], nullptr);
+
+	//addresses resolved one by one by system
+	MsvDllAdapter systemDllAdapter(m_spLogger);
+	EXPECT_EQ(systemDllAdapter.LoadDllLibrary("testdll_2.dll"), MSV_SUCCESS);
+	void* pIncrementAddress = nullptr;
+	EXPECT_EQ(systemDllAdapter.GetDllAddress("Increment", pIncrementAddress), MSV_SUCCESS);
+	void* pGetValueAddress = nullptr;
+	EXPECT_EQ(systemDllAdapter.GetDllAddress("GetValue", pGetValueAddress), MSV_SUCCESS);
+
+	//not found addresses do not stop resolution of next ones
+	EXPECT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll"), MSV_SUCCESS);
+	EXPECT_EQ(dllAdapter.GetDllAddresses({ "Increment", "NotExistingAddress1", "GetValue", "NotExistingAddress2" }, dllAddresses), MSV_NOT_FOUND_ERROR);
+	EXPECT_EQ(dllAddresses.size(), 4);
+	EXPECT_EQ(dllAddresses[0], pIncrementAddress);
+	EXPECT_EQ(dllAddresses[1], nullptr);
+	EXPECT_EQ(dllAddresses[2], pGetValueAddress);
+	EXPECT_EQ(dllAddresses[3], nullptr);
+
+	//resolved addresses are cached (cached and not cached ones can be mixed)
+	EXPECT_EQ(dllAdapter.GetDllAddresses({ "GetValue", "Decrement", "Increment" }, dllAddresses), MSV_SUCCESS);
+	EXPECT_EQ(dllAddresses.size(), 3);
+	EXPECT_EQ(dllAddresses[0], pGetValueAddress);
+	EXPECT_NE(dllAddresses[1], nullptr);
+	EXPECT_EQ(dllAddresses[2], pIncrementAddress);
+	EXPECT_EQ(dllAdapter.GetAddressCacheHits(), 2);
+	EXPECT_EQ(dllAdapter.GetAddressCacheMisses(), 5);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldLoadDllWithLoadOptionsOfDllList)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+
+	EXPECT_EQ(m_spDllList->AddDll("testdll_1_now", "testdll_1.dll", nullptr, MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_NODELETE), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->ReplaceDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll", nullptr, MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_NODELETE), MSV_SUCCESS);
+
+	std::string dllPath;
+	std::shared_ptr<IMsvDllDecorator> spDllDecorator;
+	MsvDllLoadOptions loadOptions = MSV_DLL_LOAD_DEFAULT;
+	EXPECT_EQ(m_spDllList->GetDll("testdll_1_now", dllPath, spDllDecorator, loadOptions), MSV_SUCCESS);
+	EXPECT_EQ(loadOptions, MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_NODELETE);
+	EXPECT_EQ(m_spDllList->GetDll("{337AB087-1B69-4561-A0E4-771723EFCBFE}", dllPath, spDllDecorator, loadOptions), MSV_SUCCESS);
+	EXPECT_EQ(loadOptions, MSV_DLL_LOAD_DEFAULT);
+
+	//load options are kept by sealed list
+	EXPECT_EQ(m_spDllList->Seal(), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllList->GetDll(MsvDllId("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), dllPath, spDllDecorator, loadOptions), MSV_SUCCESS);
+	EXPECT_EQ(loadOptions, MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_NODELETE);
+
+	//DLL is loaded with load options of id which loads it
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	EXPECT_EQ(g_lastLoadOptions, MSV_DLL_LOAD_NOW | MSV_DLL_LOAD_NODELETE);
+
+	//not deleted DLL can be unloaded and loaded again
+	spDllObject.reset();
+	EXPECT_EQ(spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->GetDllObject("{337AB087-1B69-4561-A0E4-771723EFCBFE}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	EXPECT_EQ(g_lastLoadOptions, MSV_DLL_LOAD_DEFAULT);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldWarmupDllInBackgroundAndCancelWarmupByReleaseDll)
+{
+	//warmup resolves hot addresses to cache and touches DLL code
+	MsvDllAdapter dllAdapter(m_spLogger);
+	std::atomic<bool> cancelled(false);
+	EXPECT_EQ(dllAdapter.WarmupDllLibrary({ "Increment" }, cancelled), MSV_NOT_INITIALIZED_ERROR);
+	EXPECT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll"), MSV_SUCCESS);
+	EXPECT_EQ(dllAdapter.WarmupDllLibrary({ "Increment", "GetValue" }, cancelled), MSV_SUCCESS);
+	void* pDllAddress = nullptr;
+	EXPECT_EQ(dllAdapter.GetDllAddress("Increment", pDllAddress), MSV_SUCCESS);
+	EXPECT_EQ(dllAdapter.GetAddressCacheHits(), 1);
+	cancelled = true;
+	EXPECT_EQ(dllAdapter.WarmupDllLibrary({ "Increment" }, cancelled), MSV_NOT_ALLOWED_ERROR);
+
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+	EXPECT_EQ(m_spDllList->ReplaceDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll", nullptr, MSV_DLL_LOAD_WARMUP), MSV_SUCCESS);
+
+	//DLL object is returned without waiting for warmup (warmup arrives at latch when it is started)
+	g_warmupDllLibraryCount = 0;
+	g_warmupDllLibraryCancelled = false;
+	g_slowLatchCount = 1;
+	g_slowLatchTimedOut = false;
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	EXPECT_TRUE(WaitForSlowLatch(0));
+	EXPECT_EQ(g_warmupDllLibraryCount, 1);
+
+	//warmup is running (it never finishes by itself) -> release cancels it and waits for it
+	spDllObject.reset();
+	EXPECT_EQ(spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+	EXPECT_TRUE(g_warmupDllLibraryCancelled);
+	EXPECT_FALSE(g_slowLatchTimedOut);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldPrefaultDllByLoadAndReportPrefaultedPages)
+{
+	//DLL loaded without prefault reports nothing
+	std::vector<MsvDllPreloadResult> results;
+	EXPECT_EQ(m_spDllFactory->Preload({ "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}" }, false, 1, results), MSV_SUCCESS);
+	EXPECT_EQ(results.size(), 1);
+	EXPECT_EQ(results[0].GetPrefaultedPages(), 0);
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+
+	//code and read-only data of DLL are faulted in by its load
+	EXPECT_EQ(m_spDllList->ReplaceDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll", nullptr, MSV_DLL_LOAD_PREFAULT), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllFactory->Preload({ "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}" }, false, 1, results), MSV_SUCCESS);
+	EXPECT_EQ(results.size(), 1);
+	EXPECT_GT(results[0].GetPrefaultedPages(), 0);
+	EXPECT_LE(results[0].GetPrefaultTime(), results[0].GetLoadTime());
+
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	std::uint64_t prefaultedPages = 0;
+	std::chrono::microseconds prefaultTime(0);
+	spDll->GetDllPrefault(prefaultedPages, prefaultTime);
+	EXPECT_EQ(prefaultedPages, results[0].GetPrefaultedPages());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldRemapDllOntoHugePagesOrKeepItOnNormalPages)
+{
+	//DLL is remapped when it has whole huge pages of code (nop sled of test DLL 2 on x86-64), otherwise (or when huge pages are not available) it is kept on normal pages
+	MsvDllAdapter dllAdapter(m_spLogger);
+	EXPECT_EQ(dllAdapter.LoadDllLibrary("testdll_2.dll", MSV_DLL_LOAD_HUGE_PAGES | MSV_DLL_LOAD_PREFAULT), MSV_SUCCESS);
+	void* pDllAddress = nullptr;
+	EXPECT_EQ(dllAdapter.GetDllAddress("Increment", pDllAddress), MSV_SUCCESS);
+	EXPECT_NE(pDllAddress, nullptr);
+	EXPECT_EQ(reinterpret_cast<int32_t(*)()>(pDllAddress)(), 1);
+	EXPECT_EQ(dllAdapter.UnloadDllLibrary(), MSV_SUCCESS);
+
+	//DLL objects work after remap
+	EXPECT_EQ(m_spDllList->ReplaceDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", "testdll_1.dll", nullptr, MSV_DLL_LOAD_HUGE_PAGES), MSV_SUCCESS);
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldCountReferencedDllObjects)
+{
+	std::shared_ptr<IMsvDll> spDll;
+	std::shared_ptr<IMsvDllObject> spDllObject1;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject1), MSV_SUCCESS);
+	EXPECT_EQ(m_spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_EQ(spDll->GetDllReferenceCount(), 1);
+
+	//each object is one reference (regardless of count of its shared pointers)
+	std::shared_ptr<IMsvDllObject> spDllObject1Copy = spDllObject1;
+	std::shared_ptr<IMsvDllObject> spDllObject2;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{337AB087-1B69-4561-A0E4-771723EFCBFE}", spDllObject2), MSV_SUCCESS);
+	EXPECT_EQ(spDll->GetDllReferenceCount(), 2);
+
+	//count is exact when objects are acquired and released concurrently
+	std::vector<std::thread> threads;
+	for (int32_t i = 0; i < 8; ++i)
+	{
+		threads.push_back(std::thread([this, i]()
+		{
+			for (int32_t j = 0; j < 1000; ++j)
+			{
+				std::shared_ptr<IMsvDllObject> spDllObject;
+				EXPECT_EQ(m_spDllFactory->GetDllObject((i + j) % 2 ? "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}" : "{337AB087-1B69-4561-A0E4-771723EFCBFE}", spDllObject), MSV_SUCCESS);
+			}
+		}));
+	}
+	spDllObject2.reset();
+	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+	{
+		it->join();
+	}
+	EXPECT_EQ(spDll->GetDllReferenceCount(), 1);
+
+	spDllObject1.reset();
+	EXPECT_EQ(spDll->GetDllReferenceCount(), 1);
+	spDllObject1Copy.reset();
+	EXPECT_EQ(spDll->GetDllReferenceCount(), 0);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldCountReferencesOfRefCountedDllObject)
+{
+	//DLL returns reference counted object by shared pointer (it holds one reference)
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+
+	//factory owns one reference - its pointers count pin of DLL
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObject);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(dllObject.Get(), spDllObject.get());
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 2);
+
+	//copies and moves of pointers returned by factory do not change count of object
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectCopy = dllObject;
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 2);
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectMoved(std::move(dllObjectCopy));
+	EXPECT_FALSE(dllObjectCopy);
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 2);
+	EXPECT_EQ(dllObjectMoved, dllObject);
+
+	//pointers created from raw pointer count references of object exactly
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectReference(dllObject.Get());
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 3);
+	dllObjectReference.Reset();
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 2);
+
+	//factory keeps object when shared pointers are released (the same object is returned by shared pointer again)
+	spDllObject.reset();
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 1);
+	EXPECT_EQ(m_spDllFactory->GetDllObject("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spDllObject), MSV_SUCCESS);
+	EXPECT_EQ(spDllObject.get(), dllObject.Get());
+	spDllObject.reset();
+	dllObjectMoved.Reset();
+	dllObject.Reset();
+	EXPECT_FALSE(dllObject);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldNotReleaseDllWhileRefCountedDllObjectIsReferenced)
+{
+	//pointers returned by factory pin DLL (shared pointers of DLL objects are not counted by DLL)
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObject);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectCopy = dllObject;
+
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(m_spDllFactory->GetDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spDll), MSV_SUCCESS);
+	EXPECT_EQ(spDll->GetDllReferenceCount(), 0);
+	spDll.reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}"), MSV_NOT_ALLOWED_ERROR);
+
+	//the same object acquired again while it is pinned (by id and by token)
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectAgain;
+	errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObjectAgain);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(dllObjectAgain, dllObject);
+	MsvDllToken token;
+	EXPECT_EQ(m_spDllFactory->Resolve("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", token), MSV_SUCCESS);
+	errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvDllRefCountedObject>(token, dllObjectAgain);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(dllObjectAgain, dllObject);
+	dllObjectAgain.Reset();
+	dllObject.Reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}"), MSV_NOT_ALLOWED_ERROR);
+
+	//shared pointer returned for owned object pins DLL too
+	std::shared_ptr<IMsvDllObject> spDllObject = dllObjectCopy.ToSharedPtr();
+	dllObjectCopy.Reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}"), MSV_NOT_ALLOWED_ERROR);
+
+	//last pointer unpins DLL (owned object is destroyed by DLL code before DLL is unloaded)
+	spDllObject.reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}"), MSV_SUCCESS);
+
+	//DLL is loaded again on demand (object is owned by new pin)
+	errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory)->GetDllObject<MsvDllRefCountedObject>(token, dllObject);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 1);
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}"), MSV_NOT_ALLOWED_ERROR);
+	dllObject.Reset();
+	EXPECT_EQ(m_spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}"), MSV_SUCCESS);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldNotUnloadDllWhileReadersUseItsObjects)
+{
+	std::shared_ptr<IMsvDllFactory> spDllFactory = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory);
+	std::uint64_t gracePeriodCount = spDllFactory->GetDllReclaimer().GetGracePeriodCount();
+
+	//readers call into DLL objects (theirs destruction runs DLL code) while DLL is released and reloaded
+	std::atomic<bool> stop(false);
+	std::atomic<size_t> startedCount(0);
+	std::vector<std::int64_t> callCounts(4, 0);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < callCounts.size(); ++i)
+	{
+		threads.push_back(std::thread([&spDllFactory, &stop, &startedCount, &callCounts, i]()
+		{
+			for (bool started = false; !stop.load();)
+			{
+				{
+					MsvDllReadSection readSection(spDllFactory->GetDllReclaimer());
+
+					MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+					if (MSV_SUCCEEDED(spDllFactory->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObject)))
+					{
+						MsvDllObjectPtr<MsvDllRefCountedObject> dllObjectCopy = dllObject;
+						callCounts[i] += dllObjectCopy->GetDllReferenceCount() > 0 ? 1 : 0;
+					}
+				}
+
+				if (!started && callCounts[i] > 0)
+				{
+					started = true;
+					++startedCount;
+				}
+
+				//readers are preempted without objects too (DLL which objects are held can't be released)
+				std::this_thread::yield();
+			}
+		}));
+	}
+
+	//releases start when all readers use DLL objects (loader of DLL might be slower then releases)
+	for (int i = 0; i < 1000 && startedCount.load() < threads.size(); ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	int releaseCount = 0;
+	for (int i = 0; i < 200 || (releaseCount == 0 && i < 100000); ++i)
+	{
+		//DLL might be held by reader which is loading it right now
+		MsvErrorCode errorCode = spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}");
+		EXPECT_TRUE(errorCode == MSV_SUCCESS || errorCode == MSV_NOT_FOUND_INFO || errorCode == MSV_NOT_ALLOWED_ERROR);
+		releaseCount += errorCode == MSV_SUCCESS ? 1 : 0;
+		std::this_thread::yield();
+	}
+
+	stop.store(true);
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+		EXPECT_GT(callCounts[i], 0);
+	}
+
+	//each successful release has waited for its grace period
+	EXPECT_GT(releaseCount, 0);
+	EXPECT_GE(spDllFactory->GetDllReclaimer().GetGracePeriodCount(), gracePeriodCount + releaseCount);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldWaitForReadSectionBeforeDllIsUnloaded)
+{
+	std::shared_ptr<IMsvDllFactory> spDllFactory = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory);
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", spDllObject), MSV_SUCCESS);
+
+	//release is blocked by read section entered before it
+	std::future<MsvErrorCode> release;
+	{
+		MsvDllReadSection readSection(spDllFactory->GetDllReclaimer());
+		spDllObject.reset();
+
+		release = std::async(std::launch::async, [&spDllFactory]()
+		{
+			return spDllFactory->ReleaseDll("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}");
+		});
+		EXPECT_EQ(release.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+
+		//nested section does not block release either
+		MsvDllReadSection nestedReadSection(spDllFactory->GetDllReclaimer());
+	}
+
+	EXPECT_EQ(release.get(), MSV_SUCCESS);
+}
+
+//object which counts its deletions (retired by reclaimer)
+class MsvTestRetiredObject
+{
+public:
+	MsvTestRetiredObject(std::atomic<int32_t>& deleteCount):
+		m_deleteCount(deleteCount)
+	{
+
+	}
+
+	~MsvTestRetiredObject()
+	{
+		++m_deleteCount;
+	}
+
+protected:
+	std::atomic<int32_t>& m_deleteCount;
+};
+
+TEST_F(MsvDllFactory_Integration, ItShouldDeleteRetiredObjectAfterReadSectionIsLeft)
+{
+	std::shared_ptr<IMsvDllFactory> spDllFactory = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory);
+	std::atomic<int32_t> deleteCount(0);
+
+	{
+		//retire does not wait for reader (it is called inside read section of the same thread)
+		MsvDllReadSection readSection(spDllFactory->GetDllReclaimer());
+		spDllFactory->GetDllReclaimer().Retire(new (std::nothrow) MsvTestRetiredObject(deleteCount));
+		spDllFactory->GetDllReclaimer().Reclaim();
+		EXPECT_EQ(deleteCount, 0);
+		EXPECT_EQ(spDllFactory->GetDllReclaimer().GetRetiredCount(), 1);
+	}
+
+	//pending grace period is finished by next reclaim
+	spDllFactory->GetDllReclaimer().Reclaim();
+	EXPECT_EQ(deleteCount, 1);
+	EXPECT_EQ(spDllFactory->GetDllReclaimer().GetRetiredCount(), 0);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReclaimReplacedDllObjectCacheSnapshots)
+{
+	std::shared_ptr<IMsvDllFactory> spDllFactory = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(m_spDllFactory);
+
+	//each acquired (or expired and acquired again) object publishes new snapshot and retires old one (and token slot entry)
+	MsvDllToken token;
+	EXPECT_EQ(spDllFactory->Resolve("{337AB087-1B69-4561-A0E4-771723EFCBFE}", token), MSV_SUCCESS);
+	for (int i = 0; i < 10; ++i)
+	{
+		std::shared_ptr<IMsvDllObject> spDllObject;
+		EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+		EXPECT_EQ(spDllFactory->GetDllObject(token, spDllObject), MSV_SUCCESS);
+	}
+
+	//there are no readers - old snapshots and entries have been deleted by writers without waiting
+	EXPECT_EQ(spDllFactory->GetDllReclaimer().GetRetiredCount(), 0);
+
+	EXPECT_EQ(spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->GetDllReclaimer().GetRetiredCount(), 0);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReleaseDllAsynchronouslyAndWaitForItsUnload)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	std::shared_ptr<IMsvDllObject> spDllObject;
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	spDllObject.reset();
+
+	//release returns before slow unload is finished (unload is held at latch until this thread arrives)
+	g_unloadDllLibraryDelay = 200;
+	g_slowLatchCount = 2;
+	g_slowLatchTimedOut = false;
+	EXPECT_EQ(spDllFactory->ReleaseDllAsync("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->ReleaseDllAsync("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_NOT_FOUND_INFO);
+
+	std::uint32_t pendingCount = 0;
+	std::uint64_t unloadedCount = 0;
+	std::chrono::microseconds unloadTime(0);
+	std::chrono::microseconds maxUnloadTime(0);
+	spDllFactory->GetDllUnloadMetrics(pendingCount, unloadedCount, unloadTime, maxUnloadTime);
+	EXPECT_EQ(pendingCount, 1);
+	EXPECT_EQ(unloadedCount, 0);
+
+	//detached DLL is loaded again (it is still being unloaded by reaper)
+	EXPECT_EQ(spDllFactory->GetDllObject("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+
+	ArriveAtSlowLatch();
+	EXPECT_FALSE(g_slowLatchTimedOut);
+	spDllFactory->WaitForDllUnloads();
+	g_unloadDllLibraryDelay = 0;
+	spDllFactory->GetDllUnloadMetrics(pendingCount, unloadedCount, unloadTime, maxUnloadTime);
+	EXPECT_EQ(pendingCount, 0);
+	EXPECT_EQ(unloadedCount, 1);
+	EXPECT_GE(unloadTime, std::chrono::milliseconds(200));
+	EXPECT_EQ(maxUnloadTime, unloadTime);
+
+	//reloaded DLL is still usable
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_TRUE(spDll->Initialized());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldReleaseDllsAtShutdownByShutdownPolicy)
+{
+	//parallel teardown unloads all DLLs
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	spDllFactory->SetShutdownPolicy(MSV_DLL_SHUTDOWN_PARALLEL);
+	std::shared_ptr<IMsvDll> spDll;
+	EXPECT_EQ(spDllFactory->GetDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDll), MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->GetDll("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDll), MSV_SUCCESS);
+	spDll.reset();
+
+	g_unloadDllLibraryCount = 0;
+	spDllFactory.reset();
+	EXPECT_EQ(g_unloadDllLibraryCount, 2);
+
+	//leaked DLLs are not unloaded - theirs objects stay usable after factory is destroyed
+	spDllFactory = CreateSlowDllFactory();
+	spDllFactory->SetShutdownPolicy(MSV_DLL_SHUTDOWN_LEAK);
+	MsvDllObjectPtr<MsvDllRefCountedObject> dllObject;
+	MsvErrorCode errorCode = std::static_pointer_cast<IMsvDllFactory, MsvDllFactory>(spDllFactory)->GetDllObject<MsvDllRefCountedObject>("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}", dllObject);
+	EXPECT_EQ(errorCode, MSV_SUCCESS);
+	EXPECT_EQ(spDllFactory->GetDll("{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDll), MSV_SUCCESS);
+	spDll.reset();
+
+	g_unloadDllLibraryCount = 0;
+	spDllFactory.reset();
+	EXPECT_EQ(g_unloadDllLibraryCount, 0);
+	EXPECT_EQ(dllObject->GetDllReferenceCount(), 1);
+	dllObject.Reset();
+}
+
+#ifdef MSV_DLL_COROUTINES
+//fire and forget coroutine (it runs until first suspension immediately)
+class MsvTestCoroutine
+{
+public:
+	class promise_type
+	{
+	public:
+		MsvTestCoroutine get_return_object() { return MsvTestCoroutine(); }
+		std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+		std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+//factory is referenced only (coroutine frame must not own it - frame is destroyed by thread which has resumed it)
+template<class T> MsvTestCoroutine AwaitDllObject(IMsvDllFactory& dllFactory, const char* id, std::shared_ptr<T>& spDllObject, std::promise<MsvErrorCode>& result, std::thread::id& resumedThreadId)
+{
+	//executor records thread which has resumed coroutine
+	MsvErrorCode errorCode = co_await dllFactory.AwaitDllObject(id, spDllObject, [&resumedThreadId](std::coroutine_handle<> handle)
+	{
+		resumedThreadId = std::this_thread::get_id();
+		handle.resume();
+	});
+
+	result.set_value(errorCode);
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldAwaitDllObjectAndResumeOnExecutorOnlyWhenItIsLoaded)
+{
+	//DLL is not loaded -> coroutine is suspended and resumed by loader thread
+	std::shared_ptr<MsvTest1DllObject> spDllObject;
+	std::promise<MsvErrorCode> result;
+	std::thread::id resumedThreadId;
+	AwaitDllObject(*m_spDllFactory, "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spDllObject, result, resumedThreadId);
+	EXPECT_EQ(result.get_future().get(), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	EXPECT_NE(resumedThreadId, std::thread::id());
+	EXPECT_NE(resumedThreadId, std::this_thread::get_id());
+
+	//DLL object is cached -> co_await is completed inline (executor is not called)
+	std::shared_ptr<MsvTest1DllObject> spCachedDllObject;
+	std::promise<MsvErrorCode> cachedResult;
+	std::thread::id cachedResumedThreadId;
+	AwaitDllObject(*m_spDllFactory, "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}", spCachedDllObject, cachedResult, cachedResumedThreadId);
+	std::future<MsvErrorCode> cachedFuture = cachedResult.get_future();
+	EXPECT_EQ(cachedFuture.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+	EXPECT_EQ(cachedFuture.get(), MSV_SUCCESS);
+	EXPECT_EQ(spCachedDllObject, spDllObject);
+	EXPECT_EQ(cachedResumedThreadId, std::thread::id());
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldResumeAwaitingCoroutineWhenFactoryOutlivesIt)
+{
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+
+	//slow DLL is loaded 500 ms -> coroutine is suspended
+	std::shared_ptr<TestDll2> spDllObject;
+	std::promise<MsvErrorCode> result;
+	std::thread::id resumedThreadId;
+	AwaitDllObject(*spDllFactory, "{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDllObject, result, resumedThreadId);
+	std::future<MsvErrorCode> future = result.get_future();
+	EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+	//factory is alive -> coroutine is resumed by loader thread
+	EXPECT_EQ(future.get(), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	EXPECT_NE(resumedThreadId, std::this_thread::get_id());
+
+	spDllObject.reset();
+	spDllFactory.reset();
+}
+
+TEST_F(MsvDllFactory_Integration, ItShouldResumeAwaitingCoroutineWhenFactoryIsDestroyedUnderIt)
+{
+	//leaked DLL keeps object of resumed coroutine usable after factory is destroyed
+	std::shared_ptr<MsvDllFactory> spDllFactory = CreateSlowDllFactory();
+	EXPECT_NE(spDllFactory, nullptr);
+	spDllFactory->SetShutdownPolicy(MSV_DLL_SHUTDOWN_LEAK);
+
+	std::shared_ptr<TestDll2> spDllObject;
+	std::promise<MsvErrorCode> result;
+	std::thread::id resumedThreadId;
+	AwaitDllObject(*spDllFactory, "{BB8B8CC6-FF99-47C8-8668-F17ABE5E63A6}", spDllObject, result, resumedThreadId);
+	std::future<MsvErrorCode> future = result.get_future();
+	EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+	//destructor finishes pending requests -> suspended coroutine is resumed before factory is gone
+	spDllFactory.reset();
+	EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+	EXPECT_EQ(future.get(), MSV_SUCCESS);
+	EXPECT_NE(spDllObject, nullptr);
+	EXPECT_NE(resumedThreadId, std::this_thread::get_id());
+
+	spDllObject.reset();
+}
+#endif // MSV_DLL_COROUTINES
+
 TEST_F(MsvDllFactory_Integration, ItShouldFailedTryingToUnloadNotLoadedDll)
 {
 	EXPECT_EQ(m_spDllFactory->ReleaseDll("{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}"), MSV_NOT_FOUND_INFO);
@@ -5,6 +5,7 @@
 
 
 #include "mdllfactory/IMsvDllObject.h"
+#include "mdllfactory/MsvDllObjectId.h"
 
 
 class MsvTest1DllObject:
@@ -15,5 +16,7 @@ public:
 	virtual ~MsvTest1DllObject();
 };
 
+MSV_DLLOBJECT_ID(MsvTest1DllObject, "{9F31D4A9-CDF5-49FA-90A8-AA109735DC9F}")
+
 
 #endif // MARSTECH_TEST1IDLLOBJECT_H
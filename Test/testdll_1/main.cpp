@@ -1,6 +1,7 @@
 
 
 #include "mdllfactory/IMsvDllObject.h"
+#include "mdllfactory/MsvDllObjectPtr.h"
 
 #include "merror/MsvErrorCodes.h"
 
@@ -25,6 +26,16 @@ public:
 };
 
 
+class Test1RefCountedObject:
+	public MsvDllRefCountedObject
+{
+public:
+	Test1RefCountedObject() {};
+	virtual ~Test1RefCountedObject() {};
+
+};
+
+
 std::recursive_mutex g_lock;
 std::shared_ptr<Test1Object> g_spTest1Object;
 
@@ -70,6 +81,20 @@ extern "C" MsvErrorCode GetDllObject(const char* id, std::shared_ptr<IMsvDllObje
 		return MSV_SUCCESS;
 	}
 
+	else if (idString.compare("{5D1E2C3B-7A48-4F6E-9B0C-1D2E3F405162}") == 0)
+	{
+		//reference counted object (its reference is released when shared pointer is released)
+		MsvDllObjectPtr<Test1RefCountedObject> test1RefCountedObject(new (std::nothrow) Test1RefCountedObject(), false);
+		if (!test1RefCountedObject)
+		{
+			return MSV_ALLOCATION_ERROR;
+		}
+
+		spDllObject = test1RefCountedObject.ToSharedPtr();
+
+		return MSV_SUCCESS;
+	}
+
 	//not found -> error
 	return MSV_NOT_FOUND_ERROR;
 }
\ No newline at end of file
@@ -49,3 +49,35 @@ extern "C" int32_t Increment()
 
 	return g_value;
 }
+
+
+//functions bound by address resolution benchmark (decorators of big libraries bind hundreds of functions)
+#ifdef _WIN32
+#define MSV_TEST_FUNCTION(index) extern "C" __declspec(dllexport) int32_t TestFunction##index() { return index; }
+#else
+#define MSV_TEST_FUNCTION(index) extern "C" int32_t TestFunction##index() { return index; }
+#endif // _WIN32
+
+#define MSV_TEST_FUNCTIONS_10(prefix) MSV_TEST_FUNCTION(prefix##0) MSV_TEST_FUNCTION(prefix##1) MSV_TEST_FUNCTION(prefix##2) MSV_TEST_FUNCTION(prefix##3) MSV_TEST_FUNCTION(prefix##4) \
+	MSV_TEST_FUNCTION(prefix##5) MSV_TEST_FUNCTION(prefix##6) MSV_TEST_FUNCTION(prefix##7) MSV_TEST_FUNCTION(prefix##8) MSV_TEST_FUNCTION(prefix##9)
+
+#define MSV_TEST_FUNCTIONS_100(prefix) MSV_TEST_FUNCTIONS_10(prefix##0) MSV_TEST_FUNCTIONS_10(prefix##1) MSV_TEST_FUNCTIONS_10(prefix##2) MSV_TEST_FUNCTIONS_10(prefix##3) MSV_TEST_FUNCTIONS_10(prefix##4) \
+	MSV_TEST_FUNCTIONS_10(prefix##5) MSV_TEST_FUNCTIONS_10(prefix##6) MSV_TEST_FUNCTIONS_10(prefix##7) MSV_TEST_FUNCTIONS_10(prefix##8) MSV_TEST_FUNCTIONS_10(prefix##9)
+
+//TestFunction100 ... TestFunction399
+MSV_TEST_FUNCTIONS_100(1)
+MSV_TEST_FUNCTIONS_100(2)
+MSV_TEST_FUNCTIONS_100(3)
+
+
+//code bigger than huge pages for huge pages benchmark (6 MB of nops, so at least 2 whole huge pages are in it)
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(_WIN32)
+asm(".pushsection .text\n"
+	".globl TestNopSled\n"
+	".type TestNopSled, @function\n"
+	"TestNopSled:\n"
+	".fill 6291456, 1, 0x90\n"
+	"ret\n"
+	".size TestNopSled, . - TestNopSled\n"
+	".popsection\n");
+#endif // defined(__GNUC__) && defined(__x86_64__) && !defined(_WIN32)